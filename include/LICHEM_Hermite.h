@@ -38,17 +38,39 @@ class HermGau
     //Destructor
     ~HermGau();
     //Functions to return private data
-    double coeff(); //Return the coefficient (magnitude)
-    double xPos(); //Return the x position
-    double yPos(); //Return the y position
-    double zPos(); //Return the z position
-    double getAlpha(); //Return the Gaussian width
-    int xPow(); //Return the Hermite power in the x direction
-    int yPow(); //Return the Hermite power in the y direction
-    int zPow(); //Return the Hermite power in the z direction
+    double coeff() const; //Return the coefficient (magnitude)
+    double xPos() const; //Return the x position
+    double yPos() const; //Return the y position
+    double zPos() const; //Return the z position
+    double getAlpha() const; //Return the Gaussian width
+    int xPow() const; //Return the Hermite power in the x direction
+    int yPow() const; //Return the Hermite power in the y direction
+    int zPow() const; //Return the Hermite power in the z direction
     //Functions for calculations
     double value(double,double,double); //Return the magnitude at (x,y,z)
 };
 
+//! Data structure for sharing Hermite basis sets between atoms
+class HermBasisLib
+{
+  //Class for a library of Hermite basis sets
+  private:
+    //Basis set data
+    vector<string> basNames_; //Names of the loaded basis sets
+    vector<vector<vector<HermGau> > > basData_; //Functions [basis][element]
+    vector<HermGau> noBasis_; //Empty basis for undefined elements
+    //Functions to read the database
+    void loadBasis_(string); //Read a basis set file
+  public:
+    //Constructor
+    HermBasisLib();
+    //Destructor
+    ~HermBasisLib();
+    //Functions to search the library
+    int basisID(string); //Return the ID of a basis set (loads once)
+    bool defined(int,int); //Check if an element is in a basis set
+    const vector<HermGau>& getBasis(int,int); //Shared basis functions
+};
+
 #endif
 
@@ -156,5 +156,63 @@ class OctCharges
     double z6; //Position of charge 6
 };
 
+//! Counter-based random number streams for stochastic simulations
+class RandomStreams
+{
+  //Class for independent Philox4x32-10 random number streams
+  private:
+    unsigned long long seed_; //Key shared by all streams
+    vector<unsigned long long> counter_; //Number of blocks used by a stream
+    vector<unsigned int> streamID_; //Thread number of a stream
+    vector<unsigned int> walker_; //Walker which owns a stream
+    void philox_(unsigned int*,unsigned int*); //Philox block function
+    void block_(int,unsigned int*); //Next random block of a stream
+    friend bool TestPhiloxKAT(); //Known-answer test of the block function
+  public:
+    //Constructor
+    RandomStreams();
+    //Destructor
+    ~RandomStreams();
+    //Functions to manage the streams
+    void seed(unsigned long long,int); //Set the seed and thread streams
+    int addStream(unsigned int); //New stream for a walker
+    unsigned long long getSeed(); //Return the seed
+    //Functions to generate random numbers
+    double uniform(); //Uniform number in [0,1) from the thread stream
+    double uniform(int); //Uniform number from a stream (-1 = thread)
+    double gauss(); //Normal random number from the thread stream
+    double gauss(int); //Normal number from a stream (-1 = thread)
+    int integer(int); //Integer in [0,N) from the thread stream
+    int integer(int,int); //Integer from a stream (-1 = thread)
+};
+
+class BlockStats
+{
+  //Class for online blocking analysis (Flyvbjerg-Petersen) of MC data
+  private:
+    vector<double> sum_; //Sum of the block averages at each level
+    vector<double> sum2_; //Sum of the squared block averages
+    vector<double> count_; //Number of blocks at each level
+    vector<double> pending_; //Unpaired block average at each level
+    vector<bool> hasPending_; //Marks levels with an unpaired block
+    double levelErr_(int); //Naive standard error at a blocking level
+    int optLevel_(); //Smallest blocking level on the plateau
+  public:
+    //Constructor
+    BlockStats();
+    //Destructor
+    ~BlockStats();
+    //Functions to collect data
+    void reset(); //Remove all samples
+    void add(double); //Add a sample
+    //Functions to analyze the data
+    double samples(); //Number of samples
+    double mean(); //Average of the samples
+    double variance(); //Variance of the samples
+    double stdErr(); //Standard error of the mean from blocking
+    double corrTime(); //Integrated autocorrelation time (samples)
+    bool converged(); //Check if the blocking analysis found a plateau
+};
+
 #endif
 
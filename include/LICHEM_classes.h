@@ -29,7 +29,8 @@ class GEMDen
     int atom2_; //Atom which defines the x axis
     int atom3_; //Atom which defines the y axis (chiral only)
     //Basis functions and density
-    vector<HermGau> dens_; //GEM density
+    int basID_; //Basis set in the Hermite library
+    int elemID_; //Element (atomic number) in the Hermite library
   public:
     //Constructors
     GEMDen();
@@ -39,7 +40,46 @@ class GEMDen
     //Functions to manipulate GEM density
     void setBasis(string,string); //Sets the Hermite basis
     void setFrame(bool,string,int,int,int); //Sets the frame of reference
+    const vector<HermGau>& density(); //Return the shared basis functions
     MPole GEMDM(); //Function to generate multipoles from density
+    //Density centered on an atom in its local frame
+    vector<HermGau> placeDensity(Coord&,Vector3d&,Vector3d&,Vector3d&);
+};
+
+//! Gaussian process regression model for energies and forces
+class GPModel
+{
+  //Class for a surrogate model of the potential energy surface
+  private:
+    //Training data
+    vector<VectorXd> pos_; //Coordinates of the training structures
+    vector<double> energy_; //Energies of the training structures
+    vector<VectorXd> grad_; //Energy gradients of the training structures
+    //Hyperparameters
+    double lenScale_; //Length scale of the squared exponential (Ang)
+    double sigma2_; //Signal variance (eV^2)
+    double prior_; //Constant prior mean (eV)
+    double jitter_; //Relative noise added to the covariance matrix
+    //Trained model
+    VectorXd alpha_; //Weights of the energy and gradient observations
+    LLT<MatrixXd> chol_; //Cholesky factorization of the covariance matrix
+    bool trained_; //Flag for a successful fit of the current data
+    //Functions to build the model
+    void buildCov_(MatrixXd&,double); //Covariance for a length scale
+  public:
+    //Constructor
+    GPModel();
+    //Destructor
+    ~GPModel();
+    //Functions to manage the training data
+    void addPoint(VectorXd&,double,VectorXd&); //Add energy and forces
+    void clear(); //Remove all training data
+    int size(); //Return the number of training structures
+    //Functions for calculations
+    bool train(); //Fit the hyperparameters and weights
+    double getLength(); //Return the length scale
+    double predict(VectorXd&,VectorXd&); //Return the energy and forces
+    double variance(VectorXd&); //Return the variance of the energy
 };
 
 //! LICHEM particle data structure
@@ -55,6 +95,7 @@ class QMMMAtom
     double Ep; //Path-integral energies
     //Regions
     bool NEBActive; //Included in NEB tangent calculations
+    bool HessActive; //Included in finite-difference Hessians
     bool QMRegion; //QM, MM, pseudo-bond, or boundary-atom
     bool MMRegion; //QM, MM, pseudo-bond, or boundary-atom
     bool PBRegion; //QM, MM, pseudo-bond, or boundary-atom
@@ -77,6 +118,52 @@ class QMMMAtom
     vector<GEMDen> GEM; //GEM frozen density
 };
 
+//! Weighted catalogue of Monte Carlo moves
+class MCMoveSet
+{
+  //Move types, step sizes, and the atoms which can be moved
+  private:
+    vector<string> names_; //Name of each move type
+    vector<double> weights_; //Relative probability of each move type
+    double totWeight_; //Sum of the weights
+    vector<double> steps_; //Step size of each move type
+    vector<double> minStep_; //Smallest step size of each move type
+    vector<double> maxStep_; //Largest step size of each move type
+    vector<double> Nacc_; //Accepted moves since the last step size check
+    vector<double> Nrej_; //Rejected moves since the last step size check
+    vector<double> totAcc_; //Accepted moves since the last reset
+    vector<double> totRej_; //Rejected moves since the last reset
+    vector<int> atoms_; //Atoms which are not frozen
+    vector<vector<int> > mols_; //Molecules without frozen atoms
+  public:
+    //Constructor
+    MCMoveSet();
+    //Destructor
+    ~MCMoveSet();
+    //Functions to build the catalogue
+    void clear(); //Remove all moves
+    int addMove(string,double,double,double,double); //Register a move type
+    void setAtoms(vector<QMMMAtom>&); //Find the active atoms and molecules
+    //Functions to pick moves
+    int NMoves(); //Number of move types
+    int NAtoms(); //Number of active atoms
+    int NMols(); //Number of active molecules
+    int pickMove(int); //Random move type based on the weights
+    int pickAtom(int); //Random active atom
+    vector<int>& pickMol(int); //Random active molecule
+    //Functions for the step sizes and statistics
+    string getName(int); //Name of a move type
+    int findMove(string); //Move type with a name (-1 = not found)
+    double getProb(int); //Probability of a move type
+    double getStep(int); //Step size of a move type
+    void setStep(int,double); //Change the step size of a move type
+    void update(int,bool); //Count an accepted or rejected move
+    double accRatio(int); //Acceptance ratio since the last step size check
+    double totRatio(int); //Acceptance ratio since the last reset
+    void adaptSteps(double,int); //Adjust the step sizes to the target ratio
+    void resetStats(); //Clear all counters
+};
+
 //! LICHEM simulation data
 class QMMMSettings
 {
@@ -95,6 +182,10 @@ class QMMMSettings
     int spin; //QM total spin
     string unitsQM; //Specifies the units for the QM calculations
     string backDir; //Directory for log file backups
+    //Input needed for frozen density potentials
+    string GEMBasis; //Hermite basis set for the GEM densities
+    bool useGEMDen; //Add the GEM density interactions to the MM energy
+    double GEMExch; //Exchange-repulsion per unit of density overlap (eV)
     //Input needed for QMMM long-range electrostatics
     bool useLREC; //Use a long-range correction
     double LRECCut; //Cutoff for the long-range correction
@@ -113,28 +204,100 @@ class QMMMSettings
     int NEq; //Number of equilibration run steps
     int NSteps; //Number of production run steps
     int NBeads; //Number of time-slices or beads
+    int NQMBeads; //Number of contracted beads for the QM energy (0 = all)
     double accRatio; //Target acceptance ratio
+    bool PINormModes; //Flag to move the ring polymers with normal modes
+    double MCRejectBound; //Max. potential energy drop for early rejection
+    string MCScreenFunc; //QM method or MM for delayed acceptance screening
+    string MCScreenBasis; //Basis set for delayed acceptance screening
+    double MCTargetErr; //Error bar of the energy for stopping (0 = off)
     int NPrint; //Number of steps before printing
+    unsigned long long randSeed; //Seed for the random numbers (0 = clock)
+    int NReplicas; //Number of replica exchange temperatures
+    double maxTemp; //Highest replica exchange temperature
+    int NExchange; //Number of steps between replica exchanges
+    int NWalkers; //Number of independent Monte Carlo walkers
+    int MCStream; //Random number stream of the chain (-1 = thread)
+    int PISlot; //First wrapper replica of the beads
+    double MCBeadWeight; //Relative probability of bead moves
+    double MCCentWeight; //Relative probability of centroid moves
+    double MCForceWeight; //Relative probability of force-bias moves
+    double MCModeWeight; //Relative probability of normal mode moves
+    double MCMolWeight; //Relative probability of rigid molecule moves
+    double MCVolWeight; //Relative probability of volume moves
+    MCMoveSet MCMoves; //Move catalogue, step sizes, and active atoms
     //Input needed for optimizations
     int maxOptSteps; //Maximum iterative optimization steps
     double MMOptTol; //Criteria to end the optimization
+    bool adaptMM; //Flag to skip MM relaxations which are not needed
+    double MMSkipDisp; //QM displacement which requires an MM relaxation
     double QMOptTol; //Criteria to end the optimization
     double stepScale; //Steepest descent step size (Ang)
     double maxStep; //Maximum size of the optimization step
+    int LBFGSMem; //Number of saved L-BFGS correction pairs
+    string initHess; //Starting Hessian (identity, Lindh, or calculated)
+    bool reuseHess; //Flag to keep the inverse Hessian between optimizations
     //Input needed for reaction paths
     double kSpring; //Elastic band spring constant
     int TSBead; //Current guess of the transition state
     bool climb; //Flag to turn on climbing image NEB
     bool frznEnds; //Flag to freeze the NEB end points
+    string NEBOpt; //Path optimizer for NEB (DFP, LBFGS, or FIRE)
+    string NEBPreFunc; //QM method for pre-optimizing the path
+    string NEBPreBasis; //Basis set for pre-optimizing the path
+    bool NEBFreeze; //Flag to stop moving converged NEB beads
+    double NEBFreezeTol; //Neighbor motion to reactivate frozen beads (Ang)
+    bool NEBSurrogate; //Flag to optimize NEB paths on a GP surrogate
+    double GPUncertTol; //Max. uncertainty of the surrogate energies (eV)
+    double dimerDist; //Distance from the dimer midpoint to its end (Ang)
     bool NEBFreq; //Flag to calculate TS frequencies after NEB
     bool printNormModes; //Print normal modes for pure QM calculations
+    int NFreqModes; //Number of lowest frequencies to calculate (0 = all)
+    bool numHess; //Calculate Hessians from finite differences of forces
+    double FDStep; //Finite-difference displacement (Ang)
     bool startPathChk; //Flag to initially use checkpoints from nearby beads
     //Storage of energies (NEB and PIMC)
     double EOld; //Temporary storage
+    double EScreen; //Screening energy for delayed acceptance
+    double EForce; //Potential energy of the saved PIMC forces
+    vector<VectorXd> PIForces; //Saved bead forces for force-bias moves
     double EReact; //Reactant energy
     double EProd; //Product energy
     double ETrans; //Transition state energy
 };
 
+//! Context for an independent Monte Carlo chain
+class MCWalker
+{
+  //Class for the state of a single Monte Carlo walker
+  public:
+    //Constructor
+    MCWalker();
+    //Destructor
+    ~MCWalker();
+    //State of the chain
+    vector<QMMMAtom> QMMMData; //Structure of the walker
+    QMMMSettings QMMMOpts; //Settings, stream, slots, and saved energies
+    //Statistics
+    double Nacc; //Number of accepted moves
+    double Nrej; //Number of rejected moves
+    double NSamp; //Number of production samples
+    double sumE; //Sum of the total energies
+    double sumE2; //Sum of the squared total energies
+    double lastE; //Most recent total energy
+    //Functions to manage the chain
+    void setup(vector<QMMMAtom>&,QMMMSettings&,int); //Copy a starting state
+    void clearSlots(); //Delete the wrapper files of the walker
+    void randomStart(); //Randomly displace the starting structure
+    void initEnergy(); //Calculate the energy of the current structure
+    bool move(bool); //Perform a Monte Carlo move
+    void adaptStep(); //Adjust the step sizes to the target acceptance
+    void resetStats(); //Clear the statistics
+    double avgE(); //Average total energy
+    double varE(); //Variance of the total energy
+    bool readRestart(string); //Read the structure and step sizes
+    void writeRestart(string); //Write the structure and step sizes
+};
+
 #endif
 
@@ -54,7 +54,9 @@ namespace LICHEMGlobal
   bool OptSim = 0; //Flag for energy minimization with QM packages
   bool SteepSim = 0; //Flag for steepest descent minimization in LICHEM
   bool DFPSim = 0; //Flag for DFP minimization in LICHEM
+  bool BFGSSim = 0; //Flag for L-BFGS minimization in LICHEM
   bool NEBSim = 0; //Flag for NEB path optimization in LICHEM
+  bool DimerSim = 0; //Flag for dimer saddle point searches in LICHEM
   bool PIMCSim = 0; //Flag for Monte Carlo
   bool FBNEBSim = 0; //Flag for force-bias NEB Monte Carlo
   bool FreqCalc = 0; //Flag for a frequency calculation
@@ -66,6 +68,11 @@ namespace LICHEMGlobal
   int endTime = 0; //Time the calculation ends
   int QMTime = 0; //Sum of QM wrapper times
   int MMTime = 0; //Sum of MM wrapper times
+
+  //Monte Carlo statistics
+  double NScreenTry = 0; //Moves tested with the screening energy
+  double NScreenPass = 0; //Moves which passed the screening stage
+  double NScreenAcc = 0; //Screened moves accepted in the second stage
 };
 
 #endif
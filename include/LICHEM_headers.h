@@ -111,6 +111,12 @@ using namespace LICHEMGlobal;
 //Set up periodic table
 PeriodicTable chemTable;
 
+//Set up the Hermite basis set library
+HermBasisLib basisLib;
+
+//Set up the random number streams
+RandomStreams randGen;
+
 //Function declarations (alphabetical)
 bool Angled(vector<QMMMAtom>&,int,int);
 
@@ -124,16 +130,22 @@ void BurstTraj(vector<QMMMAtom>&,QMMMSettings&);
 
 RedMPole Cart2SphHarm(MPole&);
 
+void Cart2SphHarmBatch(vector<MPole>&,vector<RedMPole>&);
+
 VectorXd CINEBTangent(VectorXd&,VectorXd&,QMMMSettings&,int);
 
 bool CheckFile(const string&);
 
+bool CheckOptFingerprint(fstream&,vector<QMMMAtom>&,int);
+
 void CheckNEBTangent(VectorXd&);
 
 Coord CoordDist2(Coord&,Coord&);
 
 bool Dihedraled(vector<QMMMAtom>&,int,int);
 
+double DimerForces(vector<QMMMAtom>&,VectorXd&,VectorXd&,QMMMSettings&,int);
+
 void ExternalGaussian(int&,char**&);
 
 void ExtractGlobalPoles(int& argc, char**& argv);
@@ -151,6 +163,11 @@ Coord FindQMCOM(vector<QMMMAtom>&,QMMMSettings&,int);
 
 void FindTINKERClasses(vector<QMMMAtom>&);
 
+bool FindTINKFrame(vector<QMMMAtom>&,int,int,Vector3d&,Vector3d&,Vector3d&);
+
+void FIREStep(VectorXd&,VectorXd&,VectorXd&,double&,double&,int&,
+              QMMMSettings&);
+
 void GaussianCharges(vector<QMMMAtom>&,QMMMSettings&,int);
 
 double GaussianEnergy(vector<QMMMAtom>&,QMMMSettings&,int);
@@ -163,15 +180,53 @@ MatrixXd GaussianHessian(vector<QMMMAtom>&,QMMMSettings&,int);
 
 double GaussianOpt(vector<QMMMAtom>&,QMMMSettings&,int);
 
+vector<HermGau> GEMAtomDensity(vector<QMMMAtom>&,int,int);
+
 double GEMBuffC7(double,double,Coord&,Coord&,double);
 
 double GEMC6(double,Coord&,Coord&,double);
 
+double GEMCoulomb(vector<QMMMAtom>&,int);
+
+vector<HermGau> GEMDensDeriv(vector<HermGau>&,int);
+
+double GEMEnergy(vector<QMMMAtom>&,QMMMSettings&,int);
+
+double GEMForces(vector<QMMMAtom>&,VectorXd&,QMMMSettings&,int,bool);
+
+double GEMOverlap(vector<QMMMAtom>&,int);
+
+bool GEMPairActive(vector<QMMMAtom>&,int,int);
+
+double GEMPairCoulomb(vector<HermGau>&,vector<double>&,double,Coord&,
+                      vector<HermGau>&,vector<double>&,double,Coord&);
+
+Coord GEMPairForce(vector<HermGau>&,vector<double>&,double,Coord&,
+                   vector<HermGau>&,vector<double>&,double,Coord&,double);
+
+double GEMPairOverlap(vector<HermGau>&,vector<HermGau>&,Coord&,Coord&);
+
+void GEMSetup(vector<QMMMAtom>&,vector<vector<HermGau> >&,
+              vector<vector<double> >&,vector<double>&,int);
+
+VectorXd Get_PI_BeadEspring(vector<QMMMAtom>&,QMMMSettings&);
+
+double Get_PI_Escreen(vector<QMMMAtom>&,QMMMSettings&);
+
 double Get_PI_Espring(vector<QMMMAtom>&,QMMMSettings&);
 
 double Get_PI_Epot(vector<QMMMAtom>&,QMMMSettings&);
 
-vector<HermGau> HermBasis(string,string);
+double Get_PI_Forces(vector<QMMMAtom>&,QMMMSettings&,vector<VectorXd>&);
+
+void GPNEBForces(vector<VectorXd>&,GPModel&,VectorXd&,vector<VectorXd>&,
+                 VectorXd&,QMMMSettings&);
+
+void GPNEBRelax(vector<VectorXd>&,GPModel&,VectorXd&,vector<bool>&,
+                QMMMSettings&);
+
+void GPNEBSetPath(vector<QMMMAtom>&,vector<VectorXd>&,vector<bool>&,
+                  vector<VectorXd>&,QMMMSettings&);
 
 double HermCoul1e(HermGau&,double,Coord&);
 
@@ -179,8 +234,22 @@ double HermCoul2e(HermGau&,HermGau&);
 
 double HermOverlap(HermGau&,HermGau&);
 
+double HermPoly(int,double);
+
+double HermRInt(int,int,int,int,double,double,double,double);
+
+double IDPPForces(vector<Coord>&,vector<int>&,vector<int>&,VectorXd&,
+                  vector<int>&,VectorXd&);
+
+void IDPPImage(vector<Coord>&,vector<Coord>&,vector<Coord>&,double);
+
+MatrixXd InitInvHessian(vector<QMMMAtom>&,QMMMSettings&,int);
+
 VectorXd KabschDisplacement(MatrixXd&,MatrixXd&,int);
 
+void KabschPathDisplacement(vector<QMMMAtom>&,QMMMSettings&,
+                            vector<VectorXd>&,vector<VectorXd>&);
+
 void KabschRotation(MatrixXd&,MatrixXd&,int);
 
 double LAMMPSEnergy(vector<QMMMAtom>&,QMMMSettings&,int);
@@ -193,40 +262,74 @@ double LAMMPSOpt(vector<QMMMAtom>&,QMMMSettings&,int);
 
 void LAMMPSTopology(vector<QMMMAtom>&,stringstream&,int);
 
+void LanczosModes(MatrixXd&,MatrixXd&,int,VectorXd&,MatrixXd&);
+
+VectorXd LBFGSDirection(VectorXd&,vector<VectorXd>&,vector<VectorXd>&);
+
+bool LBFGSUpdate(VectorXd&,VectorXd&,vector<VectorXd>&,vector<VectorXd>&,int);
+
 void LICHEM2BASIS(int&,char**&);
 
 void LICHEM2TINK(int&,char**&);
 
+double LICHEMBeadForces(vector<QMMMAtom>&,VectorXd&,QMMMSettings&,int);
+
 template<typename T> int LICHEMCount(T);
 
 double LICHEMDensity(vector<QMMMAtom>&,QMMMSettings&);
 
 void LICHEMDFP(vector<QMMMAtom>&,QMMMSettings&,int);
 
+void LICHEMDimer(vector<QMMMAtom>&,QMMMSettings&,VectorXd&,int);
+
+double LICHEMEnergy(vector<QMMMAtom>&,QMMMSettings&,int);
+
 void LICHEMErrorChecker(QMMMSettings&);
 
 double LICHEMFactorial(int);
 
+MatrixXd LICHEMFDHessian(vector<QMMMAtom>&,QMMMSettings&,int);
+
 void LICHEMFixSciNot(string&);
 
+double LICHEMForces(vector<QMMMAtom>&,VectorXd&,QMMMSettings&,int);
+
 template<typename T> string LICHEMFormFloat(T,int);
 
 VectorXd LICHEMFreq(vector<QMMMAtom>&,MatrixXd&,QMMMSettings&,int,int&);
 
+void LICHEMGPNEB(vector<QMMMAtom>&,QMMMSettings&);
+
+void LICHEMLBFGS(vector<QMMMAtom>&,QMMMSettings&,int);
+
 void LICHEMLowerText(string&);
 
+void LICHEMMultiWalker(vector<QMMMAtom>&,QMMMSettings&,fstream&);
+
 void LICHEMNEB(vector<QMMMAtom>&,QMMMSettings&,int);
 
 void LICHEMPrintSettings(vector<QMMMAtom>&,QMMMSettings&);
 
+void LICHEMReplicaExchange(vector<QMMMAtom>&,QMMMSettings&,fstream&);
+
 void LICHEMSteepest(vector<QMMMAtom>&,QMMMSettings&,int);
 
+void LICHEMUnitTests(int&,char**&);
+
 void LICHEMUpperText(string&);
 
+MatrixXd LindhHessian(vector<QMMMAtom>&,int);
+
 double LRECFunction(Coord&,QMMMSettings&);
 
 bool MCMove(vector<QMMMAtom>&,QMMMSettings&,double&);
 
+bool MMRelaxNeeded(vector<QMMMAtom>&,vector<QMMMAtom>&,QMMMSettings&,double,
+                   int);
+
+void NEBProjectForces(VectorXd&,vector<VectorXd>&,VectorXd&,QMMMSettings&,
+                      int);
+
 VectorXd NEBTangent(VectorXd&,VectorXd&,QMMMSettings&,int);
 
 void NWChemCharges(vector<QMMMAtom>&,QMMMSettings&,int);
@@ -249,10 +352,35 @@ void PathLinInterpolate(int&,char**&);
 
 void PBCCenter(vector<QMMMAtom>&,QMMMSettings&);
 
+vector<QMMMAtom> PIContractRing(vector<QMMMAtom>&,QMMMSettings&,int);
+
+void PICopyFromSlots(vector<QMMMAtom>&,vector<QMMMAtom>&,int,int);
+
+void PICopyToSlots(vector<QMMMAtom>&,vector<QMMMAtom>&,int,int);
+
+vector<VectorXd> PIEffForces(vector<QMMMAtom>&,QMMMSettings&,
+                             vector<VectorXd>&);
+
+double PIForceLogProb(vector<QMMMAtom>&,vector<QMMMAtom>&,QMMMSettings&,
+                      vector<VectorXd>&,double);
+
+bool PIForceMove(vector<QMMMAtom>&,QMMMSettings&,double,double&);
+
+double PIForceStep(vector<QMMMAtom>&,vector<QMMMAtom>&,QMMMSettings&,
+                   vector<VectorXd>&,double);
+
+double PIModeMove(vector<QMMMAtom>&,QMMMSettings&,int,double);
+
+void PIMoveSetup(vector<QMMMAtom>&,QMMMSettings&);
+
+void PIPrintMoves(QMMMSettings&,bool);
+
 void PrintFancyTitle();
 
 void PrintLapin();
 
+void PrintUnitTest(string,bool);
+
 void Print_traj(vector<QMMMAtom>&,fstream&,QMMMSettings&);
 
 void PSI4Charges(vector<QMMMAtom>&,QMMMSettings&,int);
@@ -265,8 +393,15 @@ MatrixXd PSI4Hessian(vector<QMMMAtom>&,QMMMSettings&,int);
 
 double PSI4Opt(vector<QMMMAtom>&,QMMMSettings&,int);
 
+Matrix3d QCPRotation(Matrix3d&,double,double);
+
 void ReadArgs(int&,char**&,fstream&,fstream&,fstream&,fstream&);
 
+bool ReadInvHessian(MatrixXd&,vector<QMMMAtom>&,int);
+
+bool ReadLBFGSHist(vector<VectorXd>&,vector<VectorXd>&,vector<QMMMAtom>&,int,
+                   int,int);
+
 void ReadLICHEMInput(fstream&,fstream&,fstream&,
                      vector<QMMMAtom>&,QMMMSettings&);
 
@@ -294,14 +429,52 @@ double TINKERPolEnergy(vector<QMMMAtom>&,QMMMSettings&,int);
 
 double TINKERPolForces(vector<QMMMAtom>&,VectorXd&,QMMMSettings&,int);
 
+bool TestBlockingAR1();
+
+bool TestGEMFrame();
+
+bool TestGEMTwoSite();
+
+bool TestGPTraining();
+
+bool TestHermiteDerivs();
+
+bool TestLBFGSHistory();
+
+bool TestLanczosModes();
+
+bool TestLindhHessian();
+
+bool TestMALAHarmonic();
+
+bool TestPartialHessian();
+
+bool TestPhiloxKAT();
+
+bool TestQCPAlignment();
+
+bool TestQuadDiag();
+
 vector<int> TraceBoundary(vector<QMMMAtom>&,int);
 
+bool UnitTestClose(double,double,double);
+
+void UnitTestGEMPair(vector<QMMMAtom>&,Coord&);
+
+double UnitTestHarmonicWell(vector<QMMMAtom>&,double,int,vector<VectorXd>&);
+
 void WriteChargeFile(vector<QMMMAtom>&,QMMMSettings&,int);
 
 void WriteGauInput(vector<QMMMAtom>&,string,QMMMSettings&,int);
 
+void WriteInvHessian(MatrixXd&,vector<QMMMAtom>&,int);
+
+void WriteLBFGSHist(vector<VectorXd>&,vector<VectorXd>&,vector<QMMMAtom>&,int);
+
 void WriteNWChemInput(vector<QMMMAtom>&,string,QMMMSettings&,int);
 
+void WriteOptFingerprint(fstream&,vector<QMMMAtom>&,int);
+
 void WriteModes(vector<QMMMAtom>&,bool,VectorXd&,MatrixXd&,QMMMSettings&,int);
 
 void WritePSI4Input(vector<QMMMAtom>&,string,QMMMSettings&,int);
@@ -327,6 +500,7 @@ void WriteQMConnect(int&,char**&);
 #include "Struct_writer.cpp"
 #include "Text_format.cpp"
 #include "TINK2LICHEM.cpp"
+#include "Unit_tests.cpp"
 
 //Wrapper definitions (alphabetical)
 #include "GauExternal.cpp"
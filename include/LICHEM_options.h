@@ -22,34 +22,19 @@ namespace LICHEMOpts
   //Compile options
   const bool JOKES = 0; //Print humorous comments
 
+  //Frozen density options
+  const double GEMScreen = 1e-8; //Threshold for skipping Hermite pairs
+  const double GEMCut = 12.0; //Cutoff for GEM overlap and dispersion (Ang)
+
+  //Optimizer options
+  const double hessReuseDisp = 0.5; //Max. RMS shift for saved Hessians (Ang)
+
   //Monte Carlo options
   const bool isotrop = 1; //Force isotropic expansion in NPT Monte Carlo
   const double stepMin = 0.005; //Minimum Monte Carlo step size (Angstroms)
   const double stepMax = 1.0; //Maximum Monte Carlo step size (Angstroms)
   const double centRatio = 5.0; //Scales step size for path-integral centroids
   const int acc_Check = 2000; //Eq. Monte Carlo steps before checking accratio
-
-  //Move Probabilities for PIMC
-  /*
-
-  NB: The Monte Carlo engine allows for multi-particle moves:
-
-  If (BeadProb+CentProb) > 1) then there is a chance that multiple particles
-  move during a step.
-
-  If (BeadProb+CentProb) < 1) then there is a chance that no prarticles move
-  during a step.
-
-  If (VolProb > 0) and the simulation is not periodic, then VolProb does
-  nothing.
-
-  If the simulation is periodic, multi-particle moves will be common since
-  changing the box size moves all particles.
-
-  */
-  double beadProb = 0.60; //Probability to move all beads for an atom
-  double centProb = 0.50; //Probability to move a centroid
-  double volProb = 0.35; //Volume change probability
 };
 
 #endif
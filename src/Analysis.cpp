@@ -15,6 +15,16 @@
  Kabsch, Acta Crystallogr. Sect. A, 32, 922, (1976)
  Kabsch, Acta Crystallogr. Sect. A, 34, 827, (1978)
 
+ Reference for the Lindh model Hessian:
+ Lindh et al., Chem. Phys. Lett., 241, 4, 423, (1995)
+
+ Reference for the image dependent pair potential (IDPP):
+ Smidstrup et al., J. Chem. Phys., 140, 21, 214106, (2014)
+
+ Reference for the quaternion characteristic polynomial (QCP):
+ Theobald, Acta Crystallogr. Sect. A, 61, 478, (2005)
+ Liu et al., J. Comput. Chem., 31, 1561, (2010)
+
 */
 
 /*!
@@ -99,7 +109,218 @@ void BurstTraj(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
 
 //Trajectory manipulation functions
 
+//! \brief Calculates the IDPP objective function and forces for one image.
+//! \param imgPOS - Coordinates of the image
+//! \param pairI - First atom in each interacting pair
+//! \param pairJ - Second atom in each interacting pair
+//! \param targDist - Interpolated distance for each pair
+//! \param movID - Index of each atom in the force vector (-1 if fixed)
+//! \param forces - Forces on the moving atoms
+//! \return Weighted squared deviation from the interpolated distances
+double IDPPForces(vector<Coord>& imgPOS, vector<int>& pairI,
+                  vector<int>& pairJ, VectorXd& targDist,
+                  vector<int>& movID, VectorXd& forces)
+{
+  //Function to calculate the image dependent pair potential
+  double S = 0; //Objective function
+  forces.setZero();
+  for (unsigned int p=0;p<pairI.size();p++)
+  {
+    int i = pairI[p]; //First atom
+    int j = pairJ[p]; //Second atom
+    Coord dist = CoordDist2(imgPOS[i],imgPOS[j]); //Displacement
+    double R = sqrt(dist.vecMag()); //Current distance
+    double dR = targDist(p)-R; //Deviation from the interpolated distance
+    double wt = 1/(R*R*R*R); //Weight favoring short distances
+    S += wt*dR*dR;
+    //Forces from the derivative with respect to the distance
+    double fScale = (2*wt*dR+4*wt*dR*dR/R)/R; //Force over the distance
+    if (movID[i] >= 0)
+    {
+      forces(movID[i]) += fScale*dist.x;
+      forces(movID[i]+1) += fScale*dist.y;
+      forces(movID[i]+2) += fScale*dist.z;
+    }
+    if (movID[j] >= 0)
+    {
+      forces(movID[j]) -= fScale*dist.x;
+      forces(movID[j]+1) -= fScale*dist.y;
+      forces(movID[j]+2) -= fScale*dist.z;
+    }
+  }
+  return S;
+};
+
+//! \brief Relaxes an interpolated image with the IDPP.
+//! \param imgPOS - Initial coordinates of the image (updated)
+//! \param startPOS - Coordinates at the start of the path segment
+//! \param endPOS - Coordinates at the end of the path segment
+//! \param frac - Fractional position of the image along the segment
+void IDPPImage(vector<Coord>& imgPOS, vector<Coord>& startPOS,
+               vector<Coord>& endPOS, double frac)
+{
+  //Minimize the IDPP objective for one image with L-BFGS
+  int Nat = (int)imgPOS.size(); //Number of atoms
+  int maxIter = 2000; //Maximum number of L-BFGS steps
+  int maxHist = 10; //Number of saved L-BFGS pairs
+  double forceTol = 1e-4; //Convergence criteria for the max. force
+  double maxStep = 0.1; //Maximum step size
+  double stepScale = 0.01; //Steepest descent step size
+  double armijo = 1e-4; //Sufficient decrease parameter
+  //Only atoms which move along the segment are relaxed
+  vector<int> movID; //Index of the atom in the force vector
+  int Ndof = 0; //Number of moving degrees of freedom
+  for (int i=0;i<Nat;i++)
+  {
+    Coord dist = CoordDist2(startPOS[i],endPOS[i]);
+    movID.push_back(-1);
+    if (dist.vecMag() > (1e-12))
+    {
+      movID[i] = Ndof;
+      Ndof += 3;
+    }
+  }
+  if (Ndof == 0)
+  {
+    //Nothing moves
+    return;
+  }
+  //Create pair list and interpolate the distances
+  vector<int> pairI; //First atom in each pair
+  vector<int> pairJ; //Second atom in each pair
+  vector<double> targList; //Interpolated distances
+  for (int i=0;i<Nat;i++)
+  {
+    for (int j=(i+1);j<Nat;j++)
+    {
+      //Pairs of fixed atoms do not change the objective
+      if ((movID[i] >= 0) || (movID[j] >= 0))
+      {
+        double startDist, endDist; //Distances at the end points
+        startDist = sqrt(CoordDist2(startPOS[i],startPOS[j]).vecMag());
+        endDist = sqrt(CoordDist2(endPOS[i],endPOS[j]).vecMag());
+        pairI.push_back(i);
+        pairJ.push_back(j);
+        targList.push_back(startDist+frac*(endDist-startDist));
+      }
+    }
+  }
+  //Separate atoms which were interpolated on top of each other
+  for (unsigned int p=0;p<pairI.size();p++)
+  {
+    int i = pairI[p]; //First atom
+    int j = pairJ[p]; //Second atom
+    if (CoordDist2(imgPOS[i],imgPOS[j]).vecMag() < (1e-4))
+    {
+      //Small displacements which are different for each atom
+      int k = i; //Atom to move
+      if (movID[i] < 0)
+      {
+        k = j;
+      }
+      imgPOS[k].x += 0.01*cos(k+1.0);
+      imgPOS[k].y += 0.01*sin(k+1.0);
+      imgPOS[k].z += 0.01*cos(2*(k+1.0));
+    }
+  }
+  VectorXd targDist(targList.size()); //Interpolated distances
+  for (unsigned int p=0;p<targList.size();p++)
+  {
+    targDist(p) = targList[p];
+  }
+  //Create L-BFGS arrays
+  vector<VectorXd> stepHist; //Saved steps
+  vector<VectorXd> gradHist; //Saved changes in the gradient
+  vector<Coord> trialPOS; //Coordinates for the line search
+  VectorXd optVec(Ndof); //Optimization direction
+  VectorXd forces(Ndof); //Forces at the current coordinates
+  VectorXd trialForces(Ndof); //Forces at the trial coordinates
+  double S = IDPPForces(imgPOS,pairI,pairJ,targDist,movID,forces);
+  //Relax the image
+  int stepCt = 0; //Counter for optimization steps
+  while (stepCt < maxIter)
+  {
+    //Check convergence
+    if (forces.cwiseAbs().maxCoeff() < forceTol)
+    {
+      break;
+    }
+    //Calculate a new optimization direction
+    optVec = LBFGSDirection(forces,stepHist,gradHist);
+    if (stepHist.size() == 0)
+    {
+      //Steepest descent step
+      optVec *= stepScale;
+    }
+    if (optVec.dot(forces) <= 0)
+    {
+      //The direction is uphill, restart from steepest descent
+      stepHist.clear();
+      gradHist.clear();
+      optVec = stepScale*forces;
+    }
+    //Check step size
+    double vecMax = optVec.norm(); //Length of the step
+    if (vecMax > maxStep)
+    {
+      //Scale step size
+      optVec *= (maxStep/vecMax);
+    }
+    //Backtracking line search
+    double slope = optVec.dot(forces); //Decrease along the direction
+    double lineStep = 1; //Fraction of the optimization vector
+    double trialS = 0; //Objective at the trial coordinates
+    bool accStep = 0; //Flag to accept the step
+    while ((!accStep) && (lineStep > (1e-4)))
+    {
+      trialPOS = imgPOS;
+      for (int i=0;i<Nat;i++)
+      {
+        if (movID[i] >= 0)
+        {
+          trialPOS[i].x += lineStep*optVec(movID[i]);
+          trialPOS[i].y += lineStep*optVec(movID[i]+1);
+          trialPOS[i].z += lineStep*optVec(movID[i]+2);
+        }
+      }
+      trialS = IDPPForces(trialPOS,pairI,pairJ,targDist,movID,trialForces);
+      if (trialS <= (S-armijo*lineStep*slope))
+      {
+        accStep = 1;
+      }
+      else
+      {
+        lineStep *= 0.5;
+      }
+    }
+    stepCt += 1;
+    if (!accStep)
+    {
+      if (stepHist.size() == 0)
+      {
+        //Steepest descent cannot make progress
+        break;
+      }
+      //Restart from steepest descent
+      stepHist.clear();
+      gradHist.clear();
+      continue;
+    }
+    //Update the history and coordinates
+    VectorXd stepVec = lineStep*optVec; //Actual displacement
+    VectorXd gradDiff = forces-trialForces; //Change in the gradient
+    LBFGSUpdate(stepVec,gradDiff,stepHist,gradHist,maxHist);
+    imgPOS = trialPOS;
+    forces = trialForces;
+    S = trialS;
+  }
+  return;
+};
+
 //! \brief Reads reactant, TS, and product data to create a path.
+//!
+//! The path is linearly interpolated by default. With "-m IDPP", the
+//! intermediate beads are relaxed with the image dependent pair potential.
 //! \param argc - Initial number of arguments passed to LICHEM
 //! \param argv - Initial argument values passed to LICHEM
 void PathLinInterpolate(int& argc, char**& argv)
@@ -112,6 +333,7 @@ void PathLinInterpolate(int& argc, char**& argv)
   fstream reactFile, tsFile, prodFile, pathFile; //File streams
   int Nbeads = 3; //Default to react, ts, and prod
   bool includeTS = false; //Flag to use the TS structure
+  bool useIDPP = false; //Flag to relax the path with the IDPP
   bool doQuit = false; //Quit with an error
   reactFilename = "N/A";
   tsFilename = "N/A";
@@ -128,6 +350,22 @@ void PathLinInterpolate(int& argc, char**& argv)
       file << argv[i+1]; //Save to the stream
       file >> Nbeads; //Change to an int
     }
+    //Check interpolation method
+    if (dummy == "-m")
+    {
+      string method = string(argv[i+1]);
+      LICHEMLowerText(method);
+      if (method == "idpp")
+      {
+        useIDPP = true;
+      }
+      else if (method != "linear")
+      {
+        cout << "Error: Unknown interpolation method!!!";
+        cout << '\n';
+        doQuit = true;
+      }
+    }
     //Check reactant file
     if (dummy == "-r")
     {
@@ -279,90 +517,97 @@ void PathLinInterpolate(int& argc, char**& argv)
     }
   }
   //Interpolate between points
-  pathFile.open("BeadStartStruct.xyz",ios_base::out);
-  pathFile << (Natoms*Nbeads) << '\n' << '\n';
+  if (includeTS && ((Nbeads%2) != 1))
+  {
+    //Adjust number of beads
+    Nbeads += 1;
+    cout << "Warning: A three structure interpolation requires an odd";
+    cout << " number of points." << '\n';
+    cout << " Nbeads increased to " << Nbeads << '\n' << '\n';
+  }
+  vector<vector<Coord> > pathPOS; //Coordinates of all beads
+  vector<int> segStart; //Structure at the start of each bead's segment
+  vector<double> segFrac; //Fractional position along the segment
+  vector<vector<Coord> > endPOS; //Reactant, TS, and product coordinates
+  endPOS.push_back(reactPOS);
   if (includeTS)
   {
     //Linear interpolation between the react, ts, and prod structures
-    if ((Nbeads%2) != 1)
-    {
-      //Adjust number of beads
-      Nbeads += 1;
-      cout << "Warning: A three structure interpolation requires an odd";
-      cout << " number of points." << '\n';
-      cout << " Nbeads increased to " << Nbeads << '\n' << '\n';
-    }
-    for (int i=0;i<Natoms;i++)
+    endPOS.push_back(transPOS);
+    for (int j=0;j<Nbeads;j++)
     {
-      //Loop over first half of the beads
-      for (int j=0;j<((Nbeads-1)/2);j++)
-      {
-        //Print element
-        pathFile << atTyps[i] << " ";
-        //Print interpolated coordinates
-        double x,y,z;
-        x = reactPOS[i].x;
-        x += (2*j*transPOS[i].x)/(Nbeads-1);
-        x -= (2*j*reactPOS[i].x)/(Nbeads-1);
-        pathFile << LICHEMFormFloat(x,16) << " ";
-        y = reactPOS[i].y;
-        y += (2*j*transPOS[i].y)/(Nbeads-1);
-        y -= (2*j*reactPOS[i].y)/(Nbeads-1);
-        pathFile << LICHEMFormFloat(y,16) << " ";
-        z = reactPOS[i].z;
-        z += (2*j*transPOS[i].z)/(Nbeads-1);
-        z -= (2*j*reactPOS[i].z)/(Nbeads-1);
-        pathFile << LICHEMFormFloat(z,16) << '\n';
-      }
-      //Loop over second half of the beads
-      for (int j=0;j<(((Nbeads-1)/2)+1);j++)
-      {
-        //Print element
-        pathFile << atTyps[i] << " ";
-        //Print interpolated coordinates
-        double x,y,z;
-        x = transPOS[i].x;
-        x += (2*j*prodPOS[i].x)/(Nbeads-1);
-        x -= (2*j*transPOS[i].x)/(Nbeads-1);
-        pathFile << LICHEMFormFloat(x,16) << " ";
-        y = transPOS[i].y;
-        y += (2*j*prodPOS[i].y)/(Nbeads-1);
-        y -= (2*j*transPOS[i].y)/(Nbeads-1);
-        pathFile << LICHEMFormFloat(y,16) << " ";
-        z = transPOS[i].z;
-        z += (2*j*prodPOS[i].z)/(Nbeads-1);
-        z -= (2*j*transPOS[i].z)/(Nbeads-1);
-        pathFile << LICHEMFormFloat(z,16) << '\n';
+      //Beads after the TS are interpolated from the TS
+      int seg = 0;
+      int k = j; //Position along the segment
+      if (j >= ((Nbeads-1)/2))
+      {
+        seg = 1;
+        k -= ((Nbeads-1)/2);
       }
+      segStart.push_back(seg);
+      segFrac.push_back((2.0*k)/(Nbeads-1));
     }
   }
   else
   {
     //Linear interpolation between the react and prod structures
+    for (int j=0;j<Nbeads;j++)
+    {
+      segStart.push_back(0);
+      segFrac.push_back(((double)j)/(Nbeads-1));
+    }
+  }
+  endPOS.push_back(prodPOS);
+  for (int j=0;j<Nbeads;j++)
+  {
+    //Interpolate coordinates
+    vector<Coord> beadPOS; //Coordinates of the bead
+    int seg = segStart[j]; //Start of the segment
     for (int i=0;i<Natoms;i++)
     {
-      //Loop over beads
-      for (int j=0;j<Nbeads;j++)
+      Coord temppos;
+      temppos.x = endPOS[seg][i].x;
+      temppos.x += segFrac[j]*(endPOS[seg+1][i].x-endPOS[seg][i].x);
+      temppos.y = endPOS[seg][i].y;
+      temppos.y += segFrac[j]*(endPOS[seg+1][i].y-endPOS[seg][i].y);
+      temppos.z = endPOS[seg][i].z;
+      temppos.z += segFrac[j]*(endPOS[seg+1][i].z-endPOS[seg][i].z);
+      beadPOS.push_back(temppos);
+    }
+    pathPOS.push_back(beadPOS);
+  }
+  if (useIDPP)
+  {
+    //Relax the intermediate beads against the interpolated distances
+    cout << "Relaxing the path with the IDPP..." << '\n' << '\n';
+    cout.flush();
+    #pragma omp parallel for schedule(dynamic)
+    for (int j=0;j<Nbeads;j++)
+    {
+      int seg = segStart[j]; //Start of the segment
+      //The reactant, TS, and product are not modified
+      if ((segFrac[j] > 0) && (segFrac[j] < 1))
       {
-        //Print element
-        pathFile << atTyps[i] << " ";
-        //Print interpolated coordinates
-        double x,y,z;
-        x = reactPOS[i].x;
-        x += (j*prodPOS[i].x)/(Nbeads-1);
-        x -= (j*reactPOS[i].x)/(Nbeads-1);
-        pathFile << LICHEMFormFloat(x,16) << " ";
-        y = reactPOS[i].y;
-        y += (j*prodPOS[i].y)/(Nbeads-1);
-        y -= (j*reactPOS[i].y)/(Nbeads-1);
-        pathFile << LICHEMFormFloat(y,16) << " ";
-        z = reactPOS[i].z;
-        z += (j*prodPOS[i].z)/(Nbeads-1);
-        z -= (j*reactPOS[i].z)/(Nbeads-1);
-        pathFile << LICHEMFormFloat(z,16) << '\n';
+        IDPPImage(pathPOS[j],endPOS[seg],endPOS[seg+1],segFrac[j]);
       }
     }
   }
+  //Print the path
+  pathFile.open("BeadStartStruct.xyz",ios_base::out);
+  pathFile << (Natoms*Nbeads) << '\n' << '\n';
+  for (int i=0;i<Natoms;i++)
+  {
+    //Loop over beads
+    for (int j=0;j<Nbeads;j++)
+    {
+      //Print element
+      pathFile << atTyps[i] << " ";
+      //Print coordinates
+      pathFile << LICHEMFormFloat(pathPOS[j][i].x,16) << " ";
+      pathFile << LICHEMFormFloat(pathPOS[j][i].y,16) << " ";
+      pathFile << LICHEMFormFloat(pathPOS[j][i].z,16) << '\n';
+    }
+  }
   pathFile.flush();
   pathFile.close();
   //Exit LICHEM
@@ -515,120 +760,206 @@ void SplitPathTraj(int& argc, char**& argv)
   return;
 };
 
-//! \brief Translates and rotates two structures for maximum overlap.
-//! \param A - Matrix of coordinates for structure A
-//! \param B - Matrix of coordinates for structure B
-//! \param matSize - Number of atoms in structure A/B
-void KabschRotation(MatrixXd& A, MatrixXd& B, int matSize)
+//! \brief Finds the optimal rotation from a QCP superposition.
+//! \param coVar - Covariance matrix of the centered structures (B^T*A)
+//! \param GA - Sum of the squared coordinates of structure A
+//! \param GB - Sum of the squared coordinates of structure B
+//! \return rotMat - Rotation matrix which maps the rows of B onto A
+Matrix3d QCPRotation(Matrix3d& coVar, double GA, double GB)
 {
-  //Function to translate/rotate two structures for maximum overlap
-  MatrixXd coVar; //Covariance matrix
-  MatrixXd rotMat; //Rotation matrix
-  //Calculate the center of the structures
-  double Ax = 0; //Average x position of matrix A
-  double Ay = 0; //Average y position of matrix A
-  double Az = 0; //Average z position of matrix A
-  double Bx = 0; //Average x position of matrix B
-  double By = 0; //Average y position of matrix B
-  double Bz = 0; //Average z position of matrix B
-  #pragma omp parallel
+  //Function to find the optimal rotation with the QCP method
+  Matrix3d rotMat; //Rotation matrix
+  Matrix4d keyMat; //Symmetric quaternion key matrix
+  double Sxx = coVar(0,0); //Local copy
+  double Sxy = coVar(0,1); //Local copy
+  double Sxz = coVar(0,2); //Local copy
+  double Syx = coVar(1,0); //Local copy
+  double Syy = coVar(1,1); //Local copy
+  double Syz = coVar(1,2); //Local copy
+  double Szx = coVar(2,0); //Local copy
+  double Szy = coVar(2,1); //Local copy
+  double Szz = coVar(2,2); //Local copy
+  //Construct the key matrix
+  keyMat(0,0) = Sxx+Syy+Szz;
+  keyMat(0,1) = Syz-Szy;
+  keyMat(0,2) = Szx-Sxz;
+  keyMat(0,3) = Sxy-Syx;
+  keyMat(1,1) = Sxx-Syy-Szz;
+  keyMat(1,2) = Sxy+Syx;
+  keyMat(1,3) = Szx+Sxz;
+  keyMat(2,2) = -Sxx+Syy-Szz;
+  keyMat(2,3) = Syz+Szy;
+  keyMat(3,3) = -Sxx-Syy+Szz;
+  keyMat(1,0) = keyMat(0,1);
+  keyMat(2,0) = keyMat(0,2);
+  keyMat(3,0) = keyMat(0,3);
+  keyMat(2,1) = keyMat(1,2);
+  keyMat(3,1) = keyMat(1,3);
+  keyMat(3,2) = keyMat(2,3);
+  //Coefficients of the characteristic polynomial
+  double C2 = -2*coVar.squaredNorm(); //Quadratic coefficient
+  double C1 = -8*coVar.determinant(); //Linear coefficient
+  double C0 = keyMat.determinant(); //Constant
+  //Find the largest eigenvalue with Newton-Raphson
+  //NB: The iterations decrease monotonically from the upper bound, and the
+  //largest diagonal element of the key matrix is a lower bound
+  double lambda = 0.5*(GA+GB); //Upper bound for the eigenvalue
+  double lamMin = keyMat.diagonal().maxCoeff(); //Lower bound
+  for (int i=0;i<50;i++)
   {
-    //Update sum of the atomic positions
-    #pragma omp for nowait schedule(dynamic) reduction(+:Ax)
-    for (int i=0;i<matSize;i++)
+    double lam2 = lambda*lambda; //Squared eigenvalue
+    double poly = (lam2+C2)*lam2+C1*lambda+C0; //Polynomial
+    double deriv = 2*(2*lam2+C2)*lambda+C1; //Derivative
+    if ((poly <= 0) || (deriv <= 0))
     {
-      Ax += A(i,0);
+      //At the root within the numerical precision (multiple roots)
+      break;
     }
-    #pragma omp for nowait schedule(dynamic) reduction(+:Ay)
-    for (int i=0;i<matSize;i++)
+    double delta = poly/deriv; //Newton step
+    if ((lambda-delta) < lamMin)
     {
-      Ay += A(i,1);
+      //Roundoff near a multiple root, keep the bounded value
+      break;
     }
-    #pragma omp for nowait schedule(dynamic) reduction(+:Az)
-    for (int i=0;i<matSize;i++)
+    lambda -= delta;
+    if (abs(delta) <= (1e-14*abs(lambda)))
     {
-      Az += A(i,2);
-    }
-    #pragma omp for nowait schedule(dynamic) reduction(+:Bx)
-    for (int i=0;i<matSize;i++)
-    {
-      Bx += B(i,0);
-    }
-    #pragma omp for nowait schedule(dynamic) reduction(+:By)
-    for (int i=0;i<matSize;i++)
-    {
-      By += B(i,1);
-    }
-    #pragma omp for nowait schedule(dynamic) reduction(+:Bz)
-    for (int i=0;i<matSize;i++)
-    {
-      Bz += B(i,2);
+      //Converged
+      break;
     }
   }
-  #pragma omp barrier
-  //Take average
-  Ax /= matSize;
-  Ay /= matSize;
-  Az /= matSize;
-  Bx /= matSize;
-  By /= matSize;
-  Bz /= matSize;
-  //Translate centroids
-  #pragma omp parallel
+  //Find the quaternion from the adjoint of the shifted key matrix
+  Matrix4d shiftMat = keyMat; //Key matrix minus the eigenvalue
+  shiftMat -= lambda*Matrix4d::Identity();
+  Vector4d quat; //Rotation quaternion
+  double quatNorm = 0; //Squared norm of the best adjoint column
+  for (int j=0;j<4;j++)
   {
-    //Move A and B to (0,0,0)
-    #pragma omp for nowait schedule(dynamic)
-    for (int i=0;i<matSize;i++)
+    //Each column of the adjoint is parallel to the eigenvector
+    Vector4d adjCol; //Column of the adjoint matrix
+    for (int i=0;i<4;i++)
     {
-      A(i,0) -= Ax;
-    }
-    #pragma omp for nowait schedule(dynamic)
-    for (int i=0;i<matSize;i++)
-    {
-      A(i,1) -= Ay;
+      //Calculate the (j,i) cofactor
+      Matrix3d minorMat; //Minor of the shifted key matrix
+      int rowCt = 0; //Row counter for the minor
+      for (int k=0;k<4;k++)
+      {
+        if (k != j)
+        {
+          int colCt = 0; //Column counter for the minor
+          for (int l=0;l<4;l++)
+          {
+            if (l != i)
+            {
+              minorMat(rowCt,colCt) = shiftMat(k,l);
+              colCt += 1;
+            }
+          }
+          rowCt += 1;
+        }
+      }
+      adjCol(i) = minorMat.determinant();
+      if (((i+j)%2) == 1)
+      {
+        //Change sign for odd cofactors
+        adjCol(i) *= -1;
+      }
     }
-    #pragma omp for nowait schedule(dynamic)
-    for (int i=0;i<matSize;i++)
+    if (adjCol.squaredNorm() > quatNorm)
     {
-      A(i,2) -= Az;
+      //Save the largest column
+      quat = adjCol;
+      quatNorm = adjCol.squaredNorm();
     }
-    #pragma omp for nowait schedule(dynamic)
-    for (int i=0;i<matSize;i++)
+  }
+  //Check the eigenvector relative to the scale of the key matrix
+  double keyScale = keyMat.norm(); //Bound for the eigenvalues
+  bool degenerate = (quatNorm <= (1e-24*pow(keyScale,6))); //Small adjoint
+  if (!degenerate)
+  {
+    //Nearly degenerate eigenvalues give inaccurate adjoint columns, so the
+    //quaternion must be an eigenvector of the largest eigenvalue
+    quat /= sqrt(quatNorm);
+    Vector4d keyQuat = keyMat*quat; //Product with the key matrix
+    double rayQuo = quat.dot(keyQuat); //Rayleigh quotient
+    double resid = (keyQuat-rayQuo*quat).norm(); //Eigenvector residual
+    degenerate = (resid > (1e-10*keyScale));
+    degenerate = degenerate || (rayQuo < (lamMin-1e-10*keyScale));
+  }
+  if (degenerate)
+  {
+    //Degenerate eigenvalues, switch to a direct diagonalization
+    SelfAdjointEigenSolver<Matrix4d> keySolver(keyMat);
+    quat = keySolver.eigenvectors().col(3);
+  }
+  quat.normalize();
+  //Construct the rotation matrix (row vector convention)
+  double qw = quat(0); //Scalar part
+  double qx = quat(1); //Vector part
+  double qy = quat(2); //Vector part
+  double qz = quat(3); //Vector part
+  rotMat(0,0) = qw*qw+qx*qx-qy*qy-qz*qz;
+  rotMat(1,0) = 2*(qx*qy-qw*qz);
+  rotMat(2,0) = 2*(qx*qz+qw*qy);
+  rotMat(0,1) = 2*(qx*qy+qw*qz);
+  rotMat(1,1) = qw*qw-qx*qx+qy*qy-qz*qz;
+  rotMat(2,1) = 2*(qy*qz-qw*qx);
+  rotMat(0,2) = 2*(qx*qz-qw*qy);
+  rotMat(1,2) = 2*(qy*qz+qw*qx);
+  rotMat(2,2) = qw*qw-qx*qx-qy*qy+qz*qz;
+  //Return the rotation
+  return rotMat;
+};
+
+//! \brief Translates and rotates two structures for maximum overlap.
+//! \param A - Matrix of coordinates for structure A
+//! \param B - Matrix of coordinates for structure B
+//! \param matSize - Number of atoms in structure A/B
+void KabschRotation(MatrixXd& A, MatrixXd& B, int matSize)
+{
+  //Function to translate/rotate two structures for maximum overlap
+  Matrix3d coVar; //Covariance matrix
+  Matrix3d rotMat; //Rotation matrix
+  Vector3d centA; //Center of structure A
+  Vector3d centB; //Center of structure B
+  double GA = 0; //Sum of the squared coordinates of A
+  double GB = 0; //Sum of the squared coordinates of B
+  //Calculate the center of the structures
+  centA.setZero();
+  centB.setZero();
+  for (int i=0;i<matSize;i++)
+  {
+    for (int j=0;j<3;j++)
     {
-      B(i,0) -= Bx;
+      centA(j) += A(i,j);
+      centB(j) += B(i,j);
     }
-    #pragma omp for nowait schedule(dynamic)
-    for (int i=0;i<matSize;i++)
+  }
+  centA /= matSize;
+  centB /= matSize;
+  //Translate centroids and calculate the covariance matrix
+  coVar.setZero();
+  for (int i=0;i<matSize;i++)
+  {
+    for (int j=0;j<3;j++)
     {
-      B(i,1) -= By;
+      //Move A and B to (0,0,0)
+      A(i,j) -= centA(j);
+      B(i,j) -= centB(j);
+      GA += A(i,j)*A(i,j);
+      GB += B(i,j)*B(i,j);
     }
-    #pragma omp for nowait schedule(dynamic)
-    for (int i=0;i<matSize;i++)
+    for (int j=0;j<3;j++)
     {
-      B(i,2) -= Bz;
+      for (int k=0;k<3;k++)
+      {
+        coVar(j,k) += B(i,j)*A(i,k);
+      }
     }
   }
-  #pragma omp barrier
-  //Calculate covariance matrix
-  coVar = (B.transpose())*A;
-  //Compute SVD and identity matrix
-  JacobiSVD<MatrixXd> SVDMat(coVar,ComputeFullU|ComputeFullV);
-  MatrixXd detMat = SVDMat.matrixV()*(SVDMat.matrixU().transpose());
-  double signVal = detMat.determinant();
-  if (signVal < 0)
-  {
-    signVal = -1;
-  }
-  else
-  {
-    signVal = 1;
-  }
-  MatrixXd Ident(3,3);
-  Ident.setIdentity();
-  Ident(2,2) *= signVal; //Change sign for rotation
   //Find optimal rotation matrix
-  rotMat = SVDMat.matrixV()*Ident*(SVDMat.matrixU().transpose());
-  //Rotate matrix A
+  rotMat = QCPRotation(coVar,GA,GB);
+  //Rotate matrix B
   B *= rotMat;
   //Return the modified positions
   return;
@@ -646,7 +977,6 @@ VectorXd KabschDisplacement(MatrixXd& A, MatrixXd& B, int matSize)
   //Rotate structures
   KabschRotation(A,B,matSize);
   //Calculate displacement
-  #pragma omp parallel for schedule(dynamic)
   for (int i=0;i<(3*matSize);i++)
   {
     //Find the correct location in the arrays
@@ -659,6 +989,100 @@ VectorXd KabschDisplacement(MatrixXd& A, MatrixXd& B, int matSize)
   return dist;
 };
 
+//! \brief Calculates the aligned displacements between neighboring beads.
+//! \param QMMMData - QMMM atomic data for the path
+//! \param QMMMOpts - Simulation settings
+//! \param distNext - Displacements from bead p to p+1 (frame of bead p)
+//! \param distPrev - Displacements from bead p to p-1 (frame of bead p)
+void KabschPathDisplacement(vector<QMMMAtom>& QMMMData,
+                            QMMMSettings& QMMMOpts,
+                            vector<VectorXd>& distNext,
+                            vector<VectorXd>& distPrev)
+{
+  //Function to superimpose all neighboring beads along a path
+  int Ndof = 3*(Nqm+Npseudo); //Number of QM and PB degrees of freedom
+  vector<int> qmIDs; //Atoms included in the alignment
+  for (int i=0;i<Natoms;i++)
+  {
+    //Only include QM and PB regions
+    if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+    {
+      qmIDs.push_back(i);
+    }
+  }
+  int Nalign = (int)qmIDs.size(); //Number of aligned atoms
+  //Initialize displacements (zero at the end points)
+  distNext.resize(QMMMOpts.NBeads);
+  distPrev.resize(QMMMOpts.NBeads);
+  for (int p=0;p<QMMMOpts.NBeads;p++)
+  {
+    distNext[p].setZero(Ndof);
+    distPrev[p].setZero(Ndof);
+  }
+  //Superimpose each pair of neighboring beads once
+  #pragma omp parallel for schedule(dynamic)
+  for (int p=0;p<(QMMMOpts.NBeads-1);p++)
+  {
+    Matrix3d coVar; //Covariance matrix
+    Matrix3d rotMat; //Rotation matrix
+    Vector3d centA; //Center of bead p
+    Vector3d centB; //Center of bead p+1
+    double GA = 0; //Sum of the squared coordinates of bead p
+    double GB = 0; //Sum of the squared coordinates of bead p+1
+    //Calculate the center of the beads
+    centA.setZero();
+    centB.setZero();
+    for (int k=0;k<Nalign;k++)
+    {
+      int i = qmIDs[k]; //Atom ID
+      centA(0) += QMMMData[i].P[p].x;
+      centA(1) += QMMMData[i].P[p].y;
+      centA(2) += QMMMData[i].P[p].z;
+      centB(0) += QMMMData[i].P[p+1].x;
+      centB(1) += QMMMData[i].P[p+1].y;
+      centB(2) += QMMMData[i].P[p+1].z;
+    }
+    centA /= Nalign;
+    centB /= Nalign;
+    //Calculate the covariance matrix
+    coVar.setZero();
+    for (int k=0;k<Nalign;k++)
+    {
+      int i = qmIDs[k]; //Atom ID
+      Vector3d posA; //Centered position in bead p
+      Vector3d posB; //Centered position in bead p+1
+      posA << QMMMData[i].P[p].x,QMMMData[i].P[p].y,QMMMData[i].P[p].z;
+      posB << QMMMData[i].P[p+1].x,QMMMData[i].P[p+1].y,
+              QMMMData[i].P[p+1].z;
+      posA -= centA;
+      posB -= centB;
+      GA += posA.squaredNorm();
+      GB += posB.squaredNorm();
+      coVar += posB*posA.transpose();
+    }
+    //Find optimal rotation matrix
+    rotMat = QCPRotation(coVar,GA,GB);
+    //Calculate the displacements in the frames of both beads
+    for (int k=0;k<Nalign;k++)
+    {
+      int i = qmIDs[k]; //Atom ID
+      Vector3d posA; //Centered position in bead p
+      Vector3d posB; //Centered position in bead p+1
+      posA << QMMMData[i].P[p].x,QMMMData[i].P[p].y,QMMMData[i].P[p].z;
+      posB << QMMMData[i].P[p+1].x,QMMMData[i].P[p+1].y,
+              QMMMData[i].P[p+1].z;
+      posA -= centA;
+      posB -= centB;
+      //Bead p+1 rotated onto bead p
+      distNext[p].segment<3>(3*k) = posA-rotMat.transpose()*posB;
+      //Bead p rotated onto bead p+1 with the inverse rotation
+      distPrev[p+1].segment<3>(3*k) = posB-rotMat*posA;
+    }
+  }
+  //Return the displacements
+  return;
+};
+
 //Physical property analysis functions
 
 //! \brief Calculates the density of a periodic structure.
@@ -696,34 +1120,29 @@ VectorXd LICHEMFreq(vector<QMMMAtom>& QMMMData, MatrixXd& QMMMHess,
                     QMMMSettings& QMMMOpts, int bead, int& remCt)
 {
   //Function to perform a QMMM frequency analysis
-  double projTol = 0.65; //Amount of overlap to remove a mode
+  double normTol = 0.10; //Smallest norm for an orthogonalized rotation
   double zeroTol = 1.00; //Smallest possible frequency (cm^-1)
   int transRotCt = 0; //Number of deleted translation and rotational modes
   //Define variables
   int Ndof = 3*(Nqm+Npseudo); //Degrees of freedom
+  int Nmodes = Ndof; //Number of modes to calculate
+  if ((QMMMOpts.NFreqModes > 0) && (QMMMOpts.NFreqModes < Ndof))
+  {
+    //Only calculate the lowest frequencies
+    Nmodes = QMMMOpts.NFreqModes;
+  }
   //Define arrays
-  EigenSolver<MatrixXd> freqAnalysis;
   VectorXd QMMMFreqs(Ndof); //Vibrational frequencies (cm^-1)
   MatrixXd QMMMNormModes(Ndof,Ndof); //Normal modes
-  MatrixXd freqMatrix(Ndof,Ndof); //Diagonal frequency matrix
-  VectorXd transX(Ndof); //X translation
-  VectorXd transY(Ndof); //Y translation
-  VectorXd transZ(Ndof); //Z translation
-  VectorXd rotX(Ndof); //X rotation
-  VectorXd rotY(Ndof); //Y rotation
-  VectorXd rotZ(Ndof); //Z rotation
+  MatrixXd transRot(Ndof,6); //Model translation and rotation modes
+  MatrixXd projModes(Ndof,0); //Orthonormal modes removed by the projector
   //Initialize arrays
   QMMMFreqs.setZero();
   QMMMNormModes.setZero();
-  freqMatrix.setZero();
-  transX.setZero();
-  transY.setZero();
-  transZ.setZero();
-  rotX.setZero();
-  rotY.setZero();
-  rotZ.setZero();
+  transRot.setZero();
   //Collect QM and PB masses
   vector<double> masses;
+  vector<Coord> qmPos; //Positions of the QM and PB atoms
   for (int i=0;i<Natoms;i++)
   {
     //Locate QM and PB atoms
@@ -734,6 +1153,7 @@ VectorXd LICHEMFreq(vector<QMMMAtom>& QMMMData, MatrixXd& QMMMHess,
       masses.push_back(massVal); //X component
       masses.push_back(massVal); //Y component
       masses.push_back(massVal); //Z component
+      qmPos.push_back(QMMMData[i].P[bead]);
     }
   }
   //Mass scale the Hessian matrix
@@ -751,90 +1171,144 @@ VectorXd LICHEMFreq(vector<QMMMAtom>& QMMMData, MatrixXd& QMMMHess,
       QMMMHess(j,i) = QMMMHess(i,j);
     }
   }
-  //Diagonalize Hessian matrix
-  freqAnalysis.compute(QMMMHess);
-  QMMMFreqs = freqAnalysis.eigenvalues().real();
-  QMMMNormModes = freqAnalysis.eigenvectors().real();
-  //Create model translation and rotation modes
-  #pragma omp parallel for
-  for (int i=0;i<(Nqm+Npseudo);i++)
-  {
-    //Translational modes
-    transX(3*i) = sqrt(masses[3*i]);
-    transY(3*i+1) = sqrt(masses[3*i+1]);
-    transZ(3*i+2) = sqrt(masses[3*i+2]);
-  }
-  transX.normalize();
-  transY.normalize();
-  transZ.normalize();
-  //Remove translation and rotation
-  transRotCt = 0; //Use as a counter
-  #pragma omp parallel for reduction(+:transRotCt)
-  for (int i=0;i<Ndof;i++)
+  //Find the displaced degrees of freedom for partial Hessians
+  vector<int> actDOF; //Active rows and columns of the Hessian
+  int ct = 0; //Counter for QM and PB atoms
+  for (int i=0;i<Natoms;i++)
   {
-    bool isTransRot = false;
-    double dotTest; //Saves overlap
-    //Locate translations
-    dotTest = abs(transX.dot(QMMMNormModes.col(i)));
-    if (dotTest > projTol)
+    if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
     {
-      isTransRot = true;
+      if (QMMMData[i].HessActive)
+      {
+        actDOF.push_back(3*ct);
+        actDOF.push_back(3*ct+1);
+        actDOF.push_back(3*ct+2);
+      }
+      ct += 1;
     }
-    dotTest = abs(transY.dot(QMMMNormModes.col(i)));
-    if (dotTest > projTol)
+  }
+  int Nact = (int)actDOF.size(); //Number of active degrees of freedom
+  bool partHess = (Nact < Ndof); //Only part of the Hessian was calculated
+  //Project out translations and rotations (Eckart conditions)
+  //NB: Partial Hessians are not invariant to the rigid body motions of the
+  //active atoms, so only the active block is diagonalized
+  if ((!QMMM) && (!partHess))
+  {
+    //Find the center of mass
+    Coord COM; //Center of mass
+    double totMass = 0; //Total mass
+    COM.x = 0;
+    COM.y = 0;
+    COM.z = 0;
+    for (int i=0;i<(Nqm+Npseudo);i++)
     {
-      isTransRot = true;
+      COM.x += masses[3*i]*qmPos[i].x;
+      COM.y += masses[3*i]*qmPos[i].y;
+      COM.z += masses[3*i]*qmPos[i].z;
+      totMass += masses[3*i];
     }
-    dotTest = abs(transZ.dot(QMMMNormModes.col(i)));
-    if (dotTest > projTol)
+    COM.x /= totMass;
+    COM.y /= totMass;
+    COM.z /= totMass;
+    //Create model translation and rotation modes
+    #pragma omp parallel for
+    for (int i=0;i<(Nqm+Npseudo);i++)
     {
-      isTransRot = true;
+      double sqrtM = sqrt(masses[3*i]); //Mass weight
+      double dx = qmPos[i].x-COM.x; //X displacement from the COM
+      double dy = qmPos[i].y-COM.y; //Y displacement from the COM
+      double dz = qmPos[i].z-COM.z; //Z displacement from the COM
+      //Translational modes
+      transRot(3*i,0) = sqrtM;
+      transRot(3*i+1,1) = sqrtM;
+      transRot(3*i+2,2) = sqrtM;
+      //Rotational modes
+      transRot(3*i+1,3) = -1*sqrtM*dz;
+      transRot(3*i+2,3) = sqrtM*dy;
+      transRot(3*i,4) = sqrtM*dz;
+      transRot(3*i+2,4) = -1*sqrtM*dx;
+      transRot(3*i,5) = -1*sqrtM*dy;
+      transRot(3*i+1,5) = sqrtM*dx;
     }
-    //Locate rotations
-    dotTest = abs(rotX.dot(QMMMNormModes.col(i)));
-    if (dotTest > projTol)
+    //Orthonormalize the modes (linear molecules have two rotations)
+    for (int i=0;i<6;i++)
     {
-      isTransRot = true;
+      VectorXd modeVec = transRot.col(i); //Temporary storage
+      double oldNorm = modeVec.norm(); //Norm before orthogonalization
+      for (int j=0;j<projModes.cols();j++)
+      {
+        modeVec -= projModes.col(j).dot(modeVec)*projModes.col(j);
+      }
+      if ((oldNorm > 0) && (modeVec.norm() > (normTol*oldNorm)))
+      {
+        //Save the new mode
+        modeVec.normalize();
+        projModes.conservativeResize(Ndof,projModes.cols()+1);
+        projModes.col(projModes.cols()-1) = modeVec;
+      }
     }
-    dotTest = abs(rotY.dot(QMMMNormModes.col(i)));
-    if (dotTest > projTol)
+    //Apply the projector to the Hessian
+    MatrixXd projMat(Ndof,Ndof); //Eckart projector
+    projMat.setIdentity();
+    projMat -= projModes*projModes.transpose();
+    QMMMHess = projMat*QMMMHess*projMat;
+  }
+  //Diagonalize Hessian matrix
+  if (partHess)
+  {
+    //Extract the active block
+    MatrixXd actHess(Nact,Nact); //Active part of the Hessian
+    MatrixXd actModes; //Normal modes of the active atoms
+    VectorXd actFreqs; //Eigenvalues of the active block
+    for (int i=0;i<Nact;i++)
     {
-      isTransRot = true;
+      for (int j=0;j<Nact;j++)
+      {
+        actHess(i,j) = QMMMHess(actDOF[i],actDOF[j]);
+      }
     }
-    dotTest = abs(rotZ.dot(QMMMNormModes.col(i)));
-    if (dotTest > projTol)
+    if (Nmodes < Nact)
     {
-      isTransRot = true;
+      //Iteratively find the lowest vibrational modes
+      MatrixXd noModes(Nact,0); //Nothing is projected
+      LanczosModes(actHess,noModes,Nmodes,actFreqs,actModes);
     }
-    //Locate small frequencies
-    double smallFreq; //Temporary storage
-    smallFreq = zeroTol/har2Wavenum; //Convert tolerance to a.u.
-    smallFreq *= smallFreq; //Square tolerance
-    if (abs(QMMMFreqs(i)) < smallFreq)
+    else
     {
-      isTransRot = true;
+      //Find all modes with the symmetric eigensolver
+      SelfAdjointEigenSolver<MatrixXd> freqAnalysis(actHess);
+      actFreqs = freqAnalysis.eigenvalues();
+      actModes = freqAnalysis.eigenvectors();
+      Nmodes = Nact;
     }
-    //Adjust frequencies
-    if (isTransRot && (!QMMM))
+    //Copy the modes back to the full set of coordinates
+    for (int i=0;i<actFreqs.size();i++)
     {
-      //Remove frequency
-      QMMMFreqs(i);
-      freqMatrix(i,i) = 0;
-      transRotCt += 1;
+      QMMMFreqs(i) = actFreqs(i);
+      for (int j=0;j<Nact;j++)
+      {
+        QMMMNormModes(actDOF[j],i) = actModes(j,i);
+      }
     }
-    else
+  }
+  else if (Nmodes < Ndof)
+  {
+    //Iteratively find the lowest vibrational modes
+    VectorXd lowFreqs; //Lowest eigenvalues
+    MatrixXd lowModes; //Lowest eigenvectors
+    LanczosModes(QMMMHess,projModes,Nmodes,lowFreqs,lowModes);
+    for (int i=0;i<lowFreqs.size();i++)
     {
-      //Save frequency
-      freqMatrix(i,i) = QMMMFreqs(i);
+      QMMMFreqs(i) = lowFreqs(i);
+      QMMMNormModes.col(i) = lowModes.col(i);
     }
   }
-  if (transRotCt > 0)
+  else
   {
-    //Remove unwanted frequencies
-    QMMMHess = QMMMNormModes*freqMatrix*QMMMNormModes.inverse();
-    freqAnalysis.compute(QMMMHess);
-    QMMMFreqs = freqAnalysis.eigenvalues().real();
-    QMMMNormModes = freqAnalysis.eigenvectors().real();
+    //Find all modes with the symmetric eigensolver
+    SelfAdjointEigenSolver<MatrixXd> freqAnalysis(QMMMHess);
+    QMMMFreqs = freqAnalysis.eigenvalues();
+    QMMMNormModes = freqAnalysis.eigenvectors();
   }
   //Take the square root and keep the sign
   #pragma omp parallel for
@@ -858,7 +1332,7 @@ VectorXd LICHEMFreq(vector<QMMMAtom>& QMMMData, MatrixXd& QMMMHess,
   //Remove negligible frequencies
   transRotCt = 0; //Reset counter
   #pragma omp parallel for reduction(+:transRotCt)
-  for (int i=0;i<Ndof;i++)
+  for (int i=0;i<Nmodes;i++)
   {
     //Delete frequencies below the tolerance
     if (abs(QMMMFreqs(i)) < zeroTol)
@@ -867,6 +1341,11 @@ VectorXd LICHEMFreq(vector<QMMMAtom>& QMMMData, MatrixXd& QMMMHess,
       QMMMFreqs(i) = 0;
     }
   }
+  if (Nmodes < Ndof)
+  {
+    //The projected modes are never found by the iterative solver
+    transRotCt += projModes.cols();
+  }
   //Write normal modes
   if (QMMMOpts.printNormModes)
   {
@@ -886,6 +1365,521 @@ VectorXd LICHEMFreq(vector<QMMMAtom>& QMMMData, MatrixXd& QMMMHess,
   return QMMMFreqs;
 };
 
+//! \brief Finds the lowest eigenpairs of a symmetric matrix with the
+//! block Lanczos method (full reorthogonalization).
+//! \param hessMat - Symmetric (projected) Hessian matrix
+//! \param projModes - Orthonormal modes excluded from the Krylov space
+//! \param Nmodes - Number of eigenpairs to calculate
+//! \param eigVals - Output array of the lowest eigenvalues
+//! \param eigVecs - Output matrix of the corresponding eigenvectors
+//! \note Degenerate eigenvalues are resolved up to the block size.
+void LanczosModes(MatrixXd& hessMat, MatrixXd& projModes, int Nmodes,
+                  VectorXd& eigVals, MatrixXd& eigVecs)
+{
+  //Function to iteratively calculate the lowest eigenpairs
+  double lanTol = 1e-8; //Relative tolerance for the Ritz residuals
+  double breakTol = 1e-10; //Relative norm for a deflated vector
+  int Ndim = hessMat.rows(); //Size of the matrix
+  int maxIter = Ndim-projModes.cols(); //Size of the allowed space
+  int Nblock = min(Nmodes,4); //Block size (largest resolved degeneracy)
+  int iterCt = 0; //Size of the current Krylov space
+  bool lanDone = 0; //Flag to stop the iterations
+  //Define arrays
+  MatrixXd krylov(Ndim,maxIter); //Lanczos vectors
+  MatrixXd hessKrylov(Ndim,maxIter); //Hessian times the Lanczos vectors
+  MatrixXd lanBlock(Ndim,Nblock); //Current block of residual vectors
+  SelfAdjointEigenSolver<MatrixXd> ritzAnalysis; //Projected eigensolver
+  if ((maxIter < 1) || (Nblock < 1))
+  {
+    //Every mode was projected out
+    eigVals.resize(0);
+    eigVecs.resize(Ndim,0);
+    return;
+  }
+  //Create deterministic starting vectors
+  for (int b=0;b<Nblock;b++)
+  {
+    for (int i=0;i<Ndim;i++)
+    {
+      lanBlock(i,b) = cos((b+1)*(i+1))+1.0+0.1*(i%7);
+    }
+  }
+  //Build the Krylov space one block at a time
+  while (!lanDone)
+  {
+    int blockStart = iterCt; //First vector of the new block
+    for (int b=0;b<lanBlock.cols();b++)
+    {
+      //Orthogonalize against all previous vectors (twice is enough)
+      VectorXd lanVec = lanBlock.col(b); //New Lanczos vector
+      double oldNorm = lanVec.norm(); //Norm before the projections
+      for (int k=0;k<2;k++)
+      {
+        lanVec -= krylov.leftCols(iterCt)*
+                  (krylov.leftCols(iterCt).transpose()*lanVec);
+        lanVec -= projModes*(projModes.transpose()*lanVec);
+      }
+      //Deflate vectors which are already in the Krylov space
+      if ((iterCt < maxIter) && (lanVec.norm() > (breakTol*oldNorm)))
+      {
+        krylov.col(iterCt) = lanVec.normalized();
+        hessKrylov.col(iterCt) = hessMat*krylov.col(iterCt);
+        iterCt += 1;
+      }
+    }
+    int Nnew = iterCt-blockStart; //Number of vectors in the new block
+    if ((Nnew == 0) || (iterCt == maxIter))
+    {
+      //The Krylov space cannot grow
+      lanDone = 1;
+    }
+    if (iterCt == 0)
+    {
+      //The starting vectors were projected out
+      eigVals.resize(0);
+      eigVecs.resize(Ndim,0);
+      return;
+    }
+    //Check for convergence once per block
+    if ((iterCt >= (Nmodes+Nblock)) || lanDone)
+    {
+      MatrixXd ritzMat; //Projected Hessian
+      ritzMat = krylov.leftCols(iterCt).transpose()*
+                hessKrylov.leftCols(iterCt);
+      ritzMat = 0.5*(ritzMat+ritzMat.transpose());
+      ritzAnalysis.compute(ritzMat);
+      int Nfound = min(Nmodes,iterCt); //Number of Ritz pairs to check
+      double matScale = ritzAnalysis.eigenvalues().cwiseAbs().maxCoeff();
+      MatrixXd ritzVecs = ritzAnalysis.eigenvectors().leftCols(Nfound);
+      MatrixXd ritzRes; //Residuals of the Ritz pairs
+      ritzRes = hessKrylov.leftCols(iterCt)*ritzVecs;
+      ritzRes -= krylov.leftCols(iterCt)*ritzVecs*
+                 ritzAnalysis.eigenvalues().head(Nfound).asDiagonal();
+      bool allConv = 1; //Flag for converged Ritz pairs
+      for (int k=0;k<Nfound;k++)
+      {
+        if (ritzRes.col(k).norm() > (lanTol*matScale))
+        {
+          allConv = 0;
+        }
+      }
+      if (allConv && (Nfound == Nmodes))
+      {
+        lanDone = 1;
+      }
+    }
+    if (!lanDone)
+    {
+      //The next block is the Hessian times the new vectors
+      lanBlock = hessKrylov.block(0,blockStart,Ndim,Nnew);
+    }
+  }
+  //Save the Ritz pairs
+  int Nfound = min(Nmodes,iterCt); //Number of converged modes
+  eigVals = ritzAnalysis.eigenvalues().head(Nfound);
+  eigVecs = krylov.leftCols(iterCt)*
+            ritzAnalysis.eigenvectors().leftCols(Nfound);
+  return;
+};
+
+//! \brief Calculates the QM and PB Hessian from finite differences of the
+//! wrapper forces.
+//! \param QMMMData - Simulation trajectory data
+//! \param QMMMOpts - Simulation settings
+//! \param bead - Replica used to calculate the Hessian
+//! \return QMMMHess - Symmetric Hessian matrix (a.u.)
+MatrixXd LICHEMFDHessian(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts,
+                         int bead)
+{
+  //Function to calculate a Hessian with central differences
+  stringstream call; //Stream for system calls
+  int Ndof = 3*(Nqm+Npseudo); //Number of QM and PB degrees of freedom
+  double hStep = QMMMOpts.FDStep; //Displacement (Ang)
+  MatrixXd QMMMHess(Ndof,Ndof); //Final Hessian
+  QMMMHess.setZero();
+  //Locate the displaced degrees of freedom
+  vector<int> dofAtoms; //Atom for each active degree of freedom
+  vector<int> dofIDs; //Position in the QM/PB arrays
+  int ct = 0; //Counter for QM and PB atoms
+  for (int i=0;i<Natoms;i++)
+  {
+    if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+    {
+      if (QMMMData[i].HessActive)
+      {
+        for (int j=0;j<3;j++)
+        {
+          dofAtoms.push_back(i);
+          dofIDs.push_back(3*ct+j);
+        }
+      }
+      ct += 1;
+    }
+  }
+  if (dofIDs.size() == 0)
+  {
+    //Hess_atoms did not select any QM or PB atoms
+    cout << "Error: No QM or PB atoms are active in the Hessian!!!";
+    cout << '\n' << '\n';
+    cout.flush();
+    exit(0);
+  }
+  int Njobs = 2*((int)dofIDs.size()); //Number of displaced structures
+  MatrixXd fdForces(Ndof,Njobs); //Forces for each displacement
+  fdForces.setZero();
+  //Divide the cores between the wrapper calculations
+  int fdThreads = (int)floor(((double)FindMaxThreads())/Ncpus);
+  if (fdThreads < 1)
+  {
+    fdThreads = 1;
+  }
+  if (fdThreads > Njobs)
+  {
+    fdThreads = Njobs;
+  }
+  //Create scratch replicas for the displaced structures
+  vector<QMMMAtom> fdData = QMMMData; //Local copy
+  int firstSlot = (int)QMMMData[0].P.size(); //First scratch replica
+  for (int i=0;i<Natoms;i++)
+  {
+    for (int j=0;j<fdThreads;j++)
+    {
+      Coord tmp = QMMMData[i].P[bead];
+      fdData[i].P.push_back(tmp);
+      MPole tmp2 = QMMMData[i].MP[bead];
+      fdData[i].MP.push_back(tmp2);
+      OctCharges tmp3 = QMMMData[i].PC[bead];
+      fdData[i].PC.push_back(tmp3);
+    }
+  }
+  //Start the scratch replicas from the converged wavefunction
+  for (int j=0;j<fdThreads;j++)
+  {
+    int slot = firstSlot+j; //Scratch replica
+    if (Gaussian && (QMMMOpts.func != "SemiEmp"))
+    {
+      call.str("");
+      call << "cp LICHM_" << bead << ".chk ";
+      call << "LICHM_" << slot << ".chk";
+      call << " 2> LICHM_" << slot << ".trash; ";
+      call << "rm -f LICHM_" << slot << ".trash";
+      globalSys = system(call.str().c_str());
+    }
+    if (PSI4)
+    {
+      call.str("");
+      call << "cp LICHM_" << bead << ".180 ";
+      call << "LICHM_" << slot << ".180";
+      call << " 2> LICHM_" << slot << ".trash; ";
+      call << "rm -f LICHM_" << slot << ".trash";
+      globalSys = system(call.str().c_str());
+    }
+  }
+  //Calculate the forces for batches of displacements
+  for (int batch=0;batch<Njobs;batch+=fdThreads)
+  {
+    int Nbatch = min(fdThreads,Njobs-batch); //Jobs in this batch
+    #pragma omp parallel for schedule(dynamic) num_threads(Nbatch) \
+            reduction(+:QMTime,MMTime)
+    for (int j=0;j<Nbatch;j++)
+    {
+      int job = batch+j; //Displacement ID
+      int slot = firstSlot+j; //Scratch replica
+      int at = dofAtoms[job/2]; //Displaced atom
+      int dir = dofIDs[job/2]%3; //Displaced direction
+      double disp = hStep; //Signed displacement
+      if ((job%2) == 1)
+      {
+        disp = -1*hStep;
+      }
+      //Reset and displace the structure
+      for (int i=0;i<Natoms;i++)
+      {
+        fdData[i].P[slot] = QMMMData[i].P[bead];
+      }
+      if (dir == 0)
+      {
+        fdData[at].P[slot].x += disp;
+      }
+      if (dir == 1)
+      {
+        fdData[at].P[slot].y += disp;
+      }
+      if (dir == 2)
+      {
+        fdData[at].P[slot].z += disp;
+      }
+      //Timer variables
+      int tStart = 0;
+      int times_qm = 0;
+      int times_mm = 0;
+      VectorXd forces(Ndof); //Forces for this displacement
+      forces.setZero();
+      if (Nmm > 0)
+      {
+        WriteChargeFile(fdData,QMMMOpts,slot);
+      }
+      //Calculate forces (QM part)
+      if (Gaussian)
+      {
+        tStart = (unsigned)time(0);
+        GaussianForces(fdData,forces,QMMMOpts,slot);
+        times_qm += (unsigned)time(0)-tStart;
+      }
+      if (PSI4)
+      {
+        tStart = (unsigned)time(0);
+        PSI4Forces(fdData,forces,QMMMOpts,slot);
+        times_qm += (unsigned)time(0)-tStart;
+        //Delete annoying useless files
+        globalSys = system("rm -f psi.* timer.*");
+      }
+      if (NWChem)
+      {
+        tStart = (unsigned)time(0);
+        NWChemForces(fdData,forces,QMMMOpts,slot);
+        times_qm += (unsigned)time(0)-tStart;
+      }
+      //Calculate forces (MM part)
+      if (TINKER)
+      {
+        tStart = (unsigned)time(0);
+        TINKERForces(fdData,forces,QMMMOpts,slot);
+        if (AMOEBA || QMMMOpts.useImpSolv)
+        {
+          //Forces from MM polarization
+          TINKERPolForces(fdData,forces,QMMMOpts,slot);
+        }
+        times_mm += (unsigned)time(0)-tStart;
+      }
+      if (LAMMPS)
+      {
+        tStart = (unsigned)time(0);
+        LAMMPSForces(fdData,forces,QMMMOpts,slot);
+        times_mm += (unsigned)time(0)-tStart;
+      }
+      //Save results
+      fdForces.col(job) = forces;
+      QMTime += times_qm;
+      MMTime += times_mm;
+    }
+  }
+  //Calculate the Hessian columns
+  for (unsigned int k=0;k<dofIDs.size();k++)
+  {
+    //Central difference of the gradient
+    QMMMHess.col(dofIDs[k]) = fdForces.col(2*k+1)-fdForces.col(2*k);
+    QMMMHess.col(dofIDs[k]) /= 2*hStep;
+  }
+  //Only keep the block of displaced coordinates (partial Hessian)
+  VectorXd activeDOF(Ndof); //Mask for the displaced coordinates
+  activeDOF.setZero();
+  for (unsigned int k=0;k<dofIDs.size();k++)
+  {
+    activeDOF(dofIDs[k]) = 1;
+  }
+  QMMMHess = activeDOF.asDiagonal()*QMMMHess;
+  //Symmetrize the Hessian
+  QMMMHess = 0.5*(QMMMHess+QMMMHess.transpose()).eval();
+  //Change units to a.u.
+  QMMMHess *= bohrRad*bohrRad/har2eV;
+  //Clean up files
+  for (int j=0;j<fdThreads;j++)
+  {
+    int slot = firstSlot+j; //Scratch replica
+    call.str("");
+    call << "rm -f LICHM_" << slot << ".*";
+    call << " MMCharges_" << slot << ".txt";
+    globalSys = system(call.str().c_str());
+  }
+  //Return Hessian
+  return QMMMHess;
+};
+
+//! \brief Builds the Lindh model Hessian for the QM and PB atoms.
+//! \param QMMMData - Simulation trajectory data
+//! \param bead - Replica used to calculate the Hessian
+//! \return QMMMHess - Symmetric model Hessian matrix (a.u.)
+MatrixXd LindhHessian(vector<QMMMAtom>& QMMMData, int bead)
+{
+  //Function to calculate a model Hessian from the Lindh force field
+  int Nact = Nqm+Npseudo; //Number of QM and PB atoms
+  int Ndof = 3*Nact; //Number of QM and PB degrees of freedom
+  double rhoTol = 1e-4; //Smallest screened force constant
+  //Lindh parameters for rows 1, 2, and 3+ of the periodic table
+  double alpha[3][3] = {{1.0000,0.3949,0.3949},
+                        {0.3949,0.2800,0.2800},
+                        {0.3949,0.2800,0.2800}};
+  double rRef[3][3] = {{1.35,2.10,2.53},
+                       {2.10,2.87,3.40},
+                       {2.53,3.40,3.40}};
+  double kStr = 0.45; //Stretch force constant
+  double kBend = 0.15; //Bend force constant
+  double kTors = 0.005; //Torsion force constant
+  MatrixXd QMMMHess(Ndof,Ndof); //Final Hessian
+  QMMMHess.setZero();
+  //Collect the QM and PB atoms
+  vector<Vector3d> pos; //Positions (bohr)
+  vector<int> row; //Row of the periodic table
+  for (int i=0;i<Natoms;i++)
+  {
+    if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+    {
+      Vector3d tmp; //Position in a.u.
+      tmp(0) = QMMMData[i].P[bead].x/bohrRad;
+      tmp(1) = QMMMData[i].P[bead].y/bohrRad;
+      tmp(2) = QMMMData[i].P[bead].z/bohrRad;
+      pos.push_back(tmp);
+      int Z = chemTable.revTyping(QMMMData[i].QMTyp); //Nuclear charge
+      if (Z <= 2)
+      {
+        row.push_back(0);
+      }
+      else if (Z <= 10)
+      {
+        row.push_back(1);
+      }
+      else
+      {
+        row.push_back(2);
+      }
+    }
+  }
+  //Calculate the screening factors
+  MatrixXd rho(Nact,Nact); //Pair screening factors
+  rho.setZero();
+  for (int i=0;i<Nact;i++)
+  {
+    for (int j=(i+1);j<Nact;j++)
+    {
+      double r2 = (pos[i]-pos[j]).squaredNorm(); //Squared distance
+      double rr = rRef[row[i]][row[j]]; //Reference distance
+      rho(i,j) = exp(alpha[row[i]][row[j]]*(rr*rr-r2));
+      rho(j,i) = rho(i,j);
+    }
+  }
+  //Add stretches
+  for (int i=0;i<Nact;i++)
+  {
+    for (int j=(i+1);j<Nact;j++)
+    {
+      if (rho(i,j) >= rhoTol)
+      {
+        Vector3d bVec = pos[i]-pos[j]; //Wilson B-matrix row
+        bVec.normalize();
+        Matrix3d blk = kStr*rho(i,j)*bVec*bVec.transpose(); //Hessian block
+        QMMMHess.block(3*i,3*i,3,3) += blk;
+        QMMMHess.block(3*j,3*j,3,3) += blk;
+        QMMMHess.block(3*i,3*j,3,3) -= blk;
+        QMMMHess.block(3*j,3*i,3,3) -= blk;
+      }
+    }
+  }
+  //Add bends around the central atom j
+  for (int j=0;j<Nact;j++)
+  {
+    for (int i=0;i<Nact;i++)
+    {
+      for (int k=(i+1);k<Nact;k++)
+      {
+        if ((i == j) || (k == j))
+        {
+          continue;
+        }
+        double kIJK = kBend*rho(i,j)*rho(j,k); //Screened force constant
+        if (kIJK < (kBend*rhoTol))
+        {
+          continue;
+        }
+        Vector3d u = pos[i]-pos[j]; //First bond
+        Vector3d v = pos[k]-pos[j]; //Second bond
+        double uLen = u.norm();
+        double vLen = v.norm();
+        u /= uLen;
+        v /= vLen;
+        double cosAng = u.dot(v); //Cosine of the angle
+        double sinAng = sqrt(1-cosAng*cosAng); //Sine of the angle
+        if (sinAng < 1e-3)
+        {
+          //Skip linear bends
+          continue;
+        }
+        vector<Vector3d> bVec(3); //Wilson B-matrix row
+        bVec[0] = (cosAng*u-v)/(uLen*sinAng);
+        bVec[2] = (cosAng*v-u)/(vLen*sinAng);
+        bVec[1] = -1*(bVec[0]+bVec[2]);
+        int ids[3] = {i,j,k}; //Atoms in the bend
+        for (int a=0;a<3;a++)
+        {
+          for (int b=0;b<3;b++)
+          {
+            QMMMHess.block(3*ids[a],3*ids[b],3,3) +=
+                 kIJK*bVec[a]*bVec[b].transpose();
+          }
+        }
+      }
+    }
+  }
+  //Add torsions around the central bond j-k
+  for (int j=0;j<Nact;j++)
+  {
+    for (int k=(j+1);k<Nact;k++)
+    {
+      if (rho(j,k) < rhoTol)
+      {
+        continue;
+      }
+      for (int i=0;i<Nact;i++)
+      {
+        for (int l=0;l<Nact;l++)
+        {
+          if ((i == j) || (i == k) || (l == j) || (l == k) || (i == l))
+          {
+            continue;
+          }
+          //Screened force constant
+          double kIJKL = kTors*rho(i,j)*rho(j,k)*rho(k,l);
+          if (kIJKL < (kTors*rhoTol))
+          {
+            continue;
+          }
+          Vector3d F = pos[i]-pos[j]; //Outer bond
+          Vector3d G = pos[j]-pos[k]; //Central bond
+          Vector3d H = pos[l]-pos[k]; //Outer bond
+          Vector3d A = F.cross(G); //Normal of the first plane
+          Vector3d B = H.cross(G); //Normal of the second plane
+          double A2 = A.squaredNorm();
+          double B2 = B.squaredNorm();
+          double GLen = G.norm();
+          if ((A2 < 1e-6) || (B2 < 1e-6))
+          {
+            //Skip torsions with linear bends
+            continue;
+          }
+          double FG = F.dot(G)/(A2*GLen); //Projection for the first plane
+          double HG = H.dot(G)/(B2*GLen); //Projection for the second plane
+          vector<Vector3d> bVec(4); //Wilson B-matrix row
+          bVec[0] = -1*(GLen/A2)*A;
+          bVec[3] = (GLen/B2)*B;
+          bVec[1] = (GLen/A2+FG)*A-HG*B;
+          bVec[2] = -1*(bVec[0]+bVec[1]+bVec[3]);
+          int ids[4] = {i,j,k,l}; //Atoms in the torsion
+          for (int a=0;a<4;a++)
+          {
+            for (int b=0;b<4;b++)
+            {
+              QMMMHess.block(3*ids[a],3*ids[b],3,3) +=
+                   kIJKL*bVec[a]*bVec[b].transpose();
+            }
+          }
+        }
+      }
+    }
+  }
+  //Return Hessian
+  return QMMMHess;
+};
+
 //! \brief Prints trajectory files for animating the normal modes.
 //! \param QMMMData - Simulation trajectory data
 //! \param imagOnly - Flag to print only the imaginary frequencies
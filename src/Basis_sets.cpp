@@ -21,31 +21,150 @@
 */
 //! \{
 
-//Basis set definitions
+//Basis set library definitions
 
-//! \brief Generates Hermite basis functions for an atom in the system.
-//! \param Typ - Element or atom type name
-//! \param basName - Name of the basis set
-//! \return newBasis - Array of basis functions for the atom
-//! \todo Finish this function and write atom type definitions
-vector<HermGau> HermBasis(string Typ, string basName)
+//! \brief Creates an empty Hermite basis set library.
+HermBasisLib::HermBasisLib()
+{
+  //Generic constructor
+  return;
+};
+
+//! \brief Generic destructor for the Hermite basis set library.
+HermBasisLib::~HermBasisLib()
 {
-  //Function to set specific Hermite basis sets
-  bool badBasis = 0; //Flag to exit if no basis set is found
-  vector<HermGau> newBasis;
-  //NB: Organized by basis name, then element
-  
-  //Check for errors
-  if (badBasis)
+  //Generic destructor
+  return;
+};
+
+//! \brief Reads a Hermite basis set file into the library.
+//! \param basName - Name of the basis set (file: basName.herm)
+//! \note File format: element symbol and number of functions, followed by
+//! one line per function with the coefficient, exponent, and x/y/z powers.
+//! Lines starting with # or ! are comments.
+void HermBasisLib::loadBasis_(string basName)
+{
+  //Function to read a basis set database file
+  fstream basFile; //Basis set file
+  string dummy; //Generic string
+  string fileName = basName+".herm"; //Name of the database file
+  vector<vector<HermGau> > newBasis; //Basis functions for each element
+  //Check if the file exists
+  if (!CheckFile(fileName))
   {
-    cerr << "Error: Basis set " << basName;
-    cerr << " is not defined for atom " << Typ;
-    cerr << "!!!" << '\n' << '\n';
+    cerr << "Error: Could not find the basis set file ";
+    cerr << fileName << "!!!" << '\n' << '\n';
     cerr.flush();
     exit(0);
   }
-  //Return basis set if it was found in the database
-  return newBasis;
+  //Read the functions for each element
+  basFile.open(fileName.c_str(),ios_base::in);
+  while (basFile.good() && (!basFile.eof()))
+  {
+    dummy = "";
+    basFile >> dummy;
+    if (dummy == "")
+    {
+      //End of the file
+    }
+    else if ((dummy[0] == '#') || (dummy[0] == '!'))
+    {
+      //Skip comment
+      getline(basFile,dummy);
+    }
+    else
+    {
+      //Read an element
+      int Z = chemTable.revTyping(dummy); //Element ID
+      int Nfuncs = 0; //Number of basis functions
+      basFile >> Nfuncs;
+      if (Z == 0)
+      {
+        cerr << "Error: Unknown element " << dummy;
+        cerr << " in basis set file " << fileName;
+        cerr << "!!!" << '\n' << '\n';
+        cerr.flush();
+        exit(0);
+      }
+      if (Z >= (int)newBasis.size())
+      {
+        newBasis.resize(Z+1);
+      }
+      for (int i=0;i<Nfuncs;i++)
+      {
+        //Functions are centered on the atom
+        double ci,ai; //Coefficient and exponent
+        int ix,iy,iz; //Hermite powers
+        basFile >> ci >> ai >> ix >> iy >> iz;
+        HermGau tmp(ci,ai,ix,iy,iz,0.0,0.0,0.0);
+        newBasis[Z].push_back(tmp);
+      }
+    }
+  }
+  basFile.close();
+  //Save the basis set
+  basNames_.push_back(basName);
+  basData_.push_back(newBasis);
+  return;
+};
+
+//! \brief Finds a basis set in the library and loads it if needed.
+//! \param basName - Name of the basis set
+//! \return basID - Index of the basis set in the library
+int HermBasisLib::basisID(string basName)
+{
+  //Function to find the ID of a basis set
+  for (unsigned int i=0;i<basNames_.size();i++)
+  {
+    if (basName == basNames_[i])
+    {
+      //The basis set is already in memory
+      return i;
+    }
+  }
+  //Read the basis set from the database
+  loadBasis_(basName);
+  return (basNames_.size()-1);
+};
+
+//! \brief Checks if an element is defined in a basis set.
+//! \param basID - Index of the basis set in the library
+//! \param Z - Element ID (atomic number)
+//! \return found - Flag stating if the element has basis functions
+bool HermBasisLib::defined(int basID, int Z)
+{
+  //Function to check for missing basis functions
+  if ((basID < 0) || (basID >= (int)basData_.size()))
+  {
+    //Basis set was not loaded
+    return 0;
+  }
+  if ((Z <= 0) || (Z >= (int)basData_[basID].size()))
+  {
+    //Element is not in the basis set
+    return 0;
+  }
+  if (basData_[basID][Z].size() == 0)
+  {
+    //Element has no functions
+    return 0;
+  }
+  return 1;
+};
+
+//! \brief Returns the basis functions shared by all atoms of an element.
+//! \param basID - Index of the basis set in the library
+//! \param Z - Element ID (atomic number)
+//! \return basis - Atom-centered Hermite Gaussians (read-only)
+const vector<HermGau>& HermBasisLib::getBasis(int basID, int Z)
+{
+  //Function to look up the basis functions for an element
+  if (!defined(basID,Z))
+  {
+    //Return an empty basis
+    return noBasis_;
+  }
+  return basData_[basID][Z];
 };
 
 //End of file group
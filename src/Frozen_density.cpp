@@ -28,7 +28,14 @@ double GEMC6(double C6, Coord& POSi, Coord& POSj, double Rcut)
 {
   //Function to calculate the LJ style dispersion
   double Eij = 0; //Dispersion energy
-  
+  Coord dist = CoordDist2(POSi,POSj); //Displacement between the atoms
+  double R2 = dist.vecMag(); //Squared distance
+  //Check if the atoms are within the cutoff
+  if (R2 <= (Rcut*Rcut))
+  {
+    //Attractive r^-6 term
+    Eij = -1*C6/(R2*R2*R2);
+  }
   //Return energy
   return Eij;
 };
@@ -38,10 +45,450 @@ double GEMBuffC7(double C7, double Rmin, Coord& POSi, Coord& POSj,
 {
   //Function to calculate buffered 14-7 style dispersion
   double Eij = 0; //Dispersion energy
-  
+  Coord dist = CoordDist2(POSi,POSj); //Displacement between the atoms
+  double R2 = dist.vecMag(); //Squared distance
+  //Check if the atoms are within the cutoff
+  if (R2 <= (Rcut*Rcut))
+  {
+    //Halgren buffered 14-7 potential
+    double rho = sqrt(R2)/Rmin; //Reduced distance
+    double rho7 = pow(rho,7); //Reduced distance to the seventh power
+    Eij = C7*pow(1.07/(rho+0.07),7);
+    Eij *= (1.12/(rho7+0.12))-2;
+  }
   //Return energy
   return Eij;
 };
 
+vector<HermGau> GEMAtomDensity(vector<QMMMAtom>& QMMMData, int i,
+                               int bead)
+{
+  //Function to place the density of an atom in its local frame
+  Vector3d vecX,vecY,vecZ; //Local frame vectors
+  FindTINKFrame(QMMMData,i,bead,vecX,vecY,vecZ);
+  return QMMMData[i].GEM[0].placeDensity(QMMMData[i].P[bead],vecX,vecY,
+                                         vecZ);
+};
+
+bool GEMPairActive(vector<QMMMAtom>& QMMMData, int i, int j)
+{
+  //Function to check if a pair of atoms needs GEM interactions
+  bool pairOn = 1; //Include the pair
+  bool QMi = (QMMMData[i].QMRegion || QMMMData[i].PBRegion); //QM side
+  bool QMj = (QMMMData[j].QMRegion || QMMMData[j].PBRegion); //QM side
+  //The QM wrappers handle all QM-QM interactions and TINKER handles all
+  //MM-MM interactions, so only QM-MM pairs are included
+  if (QMi == QMj)
+  {
+    pairOn = 0;
+  }
+  //At least one of the atoms needs a density
+  if ((QMMMData[i].GEM.size() == 0) && (QMMMData[j].GEM.size() == 0))
+  {
+    pairOn = 0;
+  }
+  return pairOn;
+};
+
+double GEMPairCoulomb(vector<HermGau>& densI, vector<double>& boundI,
+                      double qI, Coord& posI, vector<HermGau>& densJ,
+                      vector<double>& boundJ, double qJ, Coord& posJ)
+{
+  //Function to calculate the electrostatic energy of one pair of atoms
+  double Eij = 0; //Pair energy
+  //Point-charge interactions
+  Coord dist = CoordDist2(posI,posJ);
+  Eij += coul2eV*qI*qJ/sqrt(dist.vecMag());
+  //Density-charge interactions
+  for (unsigned int k=0;k<densI.size();k++)
+  {
+    Eij += HermCoul1e(densI[k],qJ,posJ);
+  }
+  for (unsigned int l=0;l<densJ.size();l++)
+  {
+    Eij += HermCoul1e(densJ[l],qI,posI);
+  }
+  //Density-density interactions
+  for (unsigned int k=0;k<densI.size();k++)
+  {
+    for (unsigned int l=0;l<densJ.size();l++)
+    {
+      //Skip pairs which cannot contribute
+      if ((boundI[k]*boundJ[l]) >= GEMScreen)
+      {
+        Eij += HermCoul2e(densI[k],densJ[l]);
+      }
+    }
+  }
+  //Return energy
+  return Eij;
+};
+
+double GEMPairOverlap(vector<HermGau>& densI, vector<HermGau>& densJ,
+                      Coord& posI, Coord& posJ)
+{
+  //Function to calculate the density overlap of one pair of atoms
+  double Sij = 0; //Pair overlap
+  Coord dist = CoordDist2(posI,posJ);
+  double R2 = dist.vecMag()/(bohrRad*bohrRad); //Squared distance (a.u.)
+  for (unsigned int k=0;k<densI.size();k++)
+  {
+    for (unsigned int l=0;l<densJ.size();l++)
+    {
+      //Estimate the overlap from the Gaussian envelope
+      double ai = densI[k].getAlpha(); //Width of the first Gaussian
+      double aj = densJ[l].getAlpha(); //Width of the second Gaussian
+      double Sest; //Estimated overlap
+      Sest = abs(densI[k].coeff()*densJ[l].coeff());
+      Sest *= pow(pi/(ai+aj),1.5);
+      Sest *= exp(-1*ai*aj*R2/(ai+aj));
+      //Skip pairs which cannot contribute
+      if (Sest >= GEMScreen)
+      {
+        Sij += HermOverlap(densI[k],densJ[l]);
+      }
+    }
+  }
+  //Return overlap
+  return Sij;
+};
+
+vector<HermGau> GEMDensDeriv(vector<HermGau>& dens, int k)
+{
+  //Function to differentiate densities with respect to their center
+  //NB: Raising the Hermite order along k gives the derivative (a.u.)
+  vector<HermGau> dDens; //Derivatives of the Hermite Gaussians
+  int dx = (k == 0); //Change in the x order
+  int dy = (k == 1); //Change in the y order
+  int dz = (k == 2); //Change in the z order
+  for (unsigned int l=0;l<dens.size();l++)
+  {
+    HermGau dG(dens[l].coeff(),dens[l].getAlpha(),dens[l].xPow()+dx,
+               dens[l].yPow()+dy,dens[l].zPow()+dz,dens[l].xPos(),
+               dens[l].yPos(),dens[l].zPos());
+    dDens.push_back(dG);
+  }
+  return dDens;
+};
+
+Coord GEMPairForce(vector<HermGau>& densI, vector<double>& boundI,
+                   double qI, Coord& posI, vector<HermGau>& densJ,
+                   vector<double>& boundJ, double qJ, Coord& posJ,
+                   double exch)
+{
+  //Function to calculate the analytic force on the first atom of a pair
+  //NB: The force on the second atom has the opposite sign
+  Coord Fij; //Force on the first atom
+  Coord dist = CoordDist2(posI,posJ);
+  double R2 = dist.vecMag(); //Squared distance
+  double R = sqrt(R2); //Distance
+  double Rb2 = R2/(bohrRad*bohrRad); //Squared distance (a.u.)
+  //Point-charge interactions
+  double fScale = coul2eV*qI*qJ/(R2*R);
+  Fij.x = fScale*dist.x;
+  Fij.y = fScale*dist.y;
+  Fij.z = fScale*dist.z;
+  for (int k=0;k<3;k++)
+  {
+    double dE = 0; //Gradient along k (a.u. of distance)
+    vector<HermGau> dDensI = GEMDensDeriv(densI,k);
+    vector<HermGau> dDensJ = GEMDensDeriv(densJ,k);
+    //Density-charge interactions
+    for (unsigned int l=0;l<densI.size();l++)
+    {
+      dE += HermCoul1e(dDensI[l],qJ,posJ);
+    }
+    for (unsigned int l=0;l<densJ.size();l++)
+    {
+      //Moving the charge is the reverse of moving the density
+      dE -= HermCoul1e(dDensJ[l],qI,posI);
+    }
+    //Density-density interactions
+    for (unsigned int l=0;l<densI.size();l++)
+    {
+      for (unsigned int m=0;m<densJ.size();m++)
+      {
+        //Use the same screening as the energy
+        if ((boundI[l]*boundJ[m]) >= GEMScreen)
+        {
+          dE += HermCoul2e(dDensI[l],densJ[m]);
+        }
+        if (exch != 0)
+        {
+          //Estimate the overlap from the Gaussian envelope
+          double ai = densI[l].getAlpha(); //Width of the first Gaussian
+          double aj = densJ[m].getAlpha(); //Width of the second Gaussian
+          double Sest; //Estimated overlap
+          Sest = abs(densI[l].coeff()*densJ[m].coeff());
+          Sest *= pow(pi/(ai+aj),1.5);
+          Sest *= exp(-1*ai*aj*Rb2/(ai+aj));
+          if (Sest >= GEMScreen)
+          {
+            dE += exch*HermOverlap(dDensI[l],densJ[m]);
+          }
+        }
+      }
+    }
+    //Change from the gradient (a.u.) to the force (Ang)
+    dE /= -1*bohrRad;
+    if (k == 0)
+    {
+      Fij.x += dE;
+    }
+    if (k == 1)
+    {
+      Fij.y += dE;
+    }
+    if (k == 2)
+    {
+      Fij.z += dE;
+    }
+  }
+  //Return force
+  return Fij;
+};
+
+void GEMSetup(vector<QMMMAtom>& QMMMData, vector<vector<HermGau> >& atDens,
+              vector<vector<double> >& atBound, vector<double>& atCharge,
+              int bead)
+{
+  //Function to place the densities and calculate the screening bounds
+  atDens.clear();
+  atBound.clear();
+  atCharge.clear();
+  atDens.resize(Natoms);
+  atBound.resize(Natoms);
+  atCharge.resize(Natoms);
+  #pragma omp parallel for schedule(dynamic)
+  for (int i=0;i<Natoms;i++)
+  {
+    if (QMMMData[i].GEM.size() > 0)
+    {
+      //Atoms with densities contribute their nuclear charge
+      atDens[i] = GEMAtomDensity(QMMMData,i,bead);
+      atCharge[i] = chemTable.revTyping(QMMMData[i].QMTyp);
+      for (unsigned int k=0;k<atDens[i].size();k++)
+      {
+        //Self-interaction gives the Schwarz bound
+        double selfInt; //Temporary storage
+        selfInt = HermCoul2e(atDens[i][k],atDens[i][k]);
+        atBound[i].push_back(sqrt(abs(selfInt)));
+      }
+    }
+    else
+    {
+      //Other atoms only contribute a point-charge
+      atCharge[i] = QMMMData[i].MP[bead].q;
+    }
+  }
+  return;
+};
+
 //Functions to calculate GEM energy
+double GEMCoulomb(vector<QMMMAtom>& QMMMData, int bead)
+{
+  //Function to calculate GEM-GEM and GEM-charge electrostatic energies
+  double E = 0; //Electrostatic energy
+  vector<vector<HermGau> > atDens; //Densities centered on the atoms
+  vector<vector<double> > atBound; //Schwarz bounds for each Hermite
+  vector<double> atCharge; //Nuclear or MM point-charges
+  GEMSetup(QMMMData,atDens,atBound,atCharge,bead);
+  //Create the list of interacting pairs
+  vector<int> pairI; //First atom in each pair
+  vector<int> pairJ; //Second atom in each pair
+  for (int i=0;i<Natoms;i++)
+  {
+    for (int j=(i+1);j<Natoms;j++)
+    {
+      if (GEMPairActive(QMMMData,i,j))
+      {
+        pairI.push_back(i);
+        pairJ.push_back(j);
+      }
+    }
+  }
+  int Npairs = (int)pairI.size(); //Number of interacting pairs
+  //Calculate the energy in parallel over the atom pairs
+  #pragma omp parallel for schedule(dynamic) reduction(+:E)
+  for (int p=0;p<Npairs;p++)
+  {
+    int i = pairI[p]; //First atom
+    int j = pairJ[p]; //Second atom
+    E += GEMPairCoulomb(atDens[i],atBound[i],atCharge[i],
+                        QMMMData[i].P[bead],atDens[j],atBound[j],
+                        atCharge[j],QMMMData[j].P[bead]);
+  }
+  //Return energy
+  return E;
+};
+
+double GEMOverlap(vector<QMMMAtom>& QMMMData, int bead)
+{
+  //Function to calculate the GEM-GEM density overlap
+  double Sij = 0; //Total overlap
+  vector<vector<HermGau> > atDens; //Densities centered on the atoms
+  atDens.resize(Natoms);
+  //Place densities
+  #pragma omp parallel for schedule(dynamic)
+  for (int i=0;i<Natoms;i++)
+  {
+    if (QMMMData[i].GEM.size() > 0)
+    {
+      atDens[i] = GEMAtomDensity(QMMMData,i,bead);
+    }
+  }
+  //Create the list of overlapping pairs
+  vector<int> pairI; //First atom in each pair
+  vector<int> pairJ; //Second atom in each pair
+  for (int i=0;i<Natoms;i++)
+  {
+    for (int j=(i+1);j<Natoms;j++)
+    {
+      //Both atoms need a density
+      if ((atDens[i].size() > 0) && (atDens[j].size() > 0) &&
+         GEMPairActive(QMMMData,i,j))
+      {
+        Coord dist = CoordDist2(QMMMData[i].P[bead],QMMMData[j].P[bead]);
+        if (dist.vecMag() <= (GEMCut*GEMCut))
+        {
+          pairI.push_back(i);
+          pairJ.push_back(j);
+        }
+      }
+    }
+  }
+  int Npairs = (int)pairI.size(); //Number of overlapping pairs
+  //Calculate the overlap in parallel over the atom pairs
+  #pragma omp parallel for schedule(dynamic) reduction(+:Sij)
+  for (int p=0;p<Npairs;p++)
+  {
+    int i = pairI[p]; //First atom
+    int j = pairJ[p]; //Second atom
+    Sij += GEMPairOverlap(atDens[i],atDens[j],QMMMData[i].P[bead],
+                          QMMMData[j].P[bead]);
+  }
+  //Return overlap
+  return Sij;
+};
 
+double GEMEnergy(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts,
+                 int bead)
+{
+  //Function to calculate the frozen density interaction energy
+  double E = 0; //GEM energy
+  E += GEMCoulomb(QMMMData,bead);
+  if (QMMMOpts.GEMExch != 0)
+  {
+    //Exchange-repulsion is proportional to the density overlap
+    E += QMMMOpts.GEMExch*GEMOverlap(QMMMData,bead);
+  }
+  //Return energy
+  return E;
+};
+
+double GEMForces(vector<QMMMAtom>& QMMMData, VectorXd& forces,
+                 QMMMSettings& QMMMOpts, int bead, bool MMForces)
+{
+  //Function to calculate the frozen density forces
+  //NB: Forces are added to the MM and BA atoms (indexed by atom) when
+  //MMForces is true, otherwise to the QM and PB atoms (indexed in order)
+  //NB: The forces from rotating the local frames of the densities are
+  //not included
+  double E = 0; //GEM energy
+  vector<vector<HermGau> > atDens; //Densities centered on the atoms
+  vector<vector<double> > atBound; //Schwarz bounds for each Hermite
+  vector<double> atCharge; //Nuclear or MM point-charges
+  vector<int> forceID; //Location of each atom in the force array
+  GEMSetup(QMMMData,atDens,atBound,atCharge,bead);
+  int ct = 0; //Counter for QM and PB atoms
+  for (int i=0;i<Natoms;i++)
+  {
+    forceID.push_back(-1);
+    if (MMForces && (QMMMData[i].MMRegion || QMMMData[i].BARegion) &&
+       (!QMMMData[i].frozen))
+    {
+      forceID[i] = i;
+    }
+    if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+    {
+      if (!MMForces)
+      {
+        forceID[i] = ct;
+      }
+      ct += 1;
+    }
+  }
+  //Create the list of interacting pairs
+  vector<int> pairI; //First atom in each pair
+  vector<int> pairJ; //Second atom in each pair
+  for (int i=0;i<Natoms;i++)
+  {
+    for (int j=(i+1);j<Natoms;j++)
+    {
+      if (GEMPairActive(QMMMData,i,j))
+      {
+        pairI.push_back(i);
+        pairJ.push_back(j);
+      }
+    }
+  }
+  int Npairs = (int)pairI.size(); //Number of interacting pairs
+  //Pair energies only depend on the displacement, so the forces on both
+  //atoms come from the analytic gradient with respect to the first atom
+  vector<Coord> pairForce; //Force on the first atom of each pair
+  pairForce.resize(Npairs);
+  #pragma omp parallel for schedule(dynamic) reduction(+:E)
+  for (int p=0;p<Npairs;p++)
+  {
+    int i = pairI[p]; //First atom
+    int j = pairJ[p]; //Second atom
+    Coord& posI = QMMMData[i].P[bead]; //Position of the first atom
+    Coord& posJ = QMMMData[j].P[bead]; //Position of the second atom
+    double exch = 0; //Exchange-repulsion scale factor
+    if ((QMMMOpts.GEMExch != 0) && (atDens[i].size() > 0) &&
+       (atDens[j].size() > 0))
+    {
+      Coord dist = CoordDist2(posI,posJ);
+      if (dist.vecMag() <= (GEMCut*GEMCut))
+      {
+        exch = QMMMOpts.GEMExch;
+      }
+    }
+    //Energy at the current position
+    E += GEMPairCoulomb(atDens[i],atBound[i],atCharge[i],posI,atDens[j],
+                        atBound[j],atCharge[j],posJ);
+    if (exch != 0)
+    {
+      E += exch*GEMPairOverlap(atDens[i],atDens[j],posI,posJ);
+    }
+    pairForce[p].x = 0;
+    pairForce[p].y = 0;
+    pairForce[p].z = 0;
+    if ((forceID[i] >= 0) || (forceID[j] >= 0))
+    {
+      pairForce[p] = GEMPairForce(atDens[i],atBound[i],atCharge[i],posI,
+                                  atDens[j],atBound[j],atCharge[j],posJ,
+                                  exch);
+    }
+  }
+  //Add the pair forces to the atoms
+  for (int p=0;p<Npairs;p++)
+  {
+    int i = pairI[p]; //First atom
+    int j = pairJ[p]; //Second atom
+    if (forceID[i] >= 0)
+    {
+      forces(3*forceID[i]) += pairForce[p].x;
+      forces(3*forceID[i]+1) += pairForce[p].y;
+      forces(3*forceID[i]+2) += pairForce[p].z;
+    }
+    if (forceID[j] >= 0)
+    {
+      forces(3*forceID[j]) -= pairForce[p].x;
+      forces(3*forceID[j]+1) -= pairForce[p].y;
+      forces(3*forceID[j]+2) -= pairForce[p].z;
+    }
+  }
+  //Return energy
+  return E;
+};
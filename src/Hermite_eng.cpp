@@ -44,49 +44,49 @@ HermGau::~HermGau()
   return;
 };
 
-double HermGau::coeff()
+double HermGau::coeff() const
 {
   //Return the coefficient
   return mag_;
 };
 
-double HermGau::xPos()
+double HermGau::xPos() const
 {
   //Return the x position
   return x_;
 };
 
-double HermGau::yPos()
+double HermGau::yPos() const
 {
   //Return the y position
   return y_;
 };
 
-double HermGau::zPos()
+double HermGau::zPos() const
 {
   //Return the z position
   return z_;
 };
 
-double HermGau::getAlpha()
+double HermGau::getAlpha() const
 {
   //Return the Gaussian coefficient (width)
   return alpha_;
 };
 
-int HermGau::xPow()
+int HermGau::xPow() const
 {
   //Return the Hermite power in the x direction
   return powX_;
 };
 
-int HermGau::yPow()
+int HermGau::yPow() const
 {
   //Return the Hermite power in the y direction
   return powY_;
 };
 
-int HermGau::zPow()
+int HermGau::zPow() const
 {
   //Return the Hermite power in the z direction
   return powZ_;
@@ -161,6 +161,19 @@ double BoysFunc(int n, double x)
 {
   //Recursive Boys function
   double val = 0.0;
+  if (x < 0.5)
+  {
+    //Taylor series avoids the unstable recursion near x = 0
+    double term = 1.0; //Current term without the denominator
+    int k = 0; //Order of the term
+    while ((abs(term) > 1e-16) || (k == 0))
+    {
+      val += term/(2*n+2*k+1);
+      k += 1;
+      term *= -1*x/k;
+    }
+    return val;
+  }
   if (n == 0)
   {
     //Zero order Boys function
@@ -174,15 +187,11 @@ double BoysFunc(int n, double x)
 
 double HermCoul2e(HermGau& Gi, HermGau& Gj)
 {
-  //Recursive two electron Coulomb integral
+  //Two electron Coulomb integral (McMurchie-Davidson)
   double Eij = 0; //Energy
-  //Combine Gaussians with the Gaussian product rule
-  double aNew = Gi.getAlpha()+Gj.getAlpha(); //New Gaussian coefficient
-  int powX = Gi.xPow()+Gj.xPow(); //New X power
-  int powY = Gi.yPow()+Gj.yPow(); //New Y power
-  int powZ = Gi.zPow()+Gj.zPow(); //New Z power
-  //Update magnitude based on the separation
-  double mu = Gi.getAlpha()*Gj.getAlpha()/aNew; //Smearing parameter
+  double ai = Gi.getAlpha(); //Exponent of the first Gaussian
+  double aj = Gj.getAlpha(); //Exponent of the second Gaussian
+  double mu = ai*aj/(ai+aj); //Reduced exponent
   Coord posi,posj; //Temporary storage for positions
   posi.x = Gi.xPos();
   posi.y = Gi.yPos();
@@ -194,225 +203,13 @@ double HermCoul2e(HermGau& Gi, HermGau& Gj)
   double Xij = disp.x/bohrRad; //X distance (a.u.)
   double Yij = disp.y/bohrRad; //Y distance (a.u.)
   double Zij = disp.z/bohrRad; //Z distance (a.u.)
-  double Rij2 = Xij*Xij+Yij*Yij+Zij*Zij; //Distance between Gaussians (a.u.)
-  double newMag = Gi.coeff()*Gj.coeff(); //Product of old coefficients
-  newMag *= exp(-mu*Rij2); //Scale based on distance
-  //Create product Gaussian
-  HermGau Gij(newMag,aNew,powX,powY,powZ,Xij,Yij,Zij);
-  //Calculate integrals
-  double Ix = 0; //Integral in the x direction
-  if (Gij.xPow() > 0)
-  {
-    //Aspherical Hermite Gaussians
-    vector<double> hermMags; //Magnitude of the Gaussians
-    vector<int> hermOrders; //Order of the Hermite function
-    vector<int> boysOrders; //Order of the Boys function
-    hermMags.push_back(1.0);
-    hermOrders.push_back(Gij.xPow());
-    boysOrders.push_back(0);
-    //Recursion
-    bool contRecurs = 1; //Keeps the while loop going
-    while (contRecurs)
-    {
-      //Stop recursion unless orders are greater than zero
-      contRecurs = 0;
-      //Create temporary arrays
-      vector<double> newMags; //New Gaussian magnitudes
-      vector<int> newOrders; //New Hermite orders
-      vector<int> newBoys; //New Boys function orders
-      //Loop over Hermite functions
-      for (unsigned int i=0;i<hermOrders.size();i++)
-      {
-        //Create new Hermites
-        if (hermOrders[i] > 0)
-        {
-          contRecurs = 1; //Continue recursion
-          double coeffi; //Temp. coefficient storage
-          //First Hermite
-          coeffi = hermOrders[i]-2;
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-2) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-2);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-          //Second Hermite
-          coeffi = Gij.xPos();
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-1) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-1);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-        }
-      }
-      //Save new magnitudes and orders
-      hermMags = newMags;
-      hermOrders = newOrders;
-      boysOrders = newBoys;
-    }
-    //Calculate X integral
-    for (unsigned int i=0;i<boysOrders.size();i++)
-    {
-      double Itmp; //Temp. storage for integrals
-      Itmp = pow((-1*Gij.getAlpha()),boysOrders[i]);
-      Itmp *= BoysFunc(boysOrders[i],(Gij.getAlpha()*Rij2));
-      Ix += Itmp; //Update integral
-    }
-  }
-  else
-  {
-    //Spherical Hermite Gaussian
-    double Itmp; //Temp. storage for integrals
-    Itmp = pow((-1*Gij.getAlpha()),0);
-    Itmp *= BoysFunc(0,(Gij.getAlpha()*Rij2));
-    Ix += Itmp; //Update integral
-  }
-  double Iy = 0; //Integral in the y direction
-  if (Gij.yPow() > 0)
-  {
-    //Aspherical Hermite Gaussians
-    vector<double> hermMags; //Magnitude of the Gaussians
-    vector<int> hermOrders; //Order of the Hermite function
-    vector<int> boysOrders; //Order of the Boys function
-    hermMags.push_back(1.0);
-    hermOrders.push_back(Gij.yPow());
-    boysOrders.push_back(0);
-    //Recursion
-    bool contRecurs = 1; //Keeps the while loop going
-    while (contRecurs)
-    {
-      //Stop recursion unless orders are greater than zero
-      contRecurs = 0;
-      //Create temporary arrays
-      vector<double> newMags; //New Gaussian magnitudes
-      vector<int> newOrders; //New Hermite orders
-      vector<int> newBoys; //New Boys function orders
-      //Loop over Hermite functions
-      for (unsigned int i=0;i<hermOrders.size();i++)
-      {
-        //Create new Hermites
-        if (hermOrders[i] > 0)
-        {
-          contRecurs = 1; //Continue recursion
-          double coeffi; //Temp. coefficient storage
-          //First Hermite
-          coeffi = hermOrders[i]-2;
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-2) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-2);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-          //Second Hermite
-          coeffi = Gij.yPos();
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-1) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-1);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-        }
-      }
-      //Save new magnitudes and orders
-      hermMags = newMags;
-      hermOrders = newOrders;
-      boysOrders = newBoys;
-    }
-    //Calculate Y integral
-    for (unsigned int i=0;i<boysOrders.size();i++)
-    {
-      double Itmp; //Temp. storage for integrals
-      Itmp = pow((-1*Gij.getAlpha()),boysOrders[i]);
-      Itmp *= BoysFunc(boysOrders[i],(Gij.getAlpha()*Rij2));
-      Iy += Itmp; //Update integral
-    }
-  }
-  else
-  {
-    //Spherical Hermite Gaussian
-    double Itmp; //Temp. storage for integrals
-    Itmp = pow((-1*Gij.getAlpha()),0);
-    Itmp *= BoysFunc(0,(Gij.getAlpha()*Rij2));
-    Iy += Itmp; //Update integral
-  }
-  double Iz = 0; //Integral in the z direction
-  if (Gij.zPow() > 0)
-  {
-    //Aspherical Hermite Gaussians
-    vector<double> hermMags; //Magnitude of the Gaussians
-    vector<int> hermOrders; //Order of the Hermite function
-    vector<int> boysOrders; //Order of the Boys function
-    hermMags.push_back(1.0);
-    hermOrders.push_back(Gij.zPow());
-    boysOrders.push_back(0);
-    //Recursion
-    bool contRecurs = 1; //Keeps the while loop going
-    while (contRecurs)
-    {
-      //Stop recursion unless orders are greater than zero
-      contRecurs = 0;
-      //Create temporary arrays
-      vector<double> newMags; //New Gaussian magnitudes
-      vector<int> newOrders; //New Hermite orders
-      vector<int> newBoys; //New Boys function orders
-      //Loop over Hermite functions
-      for (unsigned int i=0;i<hermOrders.size();i++)
-      {
-        //Create new Hermites
-        if (hermOrders[i] > 0)
-        {
-          contRecurs = 1; //Continue recursion
-          double coeffi; //Temp. coefficient storage
-          //First Hermite
-          coeffi = hermOrders[i]-2;
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-2) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-2);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-          //Second Hermite
-          coeffi = Gij.zPos();
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-1) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-1);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-        }
-      }
-      //Save new magnitudes and orders
-      hermMags = newMags;
-      hermOrders = newOrders;
-      boysOrders = newBoys;
-    }
-    //Calculate Z integral
-    for (unsigned int i=0;i<boysOrders.size();i++)
-    {
-      double Itmp; //Temp. storage for integrals
-      Itmp = pow((-1*Gij.getAlpha()),boysOrders[i]);
-      Itmp *= BoysFunc(boysOrders[i],(Gij.getAlpha()*Rij2));
-      Iz += Itmp; //Update integral
-    }
-  }
-  else
-  {
-    //Spherical Hermite Gaussian
-    double Itmp; //Temp. storage for integrals
-    Itmp = pow((-1*Gij.getAlpha()),0);
-    Itmp *= BoysFunc(0,(Gij.getAlpha()*Rij2));
-    Iz += Itmp; //Update integral
-  }
-  //Combine integrals
-  Eij = Ix*Iy*Iz; //Combine the integrals
-  Eij *= Gij.coeff(); //Scale by magnitude
+  //Hermite Coulomb integral of the combined orders
+  Eij = HermRInt(0,Gi.xPow()+Gj.xPow(),Gi.yPow()+Gj.yPow(),
+                 Gi.zPow()+Gj.zPow(),mu,Xij,Yij,Zij);
+  //Derivatives with respect to the second center change the sign
+  Eij *= pow(-1.0,Gj.xPow()+Gj.yPow()+Gj.zPow());
+  Eij *= 2*pow(pi,2.5)/(ai*aj*sqrt(ai+aj));
+  Eij *= Gi.coeff()*Gj.coeff(); //Scale by magnitude
   //Change units and return
   Eij *= har2eV;
   return Eij;
@@ -420,14 +217,9 @@ double HermCoul2e(HermGau& Gi, HermGau& Gj)
 
 double HermCoul1e(HermGau& Gi, double qj, Coord& Posj)
 {
-  //Recursive one electron Coulomb integral
+  //One electron Coulomb integral with a point-charge (McMurchie-Davidson)
   double Eij = 0; //Energy
-  //Create a temporary Gaussian
-  double newMag = Gi.coeff(); //Magnitude
-  double aNew = Gi.getAlpha(); //Gaussian coefficient
-  int powX = Gi.xPow(); //X power
-  int powY = Gi.yPow(); //Y power
-  int powZ = Gi.zPow(); //Z power
+  double ai = Gi.getAlpha(); //Exponent of the Gaussian
   Coord posi; //Temporary storage for positions
   posi.x = Gi.xPos();
   posi.y = Gi.yPos();
@@ -436,222 +228,10 @@ double HermCoul1e(HermGau& Gi, double qj, Coord& Posj)
   double Xij = disp.x/bohrRad; //X distance (a.u.)
   double Yij = disp.y/bohrRad; //Y distance (a.u.)
   double Zij = disp.z/bohrRad; //Z distance (a.u.)
-  double Rij2 = Xij*Xij+Yij*Yij+Zij*Zij; //Distance between Gaussians (a.u.)
-  HermGau Gij(newMag,aNew,powX,powY,powZ,Xij,Yij,Zij);
-  //Calculate integrals
-  double Ix = 0; //Integral in the x direction
-  if (Gij.xPow() > 0)
-  {
-    //Aspherical Hermite Gaussians
-    vector<double> hermMags; //Magnitude of the Gaussians
-    vector<int> hermOrders; //Order of the Hermite function
-    vector<int> boysOrders; //Order of the Boys function
-    hermMags.push_back(1.0);
-    hermOrders.push_back(Gij.xPow());
-    boysOrders.push_back(0);
-    //Recursion
-    bool contRecurs = 1; //Keeps the while loop going
-    while (contRecurs)
-    {
-      //Stop recursion unless orders are greater than zero
-      contRecurs = 0;
-      //Create temporary arrays
-      vector<double> newMags; //New Gaussian magnitudes
-      vector<int> newOrders; //New Hermite orders
-      vector<int> newBoys; //New Boys function orders
-      //Loop over Hermite functions
-      for (unsigned int i=0;i<hermOrders.size();i++)
-      {
-        //Create new Hermites
-        if (hermOrders[i] > 0)
-        {
-          contRecurs = 1; //Continue recursion
-          double coeffi; //Temp. coefficient storage
-          //First Hermite
-          coeffi = hermOrders[i]-2;
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-2) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-2);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-          //Second Hermite
-          coeffi = Gij.xPos();
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-1) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-1);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-        }
-      }
-      //Save new magnitudes and orders
-      hermMags = newMags;
-      hermOrders = newOrders;
-      boysOrders = newBoys;
-    }
-    //Calculate X integral
-    for (unsigned int i=0;i<boysOrders.size();i++)
-    {
-      double Itmp; //Temp. storage for integrals
-      Itmp = pow((-1*Gij.getAlpha()),boysOrders[i]);
-      Itmp *= BoysFunc(boysOrders[i],(Gij.getAlpha()*Rij2));
-      Ix += Itmp; //Update integral
-    }
-  }
-  else
-  {
-    //Spherical Hermite Gaussian
-    double Itmp; //Temp. storage for integrals
-    Itmp = pow((-1*Gij.getAlpha()),0);
-    Itmp *= BoysFunc(0,(Gij.getAlpha()*Rij2));
-    Ix += Itmp; //Update integral
-  }
-  double Iy = 0; //Integral in the y direction
-  if (Gij.yPow() > 0)
-  {
-    //Aspherical Hermite Gaussians
-    vector<double> hermMags; //Magnitude of the Gaussians
-    vector<int> hermOrders; //Order of the Hermite function
-    vector<int> boysOrders; //Order of the Boys function
-    hermMags.push_back(1.0);
-    hermOrders.push_back(Gij.yPow());
-    boysOrders.push_back(0);
-    //Recursion
-    bool contRecurs = 1; //Keeps the while loop going
-    while (contRecurs)
-    {
-      //Stop recursion unless orders are greater than zero
-      contRecurs = 0;
-      //Create temporary arrays
-      vector<double> newMags; //New Gaussian magnitudes
-      vector<int> newOrders; //New Hermite orders
-      vector<int> newBoys; //New Boys function orders
-      //Loop over Hermite functions
-      for (unsigned int i=0;i<hermOrders.size();i++)
-      {
-        //Create new Hermites
-        if (hermOrders[i] > 0)
-        {
-          contRecurs = 1; //Continue recursion
-          double coeffi; //Temp. coefficient storage
-          //First Hermite
-          coeffi = hermOrders[i]-2;
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-2) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-2);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-          //Second Hermite
-          coeffi = Gij.yPos();
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-1) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-1);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-        }
-      }
-      //Save new magnitudes and orders
-      hermMags = newMags;
-      hermOrders = newOrders;
-      boysOrders = newBoys;
-    }
-    //Calculate Y integral
-    for (unsigned int i=0;i<boysOrders.size();i++)
-    {
-      double Itmp; //Temp. storage for integrals
-      Itmp = pow((-1*Gij.getAlpha()),boysOrders[i]);
-      Itmp *= BoysFunc(boysOrders[i],(Gij.getAlpha()*Rij2));
-      Iy += Itmp; //Update integral
-    }
-  }
-  else
-  {
-    //Spherical Hermite Gaussian
-    double Itmp; //Temp. storage for integrals
-    Itmp = pow((-1*Gij.getAlpha()),0);
-    Itmp *= BoysFunc(0,(Gij.getAlpha()*Rij2));
-    Iy += Itmp; //Update integral
-  }
-  double Iz = 0; //Integral in the z direction
-  if (Gij.zPow() > 0)
-  {
-    //Aspherical Hermite Gaussians
-    vector<double> hermMags; //Magnitude of the Gaussians
-    vector<int> hermOrders; //Order of the Hermite function
-    vector<int> boysOrders; //Order of the Boys function
-    hermMags.push_back(1.0);
-    hermOrders.push_back(Gij.zPow());
-    boysOrders.push_back(0);
-    //Recursion
-    bool contRecurs = 1; //Keeps the while loop going
-    while (contRecurs)
-    {
-      //Stop recursion unless orders are greater than zero
-      contRecurs = 0;
-      //Create temporary arrays
-      vector<double> newMags; //New Gaussian magnitudes
-      vector<int> newOrders; //New Hermite orders
-      vector<int> newBoys; //New Boys function orders
-      //Loop over Hermite functions
-      for (unsigned int i=0;i<hermOrders.size();i++)
-      {
-        //Create new Hermites
-        if (hermOrders[i] > 0)
-        {
-          contRecurs = 1; //Continue recursion
-          double coeffi; //Temp. coefficient storage
-          //First Hermite
-          coeffi = hermOrders[i]-2;
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-2) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-2);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-          //Second Hermite
-          coeffi = Gij.zPos();
-          coeffi *= hermMags[i];
-          if ((hermOrders[i]-1) >= 0)
-          {
-            newMags.push_back(coeffi);
-            newOrders.push_back(hermOrders[i]-1);
-            newBoys.push_back(boysOrders[i]+1);
-          }
-        }
-      }
-      //Save new magnitudes and orders
-      hermMags = newMags;
-      hermOrders = newOrders;
-      boysOrders = newBoys;
-    }
-    //Calculate Z integral
-    for (unsigned int i=0;i<boysOrders.size();i++)
-    {
-      double Itmp; //Temp. storage for integrals
-      Itmp = pow((-1*Gij.getAlpha()),boysOrders[i]);
-      Itmp *= BoysFunc(boysOrders[i],(Gij.getAlpha()*Rij2));
-      Iz += Itmp; //Update integral
-    }
-  }
-  else
-  {
-    //Spherical Hermite Gaussian
-    double Itmp; //Temp. storage for integrals
-    Itmp = pow((-1*Gij.getAlpha()),0);
-    Itmp *= BoysFunc(0,(Gij.getAlpha()*Rij2));
-    Iz += Itmp; //Update integral
-  }
-  //Combine integrals
-  Eij = Ix*Iy*Iz; //Combine the integrals
-  Eij *= Gij.coeff()*qj; //Scale by magnitude
+  //Hermite Coulomb integral
+  Eij = HermRInt(0,Gi.xPow(),Gi.yPow(),Gi.zPow(),ai,Xij,Yij,Zij);
+  Eij *= 2*pi/ai;
+  Eij *= Gi.coeff()*qj; //Scale by magnitude
   //Change units and return
   Eij *= har2eV;
   return Eij;
@@ -685,12 +265,77 @@ double HermOverlap(HermGau& Gi, HermGau& Gj)
   //Create product Gaussian
   HermGau Gij(newMag,aNew,powX,powY,powZ,Xij,Yij,Zij);
   //Calculate integral
-  
+  double sqrtMu = sqrt(mu); //Scale factor for the Hermite polynomials
+  Sij = pow(pi/aNew,1.5); //Overlap of two spherical Gaussians
+  //Derivatives of the product Gaussian in each direction
+  Sij *= pow(-1.0,Gj.xPow())*pow(-sqrtMu,Gij.xPow());
+  Sij *= HermPoly(Gij.xPow(),sqrtMu*Xij);
+  Sij *= pow(-1.0,Gj.yPow())*pow(-sqrtMu,Gij.yPow());
+  Sij *= HermPoly(Gij.yPow(),sqrtMu*Yij);
+  Sij *= pow(-1.0,Gj.zPow())*pow(-sqrtMu,Gij.zPow());
+  Sij *= HermPoly(Gij.zPow(),sqrtMu*Zij);
   Sij *= Gij.coeff(); //Scale by magnitude
   //Return overlap
   return Sij;
 };
 
+double HermPoly(int n, double x)
+{
+  //Iterative physicists' Hermite polynomial
+  double Hm = 1.0; //Polynomial of order k-1
+  double Hk = 2*x; //Polynomial of order k
+  if (n == 0)
+  {
+    //Zero order polynomial
+    return Hm;
+  }
+  //Upward recursion
+  for (int k=1;k<n;k++)
+  {
+    double Hp; //Polynomial of order k+1
+    Hp = (2*x*Hk)-(2*k*Hm);
+    Hm = Hk;
+    Hk = Hp;
+  }
+  return Hk;
+};
+
+double HermRInt(int n, int t, int u, int v, double a, double X, double Y,
+                double Z)
+{
+  //Recursive Hermite Coulomb integral R^n_tuv (McMurchie-Davidson)
+  double val = 0; //Integral
+  if ((t < 0) || (u < 0) || (v < 0))
+  {
+    //Negative orders do not contribute
+    return val;
+  }
+  if (t > 0)
+  {
+    //Lower the x order
+    val = (t-1)*HermRInt(n+1,t-2,u,v,a,X,Y,Z);
+    val += X*HermRInt(n+1,t-1,u,v,a,X,Y,Z);
+    return val;
+  }
+  if (u > 0)
+  {
+    //Lower the y order
+    val = (u-1)*HermRInt(n+1,t,u-2,v,a,X,Y,Z);
+    val += Y*HermRInt(n+1,t,u-1,v,a,X,Y,Z);
+    return val;
+  }
+  if (v > 0)
+  {
+    //Lower the z order
+    val = (v-1)*HermRInt(n+1,t,u,v-2,a,X,Y,Z);
+    val += Z*HermRInt(n+1,t,u,v-1,a,X,Y,Z);
+    return val;
+  }
+  //Spherical term from the Boys function
+  val = pow(-2*a,n)*BoysFunc(n,a*(X*X+Y*Y+Z*Z));
+  return val;
+};
+
 //End of file group
 ///@}
 
@@ -94,6 +94,11 @@ void ReadArgs(int& argc, char**& argv, fstream& xyzFile,
     //Separate a reaction path frame into a trajectory file
     SplitPathTraj(argc,argv);
   }
+  if (dummy == "-unittests")
+  {
+    //Run the unit tests for the numerical kernels
+    LICHEMUnitTests(argc,argv);
+  }
   if ((argc % 2) != 1)
   {
     //Check for help or missing arguments
@@ -250,6 +255,7 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
 {
   //Read input
   string dummy; //Generic string
+  vector<int> hessIDs; //Atoms listed for the finite-difference Hessians
   if (!GauExternal)
   {
     xyzFile >> Natoms;
@@ -265,6 +271,7 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
       //Set ID and regions
       tmp.id = i;
       tmp.NEBActive = 1;
+      tmp.HessActive = 1;
       tmp.QMRegion = 0;
       tmp.MMRegion = 1;
       tmp.PBRegion = 0;
@@ -370,19 +377,15 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
         //Optimize with the LICHEM steepest descent method
         SteepSim = 1;
       }
-      if ((dummy == "dfp") || (dummy == "bfgs"))
+      if (dummy == "dfp")
       {
         //Optimize with the DFP optimizer
         DFPSim = 1;
-        if (dummy == "bfgs")
-        {
-          //Print BFGS error
-          cerr << "Warning: A BFGS optimizer is not implemented.";
-          cerr << '\n';
-          cerr << " The DFP algorithm will be used instead of BFGS.";
-          cerr << '\n' << '\n';
-          cerr.flush(); //Print error immediately
-        }
+      }
+      if ((dummy == "bfgs") || (dummy == "lbfgs"))
+      {
+        //Optimize with the L-BFGS optimizer
+        BFGSSim = 1;
       }
       //Reaction pathways
       if ((dummy == "neb") || (dummy == "ci-neb") || (dummy == "cineb"))
@@ -390,6 +393,11 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
         //Optimize a path with climbing image NEB
         NEBSim = 1;
       }
+      if (dummy == "dimer")
+      {
+        //Search for a saddle point with the dimer method
+        DimerSim = 1;
+      }
       //Ensemble sampling
       if (dummy == "pimc")
       {
@@ -402,6 +410,11 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
         FBNEBSim = 1;
       }
     }
+    else if (keyword == "dimer_dist:")
+    {
+      //Read the distance from the dimer midpoint to its end
+      regionFile >> QMMMOpts.dimerDist;
+    }
     else if (keyword == "electrostatics:")
     {
       //Check the type of force field
@@ -454,6 +467,26 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
       //Read the number of equilibration steps
       regionFile >> QMMMOpts.NEq;
     }
+    else if (keyword == "fd_hessian:")
+    {
+      //Check for finite-difference Hessians
+      regionFile >> dummy;
+      LICHEMLowerText(dummy);
+      if ((dummy == "yes") || (dummy == "true"))
+      {
+        QMMMOpts.numHess = 1;
+      }
+    }
+    else if (keyword == "fd_step:")
+    {
+      //Read the finite-difference displacement
+      regionFile >> QMMMOpts.FDStep;
+    }
+    else if (keyword == "freq_modes:")
+    {
+      //Read the number of low frequency modes to calculate
+      regionFile >> QMMMOpts.NFreqModes;
+    }
     else if (keyword == "frozen_ends:")
     {
       //Check for inactive NEB end-points
@@ -464,6 +497,61 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
         QMMMOpts.frznEnds = 1;
       }
     }
+    else if (keyword == "gem_basis:")
+    {
+      //Read the Hermite basis set for the frozen densities
+      regionFile >> QMMMOpts.GEMBasis;
+    }
+    else if (keyword == "gem_density:")
+    {
+      //Check for frozen density interactions
+      regionFile >> dummy;
+      LICHEMLowerText(dummy);
+      if ((dummy == "yes") || (dummy == "true"))
+      {
+        QMMMOpts.useGEMDen = 1;
+      }
+    }
+    else if (keyword == "gem_exchange:")
+    {
+      //Read the exchange-repulsion scale for the density overlap
+      regionFile >> QMMMOpts.GEMExch;
+    }
+    else if (keyword == "hess_atoms:")
+    {
+      //Read the list of atoms to include in finite-difference Hessians
+      int numActive = 0;
+      regionFile >> numActive;
+      if (numActive < 1)
+      {
+        //At least one atom needs to be displaced
+        cout << "Error: Hess_atoms needs at least one atom." << '\n';
+        cout.flush();
+        exit(0);
+      }
+      //Only the listed atoms are displaced
+      for (int i=0;i<Natoms;i++)
+      {
+        QMMMData[i].HessActive = 0;
+      }
+      for (int i=0;i<numActive;i++)
+      {
+        //Change flag
+        int atomID;
+        regionFile >> atomID;
+        if ((atomID < 0) || (atomID >= Natoms))
+        {
+          //Quit before writing outside the atom list
+          cout << "Error: Hess_atoms contains an invalid atom number: ";
+          cout << atomID << " (valid atoms are 0 to " << (Natoms-1);
+          cout << ")." << '\n';
+          cout.flush();
+          exit(0);
+        }
+        QMMMData[atomID].HessActive = 1;
+        hessIDs.push_back(atomID);
+      }
+    }
     else if (keyword == "init_path_chk:")
     {
       //Check for inactive NEB end-points
@@ -474,6 +562,11 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
         QMMMOpts.startPathChk = 0;
       }
     }
+    else if (keyword == "lbfgs_memory:")
+    {
+      //Read the number of saved L-BFGS correction pairs
+      regionFile >> QMMMOpts.LBFGSMem;
+    }
     else if (keyword == "lrec_cut:")
     {
       //Read the QMMM electrostatic cutoff for LREC
@@ -494,11 +587,91 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
       //Read the maximum displacement during optimizations
       regionFile >> QMMMOpts.maxStep;
     }
+    else if (keyword == "mc_bead_weight:")
+    {
+      //Read the relative probability of bead moves
+      regionFile >> QMMMOpts.MCBeadWeight;
+    }
+    else if (keyword == "mc_centroid_weight:")
+    {
+      //Read the relative probability of centroid moves
+      regionFile >> QMMMOpts.MCCentWeight;
+    }
+    else if (keyword == "mc_force_weight:")
+    {
+      //Read the relative probability of force-bias moves
+      regionFile >> QMMMOpts.MCForceWeight;
+    }
+    else if (keyword == "mc_mode_weight:")
+    {
+      //Read the relative probability of normal mode moves
+      regionFile >> QMMMOpts.MCModeWeight;
+    }
+    else if (keyword == "mc_molecule_weight:")
+    {
+      //Read the relative probability of rigid molecule moves
+      regionFile >> QMMMOpts.MCMolWeight;
+    }
+    else if (keyword == "mc_reject_bound:")
+    {
+      //Read the largest potential energy drop for early rejection
+      regionFile >> QMMMOpts.MCRejectBound;
+    }
+    else if (keyword == "mc_screen_basis:")
+    {
+      //Set the basis set for the delayed acceptance screening
+      regionFile >> QMMMOpts.MCScreenBasis;
+    }
+    else if (keyword == "mc_screen_method:")
+    {
+      //Set the screening Hamiltonian for delayed acceptance
+      regionFile >> dummy;
+      QMMMOpts.MCScreenFunc = dummy; //Save name with correct case
+      //Check for special methods
+      LICHEMLowerText(dummy);
+      if (dummy == "mm")
+      {
+        //Screen with the MM energy
+        QMMMOpts.MCScreenFunc = "MM";
+      }
+      if ((dummy == "semiempirical") || (dummy == "se-scf") ||
+         (dummy == "semi-empirical") || (dummy == "sescf") ||
+         (dummy == "semiemp"))
+      {
+        //Flag the method as a semi-empirical Hamiltonian
+        QMMMOpts.MCScreenFunc = "SemiEmp";
+      }
+    }
+    else if (keyword == "mc_target_error:")
+    {
+      //Read the energy error bar for stopping production
+      regionFile >> QMMMOpts.MCTargetErr;
+    }
+    else if (keyword == "mc_volume_weight:")
+    {
+      //Read the relative probability of volume moves
+      regionFile >> QMMMOpts.MCVolWeight;
+    }
+    else if (keyword == "mm_opt_adaptive:")
+    {
+      //Check for adaptive QM/MM microiterations
+      regionFile >> dummy;
+      LICHEMLowerText(dummy);
+      if ((dummy == "yes") || (dummy == "true"))
+      {
+        QMMMOpts.adaptMM = 1;
+      }
+    }
     else if (keyword == "mm_opt_cut:")
     {
       //Read MM optimization cutoff
       regionFile >> QMMMOpts.MMOptCut;
     }
+    else if (keyword == "mm_opt_skip_disp:")
+    {
+      //Read the QM displacement which requires an MM relaxation
+      regionFile >> QMMMOpts.MMSkipDisp;
+    }
     else if (keyword == "mm_opt_tolerance:")
     {
       //Read MM optimization tolerance (RMSD value)
@@ -545,6 +718,90 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
         }
       }
     }
+    else if (keyword == "neb_freeze:")
+    {
+      //Check for adaptive freezing of converged beads
+      regionFile >> dummy;
+      LICHEMLowerText(dummy);
+      if ((dummy == "yes") || (dummy == "true"))
+      {
+        QMMMOpts.NEBFreeze = 1;
+      }
+    }
+    else if (keyword == "neb_freeze_tol:")
+    {
+      //Read the neighbor displacement for reactivating frozen beads
+      regionFile >> QMMMOpts.NEBFreezeTol;
+    }
+    else if (keyword == "neb_optimizer:")
+    {
+      //Read the path optimizer for NEB
+      regionFile >> dummy;
+      LICHEMLowerText(dummy);
+      if (dummy == "bfgs")
+      {
+        //Synonym for L-BFGS
+        dummy = "lbfgs";
+      }
+      QMMMOpts.NEBOpt = dummy;
+    }
+    else if (keyword == "neb_pre_basis:")
+    {
+      //Set the basis set for the pre-optimization of the path
+      regionFile >> QMMMOpts.NEBPreBasis;
+    }
+    else if (keyword == "neb_pre_method:")
+    {
+      //Set the QM method for the pre-optimization of the path
+      regionFile >> dummy;
+      QMMMOpts.NEBPreFunc = dummy; //Save name with correct case
+      //Check for special methods
+      LICHEMLowerText(dummy);
+      if ((dummy == "semiempirical") || (dummy == "se-scf") ||
+         (dummy == "semi-empirical") || (dummy == "sescf") ||
+         (dummy == "semiemp"))
+      {
+        //Flag the method as a semi-empirical Hamiltonian
+        QMMMOpts.NEBPreFunc = "SemiEmp";
+      }
+    }
+    else if (keyword == "neb_surrogate:")
+    {
+      //Check for Gaussian process accelerated NEB
+      regionFile >> dummy;
+      LICHEMLowerText(dummy);
+      if ((dummy == "yes") || (dummy == "true"))
+      {
+        QMMMOpts.NEBSurrogate = 1;
+      }
+    }
+    else if (keyword == "neb_surrogate_tol:")
+    {
+      //Read the uncertainty tolerance for the surrogate energies
+      regionFile >> QMMMOpts.GPUncertTol;
+    }
+    else if (keyword == "opt_hessian:")
+    {
+      //Read the starting Hessian for the DFP optimizer
+      regionFile >> dummy;
+      LICHEMLowerText(dummy);
+      if ((dummy == "calculated") || (dummy == "exact"))
+      {
+        //Synonyms for a calculated Hessian
+        dummy = "calc";
+      }
+      QMMMOpts.initHess = dummy;
+    }
+    else if (keyword == "opt_hessian_reuse:")
+    {
+      //Check if the optimizers should keep the Hessian
+      regionFile >> dummy;
+      LICHEMLowerText(dummy);
+      if ((dummy == "yes") || (dummy == "true"))
+      {
+        QMMMOpts.reuseHess = 1;
+      }
+    }
     else if (keyword == "opt_stepsize:")
     {
       //Read the optimization stepsize
@@ -560,6 +817,16 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
         PBCon = 1;
       }
     }
+    else if (keyword == "pi_normal_modes:")
+    {
+      //Check for normal mode moves of the ring polymers
+      regionFile >> dummy;
+      LICHEMLowerText(dummy);
+      if ((dummy == "yes") || (dummy == "true"))
+      {
+        QMMMOpts.PINormModes = 1;
+      }
+    }
     else if (keyword == "potential_type:")
     {
       //Set QM, MM, and QMMM options
@@ -613,6 +880,11 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
       //Set the basis set or semi-empirical Hamiltonian
       regionFile >> QMMMOpts.basis;
     }
+    else if (keyword == "qm_beads:")
+    {
+      //Read the number of beads for the contracted QM ring polymers
+      regionFile >> QMMMOpts.NQMBeads;
+    }
     else if (keyword == "qm_charge:")
     {
       //Set the total charge on the QM region
@@ -690,6 +962,26 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
         QMMMOpts.unitsQM = "Bohr";
       }
     }
+    else if (keyword == "random_seed:")
+    {
+      //Read the seed for the random number streams
+      regionFile >> QMMMOpts.randSeed;
+    }
+    else if (keyword == "replica_exchange_steps:")
+    {
+      //Read the number of steps between replica exchanges
+      regionFile >> QMMMOpts.NExchange;
+    }
+    else if (keyword == "replica_max_temp:")
+    {
+      //Read the highest replica exchange temperature
+      regionFile >> QMMMOpts.maxTemp;
+    }
+    else if (keyword == "replicas:")
+    {
+      //Read the number of replica exchange temperatures
+      regionFile >> QMMMOpts.NReplicas;
+    }
     else if (keyword == "solv_model:")
     {
       //Read MM implicit solvent model
@@ -761,6 +1053,11 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
         QMMMOpts.useImpSolv = 1;
       }
     }
+    else if (keyword == "walkers:")
+    {
+      //Read the number of independent MC walkers
+      regionFile >> QMMMOpts.NWalkers;
+    }
     //Check for region keywords
     else if (keyword == "qm_atoms:")
     {
@@ -860,6 +1157,39 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
     }
   }
   Nmm = Natoms-Nqm-Npseudo-Nbound; //Set number of MM atoms
+  //Check the atoms in the finite-difference Hessians
+  for (unsigned int i=0;i<hessIDs.size();i++)
+  {
+    int atomID = hessIDs[i]; //Listed atom
+    if (!(QMMMData[atomID].QMRegion || QMMMData[atomID].PBRegion))
+    {
+      //Only QM and PB atoms are displaced
+      cout << "Error: Hess_atoms contains atom " << atomID;
+      cout << ", which is not a QM or PB atom." << '\n';
+      cout.flush();
+      exit(0);
+    }
+  }
+  //Set up frozen densities
+  if (GEM && (QMMMOpts.GEMBasis != "N/A"))
+  {
+    for (int i=0;i<Natoms;i++)
+    {
+      if (QMMMData[i].MMRegion)
+      {
+        //The basis functions are shared through the library
+        GEMDen tmp(QMMMData[i].QMTyp,QMMMOpts.GEMBasis);
+        QMMMData[i].GEM.push_back(tmp);
+      }
+    }
+  }
+  //Set up the random number streams
+  if (QMMMOpts.randSeed == 0)
+  {
+    //Seed from the clock
+    QMMMOpts.randSeed = (unsigned long long)time(0);
+  }
+  randGen.seed(QMMMOpts.randSeed,FindMaxThreads());
   //Replicate atoms
   if (QMMMOpts.NBeads > 1)
   {
@@ -904,9 +1234,9 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
         for (int j=0;j<(QMMMOpts.NBeads-1);j++)
         {
           //Pick random displacements
-          double randX = (((double)rand())/((double)RAND_MAX));
-          double randY = (((double)rand())/((double)RAND_MAX));
-          double randZ = (((double)rand())/((double)RAND_MAX));
+          double randX = randGen.uniform();
+          double randY = randGen.uniform();
+          double randZ = randGen.uniform();
           //Place the first bead at the initial position
           if (j == 0)
           {
@@ -1013,9 +1343,14 @@ void ReadLICHEMInput(fstream& xyzFile, fstream& connectFile,
         Ncpus = Nthreads;
       }
       //Modify threads for certain multi-replica simulations
-      if ((QMMMOpts.NBeads > 1) && (PIMCSim || FBNEBSim))
+      bool multiChain = 0; //Flag for concurrent replicas or walkers
+      if (PIMCSim && ((QMMMOpts.NReplicas > 1) || (QMMMOpts.NWalkers > 1)))
       {
-        //Divide threads between the beads
+        multiChain = 1;
+      }
+      if (((QMMMOpts.NBeads > 1) && (PIMCSim || FBNEBSim)) || multiChain)
+      {
+        //Divide threads between the beads and chains
         Nthreads = ((int)floor(Procs/Ncpus));
         //Set number of threads for wrappers
         omp_set_num_threads(Nthreads);
@@ -1136,6 +1471,15 @@ void LICHEMErrorChecker(QMMMSettings& QMMMOpts)
     cout << '\n';
     doQuit = 1;
   }
+  if (QMMMOpts.useGEMDen && ((!GEM) || (!TINKER) ||
+     (QMMMOpts.GEMBasis == "N/A")))
+  {
+    //GEM densities are only added to TINKER energies
+    cout << " Error: GEM density interactions require the GEM potential, ";
+    cout << "TINKER, and a GEM basis.";
+    cout << '\n';
+    doQuit = 1;
+  }
   if ((!Gaussian) && (!PSI4) && (!NWChem) && (!MMonly))
   {
     //Check the QM wrappers
@@ -1225,6 +1569,190 @@ void LICHEMErrorChecker(QMMMSettings& QMMMOpts)
     QMMMOpts.stepScale = 1; //Reset step size
     cout.flush(); //Print warning
   }
+  if ((QMMMOpts.NEBOpt != "dfp") && (QMMMOpts.NEBOpt != "lbfgs") &&
+     (QMMMOpts.NEBOpt != "fire"))
+  {
+    //Check the NEB optimizer
+    cout << " Error: Unknown NEB optimizer ";
+    cout << QMMMOpts.NEBOpt << ".";
+    cout << '\n';
+    cout << "  Available optimizers: DFP, LBFGS, or FIRE.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (NEBSim && QMMMOpts.NEBSurrogate && (QMMMOpts.GPUncertTol <= 0))
+  {
+    //Check the surrogate tolerance
+    cout << " Error: The surrogate uncertainty tolerance must be positive.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (NEBSim && (QMMMOpts.NEBPreFunc != "N/A") && MMonly)
+  {
+    //Check pre-optimization settings
+    cout << " Error: A lower level QM method requires a QM region.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (NEBSim && (QMMMOpts.NEBPreFunc == "SemiEmp") &&
+     (QMMMOpts.NEBPreBasis == "N/A"))
+  {
+    //Check pre-optimization settings
+    cout << " Error: A semi-empirical pre-optimization needs a Hamiltonian";
+    cout << " in NEB_pre_basis.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && ((QMMMOpts.MCBeadWeight < 0) ||
+     (QMMMOpts.MCCentWeight < 0) || (QMMMOpts.MCModeWeight < 0) ||
+     (QMMMOpts.MCMolWeight < 0) || (QMMMOpts.MCVolWeight < 0) ||
+     (QMMMOpts.MCForceWeight < 0)))
+  {
+    //Check move weights
+    cout << " Error: Monte Carlo move weights cannot be negative.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && (QMMMOpts.MCForceWeight > 0) &&
+     (QMMMOpts.NQMBeads > 0) && (QMMMOpts.NQMBeads < QMMMOpts.NBeads) &&
+     (QMonly || QMMM))
+  {
+    //Check force-bias settings
+    cout << " Error: Force-bias moves cannot be combined with ring polymer";
+    cout << " contraction.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && (QMMMOpts.MCTargetErr < 0))
+  {
+    //Check convergence settings
+    cout << " Error: The target error bar cannot be negative.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && (QMMMOpts.MCRejectBound < 0))
+  {
+    //Check early rejection settings
+    cout << " Error: The early rejection bound cannot be negative.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && (QMMMOpts.MCScreenFunc == "MM") && (!QMMM))
+  {
+    //Check delayed acceptance settings
+    cout << " Error: MM screening energies require a QMMM simulation.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && (QMMMOpts.MCScreenFunc != "N/A") &&
+     (QMMMOpts.MCScreenFunc != "MM") && MMonly)
+  {
+    //Check delayed acceptance settings
+    cout << " Error: A QM screening method requires a QM region.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && (QMMMOpts.MCScreenFunc == "SemiEmp") &&
+     (QMMMOpts.MCScreenBasis == "N/A"))
+  {
+    //Check delayed acceptance settings
+    cout << " Error: A semi-empirical screening method needs a Hamiltonian";
+    cout << " in MC_screen_basis.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && (QMMMOpts.NReplicas < 1))
+  {
+    //Check replica exchange settings
+    cout << " Error: The number of replicas must be positive.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && (QMMMOpts.NReplicas > 1) &&
+     ((QMMMOpts.maxTemp <= QMMMOpts.temp) || (QMMMOpts.NExchange < 1)))
+  {
+    //Check replica exchange settings
+    cout << " Error: Replica exchange needs a maximum temperature above";
+    cout << " the simulation temperature and a positive exchange interval.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && (QMMMOpts.NWalkers < 1))
+  {
+    //Check walker settings
+    cout << " Error: The number of walkers must be positive.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && ((QMMMOpts.NWalkers > 1) || (QMMMOpts.NReplicas > 1)) &&
+     (QMMMOpts.ensemble != "NVT"))
+  {
+    //Check walker settings
+    cout << " Error: Replica exchange and multiple walkers are only";
+    cout << " available in the NVT ensemble.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (PIMCSim && (QMMMOpts.NWalkers > 1) && (QMMMOpts.NReplicas > 1))
+  {
+    //Check walker settings
+    cout << " Error: Multiple walkers cannot be combined with";
+    cout << " replica exchange.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if ((QMMMOpts.NQMBeads < 0) || (QMMMOpts.NQMBeads > QMMMOpts.NBeads))
+  {
+    //Check ring polymer contraction settings
+    cout << " Error: The number of QM beads must be between 0 and the";
+    cout << " number of beads.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (DimerSim && MMonly)
+  {
+    //The dimer only moves the QM and PB atoms
+    cout << " Error: Dimer searches require QM or QMMM wrappers.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (DimerSim && (QMMMOpts.dimerDist <= 0))
+  {
+    //Check the dimer length
+    cout << " Error: The dimer distance must be positive.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if ((BFGSSim || DimerSim || (QMMMOpts.NEBOpt == "lbfgs")) &&
+     (QMMMOpts.LBFGSMem < 1))
+  {
+    //Check the L-BFGS history
+    cout << " Error: The L-BFGS memory must be at least 1.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (QMMMOpts.adaptMM && (QMMMOpts.MMSkipDisp < 0))
+  {
+    //Check the microiteration settings
+    cout << " Error: The MM skipping displacement cannot be negative.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if ((QMMMOpts.initHess != "identity") && (QMMMOpts.initHess != "lindh") &&
+     (QMMMOpts.initHess != "calc"))
+  {
+    //Check the starting Hessian
+    cout << " Error: Unrecognized starting Hessian.";
+    cout << '\n';
+    doQuit = 1;
+  }
+  if (QMMMOpts.numHess && (QMMMOpts.FDStep <= 0))
+  {
+    //Check the finite-difference displacement
+    cout << " Error: The finite-difference step must be positive.";
+    cout << '\n';
+    doQuit = 1;
+  }
   if (doQuit)
   {
     //Quits
@@ -1305,12 +1833,36 @@ void LICHEMPrintSettings(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
     }
     cout << " NEB" << '\n';
   }
+  if (DimerSim)
+  {
+    //Print saddle point search input for error checking
+    if (QMMMOpts.NBeads > 1)
+    {
+      cout << " RP beads: " << QMMMOpts.NBeads << '\n';
+    }
+    cout << '\n';
+    cout << "Simulation mode: ";
+    if (QMMM)
+    {
+      cout << "QMMM";
+    }
+    if (QMonly)
+    {
+      cout << "Pure QM";
+    }
+    cout << " dimer saddle point search" << '\n';
+  }
   if (PIMCSim)
   {
     //Print PIMC input for error checking
     if (QMMMOpts.NBeads > 1)
     {
       cout << " PI beads: " << QMMMOpts.NBeads << '\n';
+      if ((QMMMOpts.NQMBeads > 0) && (QMMMOpts.NQMBeads < QMMMOpts.NBeads) &&
+         (!MMonly))
+      {
+        cout << " Contracted QM beads: " << QMMMOpts.NQMBeads << '\n';
+      }
     }
     cout << '\n';
     cout << "Simulation mode: ";
@@ -1334,6 +1886,57 @@ void LICHEMPrintSettings(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
     cout << " Monte Carlo" << '\n';
     cout << " Equilibration MC steps: " << QMMMOpts.NEq << '\n';
     cout << " Production MC steps: " << QMMMOpts.NSteps << '\n';
+    if (QMMMOpts.PINormModes && (QMMMOpts.NBeads > 1))
+    {
+      cout << " Bead moves: Ring polymer normal modes" << '\n';
+    }
+    cout << " Move weights:";
+    cout << " Bead " << LICHEMFormFloat(QMMMOpts.MCBeadWeight,4);
+    cout << ", Centroid " << LICHEMFormFloat(QMMMOpts.MCCentWeight,4);
+    cout << ", Mode " << LICHEMFormFloat(QMMMOpts.MCModeWeight,4);
+    cout << '\n';
+    cout << "  "; //Indent
+    cout << " Force " << LICHEMFormFloat(QMMMOpts.MCForceWeight,4);
+    cout << ", Molecule " << LICHEMFormFloat(QMMMOpts.MCMolWeight,4);
+    if (QMMMOpts.ensemble == "NPT")
+    {
+      cout << ", Volume " << LICHEMFormFloat(QMMMOpts.MCVolWeight,4);
+    }
+    cout << '\n';
+    if (QMMMOpts.MCRejectBound > 0)
+    {
+      cout << " Early rejection bound: ";
+      cout << LICHEMFormFloat(QMMMOpts.MCRejectBound,6);
+      cout << " eV" << '\n';
+    }
+    if (QMMMOpts.MCTargetErr > 0)
+    {
+      cout << " Target error bar: ";
+      cout << LICHEMFormFloat(QMMMOpts.MCTargetErr,8);
+      cout << " eV" << '\n';
+    }
+    if (QMMMOpts.NReplicas > 1)
+    {
+      cout << " Replica exchange: " << QMMMOpts.NReplicas;
+      cout << " temperatures from " << LICHEMFormFloat(QMMMOpts.temp,8);
+      cout << " to " << LICHEMFormFloat(QMMMOpts.maxTemp,8) << " K";
+      cout << '\n';
+      cout << " Exchange every " << QMMMOpts.NExchange << " steps" << '\n';
+    }
+    if (QMMMOpts.NWalkers > 1)
+    {
+      cout << " Independent walkers: " << QMMMOpts.NWalkers << '\n';
+    }
+    if (QMMMOpts.MCScreenFunc != "N/A")
+    {
+      cout << " Delayed acceptance screening: ";
+      cout << QMMMOpts.MCScreenFunc;
+      if (QMMMOpts.MCScreenBasis != "N/A")
+      {
+        cout << "/" << QMMMOpts.MCScreenBasis;
+      }
+      cout << '\n';
+    }
   }
   if (FBNEBSim)
   {
@@ -1365,7 +1968,7 @@ void LICHEMPrintSettings(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
     cout << " Equilibration MC steps: " << QMMMOpts.NEq << '\n';
     cout << " Production MC steps: " << QMMMOpts.NSteps << '\n';
   }
-  if (OptSim || SteepSim || DFPSim)
+  if (OptSim || SteepSim || DFPSim || BFGSSim)
   {
     //Print optimization input for error checking
     cout << '\n';
@@ -1403,6 +2006,10 @@ void LICHEMPrintSettings(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
       {
         cout << "LICHEM DFP" << '\n';
       }
+      if (BFGSSim)
+      {
+        cout << "LICHEM L-BFGS" << '\n';
+      }
     }
   }
   if (SinglePoint)
@@ -1508,6 +2115,16 @@ void LICHEMPrintSettings(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
       if (GEM)
       {
         cout << "Diffuse-charge force field" << '\n';
+        if (QMMMOpts.GEMBasis != "N/A")
+        {
+          cout << " GEM basis: " << QMMMOpts.GEMBasis << '\n';
+        }
+        if (QMMMOpts.useGEMDen)
+        {
+          cout << " GEM density interactions: Yes" << '\n';
+          cout << " GEM exchange scale: " << QMMMOpts.GEMExch;
+          cout << " eV" << '\n';
+        }
       }
     }
     //Print PBC information
@@ -1599,9 +2216,10 @@ void LICHEMPrintSettings(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
     cout << '\n';
     cout << " Sample every " << QMMMOpts.NPrint;
     cout << " steps" << '\n';
+    cout << " Random seed: " << randGen.getSeed() << '\n';
   }
   //Print convergence criteria for optimizations
-  if (OptSim || SteepSim || DFPSim || NEBSim)
+  if (OptSim || SteepSim || DFPSim || BFGSSim || NEBSim || DimerSim)
   {
     cout << '\n';
     cout << "Optimization settings:" << '\n';
@@ -1615,6 +2233,40 @@ void LICHEMPrintSettings(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
     cout << LICHEMFormFloat(QMMMOpts.maxStep,6);
     cout << " \u212B" << '\n';
     cout << " Max. steps: " << QMMMOpts.maxOptSteps;
+    if (BFGSSim || DimerSim || (NEBSim && (QMMMOpts.NEBOpt == "lbfgs")))
+    {
+      //Print L-BFGS settings
+      cout << '\n';
+      cout << " L-BFGS memory: " << QMMMOpts.LBFGSMem;
+    }
+    if (DFPSim && (QMMMOpts.initHess != "identity"))
+    {
+      //Print the starting Hessian
+      cout << '\n';
+      cout << " Starting Hessian: ";
+      if (QMMMOpts.initHess == "lindh")
+      {
+        cout << "Lindh model";
+      }
+      else
+      {
+        cout << "Calculated";
+      }
+    }
+    if ((DFPSim || BFGSSim) && QMMMOpts.reuseHess)
+    {
+      //Print Hessian checkpoint settings
+      cout << '\n';
+      cout << " Reuse Hessian: Yes";
+    }
+    if ((SteepSim || DFPSim || BFGSSim) && QMMMOpts.adaptMM && QMMM)
+    {
+      //Print microiteration settings
+      cout << '\n';
+      cout << " Skip MM relaxations below: ";
+      cout << LICHEMFormFloat(QMMMOpts.MMSkipDisp,6);
+      cout << " \u212B";
+    }
     if (QMMMOpts.useMMCut && (Nmm > 0))
     {
       //Print MM cutoff settings
@@ -1623,10 +2275,68 @@ void LICHEMPrintSettings(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
       cout << LICHEMFormFloat(QMMMOpts.MMOptCut,8);
       cout << " \u212B";
     }
+    if (DimerSim)
+    {
+      //Print dimer settings
+      cout << '\n';
+      cout << " Dimer distance: ";
+      cout << LICHEMFormFloat(QMMMOpts.dimerDist,6);
+      cout << " \u212B";
+    }
     if (NEBSim)
     {
       //Spring constant for the path
       cout << '\n';
+      cout << " Path optimizer: ";
+      if (QMMMOpts.NEBSurrogate)
+      {
+        cout << "Gaussian process surrogate";
+      }
+      else if (QMMMOpts.NEBOpt == "lbfgs")
+      {
+        cout << "L-BFGS";
+      }
+      else if (QMMMOpts.NEBOpt == "fire")
+      {
+        cout << "FIRE";
+      }
+      else
+      {
+        cout << "DFP";
+      }
+      cout << '\n';
+      if (QMMMOpts.NEBPreFunc != "N/A")
+      {
+        //Print the lower level of theory
+        cout << " Path pre-optimization: ";
+        if (QMMMOpts.NEBPreFunc != "SemiEmp")
+        {
+          //Avoid printing method and basis for semi-empirical
+          cout << QMMMOpts.NEBPreFunc << "/";
+        }
+        if (QMMMOpts.NEBPreBasis != "N/A")
+        {
+          cout << QMMMOpts.NEBPreBasis << '\n';
+        }
+        else
+        {
+          cout << QMMMOpts.basis << '\n';
+        }
+      }
+      if (QMMMOpts.NEBSurrogate)
+      {
+        //Print surrogate model settings
+        cout << " Surrogate uncertainty: ";
+        cout << LICHEMFormFloat(QMMMOpts.GPUncertTol,6);
+        cout << " eV" << '\n';
+      }
+      if (QMMMOpts.NEBFreeze)
+      {
+        //Print adaptive freezing settings
+        cout << " Frozen bead reactivation: ";
+        cout << LICHEMFormFloat(QMMMOpts.NEBFreezeTol,6);
+        cout << " \u212B" << '\n';
+      }
       cout << " Spring constant: " << QMMMOpts.kSpring;
       cout << " eV/\u212B\u00B2" << '\n';
       cout << " End points: ";
@@ -1640,7 +2350,7 @@ void LICHEMPrintSettings(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
       }
     }
     cout << '\n';
-    if (SteepSim || DFPSim || NEBSim)
+    if (SteepSim || DFPSim || BFGSSim || NEBSim || DimerSim)
     {
       cout << '\n';
       cout << "QM convergence criteria:" << '\n';
@@ -1690,6 +2400,24 @@ void LICHEMPrintSettings(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
     {
       cout << "Yes" << '\n';
     }
+    //Number of calculated modes
+    if (QMMMOpts.NFreqModes > 0)
+    {
+      cout << "  Lowest modes: " << QMMMOpts.NFreqModes;
+      cout << '\n';
+    }
+    //Source of the Hessian
+    cout << "  Hessian: ";
+    if (QMMMOpts.numHess)
+    {
+      cout << "Finite-difference (";
+      cout << LICHEMFormFloat(QMMMOpts.FDStep,6);
+      cout << " \u212B)" << '\n';
+    }
+    else
+    {
+      cout << "Wrappers" << '\n';
+    }
   }
   cout << '\n';
   cout.flush(); //Flush for output being redirected to a file
@@ -28,7 +28,6 @@ int main(int argc, char* argv[])
 {
   //Misc. initialization
   startTime = (unsigned)time(0); //Time the program starts
-  srand((unsigned)time(0)); //Serial only random numbers
   //End of section
 
   //Output stream settings
@@ -39,7 +38,7 @@ int main(int argc, char* argv[])
 
   //Initialize local variables
   string dummy; //Generic string
-  double sumE,sumE2,denAvg,LxAvg,LyAvg,LzAvg,Ek; //Energies and properties
+  double sumE,Ek; //Energies and properties
   fstream xyzFile,connectFile,regionFile,outFile; //Input and output files
   vector<QMMMAtom> QMMMData; //Atom list
   vector<QMMMAtom> OldQMMMData; //A copy of the atoms list
@@ -226,38 +225,46 @@ int main(int argc, char* argv[])
         cout << " Frequencies for bead: " << p << '\n';
         cout.flush();
       }
-      if (Gaussian)
-      {
-        int tStart = (unsigned)time(0);
-        QMMMHess += GaussianHessian(QMMMData,QMMMOpts,p);
-        QMTime += (unsigned)time(0)-tStart;
-      }
-      if (PSI4)
-      {
-        int tStart = (unsigned)time(0);
-        QMMMHess += PSI4Hessian(QMMMData,QMMMOpts,p);
-        QMTime += (unsigned)time(0)-tStart;
-        //Delete annoying useless files
-        globalSys = system("rm -f psi.* timer.*");
-      }
-      if (NWChem)
+      if (QMMMOpts.numHess)
       {
-        int tStart = (unsigned)time(0);
-        QMMMHess += NWChemHessian(QMMMData,QMMMOpts,p);
-        QMTime += (unsigned)time(0)-tStart;
+        //Calculate the Hessian from finite differences of the forces
+        QMMMHess = LICHEMFDHessian(QMMMData,QMMMOpts,p);
       }
-      //Calculate MM energy
-      if (TINKER)
-      {
-        int tStart = (unsigned)time(0);
-        QMMMHess += TINKERHessian(QMMMData,QMMMOpts,p);
-        MMTime += (unsigned)time(0)-tStart;
-      }
-      if (LAMMPS)
+      else
       {
-        int tStart = (unsigned)time(0);
-        QMMMHess += LAMMPSHessian(QMMMData,QMMMOpts,p);
-        MMTime += (unsigned)time(0)-tStart;
+        if (Gaussian)
+        {
+          int tStart = (unsigned)time(0);
+          QMMMHess += GaussianHessian(QMMMData,QMMMOpts,p);
+          QMTime += (unsigned)time(0)-tStart;
+        }
+        if (PSI4)
+        {
+          int tStart = (unsigned)time(0);
+          QMMMHess += PSI4Hessian(QMMMData,QMMMOpts,p);
+          QMTime += (unsigned)time(0)-tStart;
+          //Delete annoying useless files
+          globalSys = system("rm -f psi.* timer.*");
+        }
+        if (NWChem)
+        {
+          int tStart = (unsigned)time(0);
+          QMMMHess += NWChemHessian(QMMMData,QMMMOpts,p);
+          QMTime += (unsigned)time(0)-tStart;
+        }
+        //Calculate MM energy
+        if (TINKER)
+        {
+          int tStart = (unsigned)time(0);
+          QMMMHess += TINKERHessian(QMMMData,QMMMOpts,p);
+          MMTime += (unsigned)time(0)-tStart;
+        }
+        if (LAMMPS)
+        {
+          int tStart = (unsigned)time(0);
+          QMMMHess += LAMMPSHessian(QMMMData,QMMMOpts,p);
+          MMTime += (unsigned)time(0)-tStart;
+        }
       }
       //Calculate frequencies
       QMMMFreqs = LICHEMFreq(QMMMData,QMMMHess,QMMMOpts,p,remCt);
@@ -418,6 +425,12 @@ int main(int argc, char* argv[])
   {
     VectorXd forces; //Dummy array needed for convergence tests
     int optCt = 0; //Counter for optimization steps
+    //Loosen the first MM relaxations
+    double savedMMOptTol = QMMMOpts.MMOptTol; //Save value from input
+    if (QMMMOpts.adaptMM && QMMM && (QMMMOpts.MMOptTol < 0.25))
+    {
+      QMMMOpts.MMOptTol = 0.25; //Tightened during the optimization
+    }
     //Print initial structure
     Print_traj(QMMMData,outFile,QMMMOpts);
     cout << "Steepest descent optimization:" << '\n';
@@ -465,29 +478,47 @@ int main(int argc, char* argv[])
     cout.flush(); //Print progress
     //Run optimization
     bool optDone = 0;
+    bool relaxMM = 1; //Flag to run the MM optimization
+    double lastMMTol = QMMMOpts.MMOptTol; //MM tolerance of the last relaxation
     while (!optDone)
     {
+      if (QMMMOpts.adaptMM && QMMM && (optCt > 0))
+      {
+        //Only relax the MM environment when the QM step changed it
+        relaxMM = MMRelaxNeeded(QMMMData,OldQMMMData,QMMMOpts,lastMMTol,0);
+      }
+      if (relaxMM)
+      {
+        //Save the tolerance of this MM relaxation
+        lastMMTol = QMMMOpts.MMOptTol;
+      }
       //Copy structure
       OldQMMMData = QMMMData;
       //Run MM optimization
-      if (TINKER)
+      if (TINKER && relaxMM)
       {
         int tStart = (unsigned)time(0);
         sumE = TINKEROpt(QMMMData,QMMMOpts,0);
         MMTime += (unsigned)time(0)-tStart;
       }
-      if (LAMMPS)
+      if (LAMMPS && relaxMM)
       {
         int tStart = (unsigned)time(0);
         sumE = LAMMPSOpt(QMMMData,QMMMOpts,0);
         MMTime += (unsigned)time(0)-tStart;
       }
-      if (QMMM)
+      if (QMMM && relaxMM)
       {
         cout << "    MM optimization complete.";
         cout << '\n';
         cout.flush();
       }
+      else if (QMMM)
+      {
+        cout << "    MM environment is relaxed. Skipping MM optimization.";
+        cout << '\n';
+        cout.flush();
+      }
       cout << '\n';
       //Run QM optimization
       LICHEMSteepest(QMMMData,QMMMOpts,0);
@@ -496,6 +527,27 @@ int main(int argc, char* argv[])
       //Check convergence
       optCt += 1;
       optDone = OptConverged(QMMMData,OldQMMMData,forces,optCt,QMMMOpts,0,0);
+      if (QMMMOpts.MMOptTol > savedMMOptTol)
+      {
+        if (optDone)
+        {
+          //The QM region is converged, so finish at the final MM tolerance
+          QMMMOpts.MMOptTol = savedMMOptTol;
+          optDone = 0; //Not converged
+          cout << "    Tightening the MM tolerance...";
+          cout << '\n';
+          cout.flush();
+        }
+        else
+        {
+          //Tighten the MM tolerance gradually
+          QMMMOpts.MMOptTol *= 0.5;
+          if (QMMMOpts.MMOptTol < savedMMOptTol)
+          {
+            QMMMOpts.MMOptTol = savedMMOptTol;
+          }
+        }
+      }
     }
     cout << '\n';
     cout << "Optimization complete.";
@@ -504,8 +556,8 @@ int main(int argc, char* argv[])
   }
   //End of section
 
-  //DFP minimization
-  else if (DFPSim)
+  //DFP and L-BFGS minimization
+  else if (DFPSim || BFGSSim)
   {
     VectorXd forces; //Dummy array needed for convergence tests
     int optCt = 0; //Counter for optimization steps
@@ -522,7 +574,14 @@ int main(int argc, char* argv[])
     }
     //Print initial structure
     Print_traj(QMMMData,outFile,QMMMOpts);
-    cout << "DFP optimization:" << '\n';
+    if (BFGSSim)
+    {
+      cout << "L-BFGS optimization:" << '\n';
+    }
+    else
+    {
+      cout << "DFP optimization:" << '\n';
+    }
     cout.flush(); //Print progress
     //Calculate initial energy
     sumE = 0; //Clear old energies
@@ -567,35 +626,63 @@ int main(int argc, char* argv[])
     cout.flush(); //Print progress
     //Run optimization
     bool optDone = 0;
+    bool relaxMM = 1; //Flag to run the MM optimization
+    double lastMMTol = QMMMOpts.MMOptTol; //MM tolerance of the last relaxation
     while (!optDone)
     {
+      if (QMMMOpts.adaptMM && QMMM && (optCt > 0))
+      {
+        //Only relax the MM environment when the QM step changed it
+        relaxMM = MMRelaxNeeded(QMMMData,OldQMMMData,QMMMOpts,lastMMTol,0);
+      }
+      if (relaxMM)
+      {
+        //Save the tolerance of this MM relaxation
+        lastMMTol = QMMMOpts.MMOptTol;
+      }
       //Copy structure
       OldQMMMData = QMMMData;
       //Run MM optimization
-      if (TINKER)
+      if (TINKER && relaxMM)
       {
         int tStart = (unsigned)time(0);
         sumE = TINKEROpt(QMMMData,QMMMOpts,0);
         MMTime += (unsigned)time(0)-tStart;
       }
-      if (LAMMPS)
+      if (LAMMPS && relaxMM)
       {
         int tStart = (unsigned)time(0);
         sumE = LAMMPSOpt(QMMMData,QMMMOpts,0);
         MMTime += (unsigned)time(0)-tStart;
       }
-      if (QMMM)
+      if (QMMM && relaxMM)
       {
         cout << "    MM optimization complete.";
         cout << '\n';
         cout.flush();
       }
+      else if (QMMM)
+      {
+        cout << "    MM environment is relaxed. Skipping MM optimization.";
+        cout << '\n';
+        cout.flush();
+      }
       cout << '\n';
       //Run QM optimization
-      LICHEMDFP(QMMMData,QMMMOpts,0);
+      if (BFGSSim)
+      {
+        LICHEMLBFGS(QMMMData,QMMMOpts,0);
+      }
+      else
+      {
+        LICHEMDFP(QMMMData,QMMMOpts,0);
+      }
       //Reset tolerance before optimization check
       QMMMOpts.QMOptTol = savedQMOptTol;
-      QMMMOpts.MMOptTol = savedMMOptTol;
+      if (!(QMMMOpts.adaptMM && QMMM))
+      {
+        QMMMOpts.MMOptTol = savedMMOptTol;
+      }
       //Print Optimized geometry
       Print_traj(QMMMData,outFile,QMMMOpts);
       //Check convergence
@@ -606,6 +693,27 @@ int main(int argc, char* argv[])
         //Avoid terminating restarts on the loose tolerance step
         optDone = 0; //Not converged
       }
+      if (QMMMOpts.MMOptTol > savedMMOptTol)
+      {
+        if (optDone)
+        {
+          //The QM region is converged, so finish at the final MM tolerance
+          QMMMOpts.MMOptTol = savedMMOptTol;
+          optDone = 0; //Not converged
+          cout << "    Tightening the MM tolerance...";
+          cout << '\n';
+          cout.flush();
+        }
+        else
+        {
+          //Tighten the MM tolerance gradually
+          QMMMOpts.MMOptTol *= 0.5;
+          if (QMMMOpts.MMOptTol < savedMMOptTol)
+          {
+            QMMMOpts.MMOptTol = savedMMOptTol;
+          }
+        }
+      }
     }
     cout << '\n';
     cout << "Optimization complete.";
@@ -614,30 +722,40 @@ int main(int argc, char* argv[])
   }
   //End of section
 
-  //Run Monte Carlo
-  else if (PIMCSim)
+  //Run replica exchange or multiple walker Monte Carlo
+  else if (PIMCSim && ((QMMMOpts.NReplicas > 1) || (QMMMOpts.NWalkers > 1)))
   {
     //Change units
     QMMMOpts.press *= atm2eV; //Pressure in eV/Ang^3
-    //Adjust probabilities
-    if (Natoms == 1)
+    //Set up the move catalogue
+    PIMoveSetup(QMMMData,QMMMOpts);
+    //Run the replicas or walkers
+    if (QMMMOpts.NReplicas > 1)
     {
-      //Remove atom centroid moves
-      centProb = 0.0;
-      beadProb = 1.0;
+      LICHEMReplicaExchange(QMMMData,QMMMOpts,outFile);
     }
-    if (QMMMOpts.ensemble == "NVT")
+    else
     {
-      //Remove volume changes
-      volProb = 0.0;
+      LICHEMMultiWalker(QMMMData,QMMMOpts,outFile);
     }
+  }
+  //End of section
+
+  //Run Monte Carlo
+  else if (PIMCSim)
+  {
+    //Change units
+    QMMMOpts.press *= atm2eV; //Pressure in eV/Ang^3
+    //Set up the move catalogue
+    PIMoveSetup(QMMMData,QMMMOpts);
     //Initialize local variables
-    sumE = 0; //Average energy
-    sumE2 = 0; //Average squared energy
-    denAvg = 0; //Average density
-    LxAvg = 0; //Average box length
-    LyAvg = 0; //Average box length
-    LzAvg = 0; //Average box length
+    BlockStats EStats; //Statistics for the total energy
+    BlockStats denStats; //Statistics for the density
+    BlockStats LxStats; //Statistics for the box length
+    BlockStats LyStats; //Statistics for the box length
+    BlockStats LzStats; //Statistics for the box length
+    BlockStats accStats; //Statistics for the acceptance ratio
+    vector<BlockStats> springStats(QMMMOpts.NBeads); //Bead spring energies
     Ek = 0; //PIMC kinietic energy
     if (QMMMOpts.NBeads > 1)
     {
@@ -661,53 +779,33 @@ int main(int argc, char* argv[])
     QMMMOpts.EOld = 0;
     QMMMOpts.EOld += Get_PI_Epot(QMMMData,QMMMOpts);
     QMMMOpts.EOld += Get_PI_Espring(QMMMData,QMMMOpts);
-    if (volProb > 0)
+    if (QMMMOpts.ensemble == "NPT")
     {
       //Add PV term
       QMMMOpts.EOld += QMMMOpts.press*Lx*Ly*Lz;
     }
+    if (QMMMOpts.MCScreenFunc != "N/A")
+    {
+      //Initial screening energy for delayed acceptance
+      QMMMOpts.EScreen = Get_PI_Escreen(QMMMData,QMMMOpts);
+    }
     Emc = QMMMOpts.EOld; //Needed if equilibration is skipped
     Nct = 0; //Reset counter to zero
     while (Nct < QMMMOpts.NEq)
     {
       Emc = 0;
-      //Check step size
+      //Check step sizes
       if(ct == acc_Check)
       {
-        if ((Nacc/(Nrej+Nacc)) > QMMMOpts.accRatio)
-        {
-          //Increase step size
-          double randVal; //Use random values to keep from cycling up and down
-          randVal = (((double)rand())/((double)RAND_MAX));
-          randVal /= 10.0;
-          mcStep *= 1.001+randVal;
-        }
-        if ((Nacc/(Nrej+Nacc)) < QMMMOpts.accRatio)
-        {
-          //Decrease step size
-          double randVal; //Use random values to keep from cycling up and down
-          randVal = (((double)rand())/((double)RAND_MAX));
-          randVal /= 10.0;
-          mcStep *= 0.999-randVal;
-        }
-        if (mcStep < stepMin)
-        {
-          //Set to minimum
-          mcStep = stepMin;
-        }
-        if (mcStep > stepMax)
-        {
-          //Set to maximum
-          mcStep = stepMax;
-        }
         //Statistics
         cout << " | Step: " << setw(simCharLen) << Nct;
-        cout << " | Step size: ";
-        cout << LICHEMFormFloat(mcStep,6);
         cout << " | Accept ratio: ";
         cout << LICHEMFormFloat((Nacc/(Nrej+Nacc)),6);
         cout << '\n';
+        PIPrintMoves(QMMMOpts,0);
         cout.flush(); //Print stats
+        //Adjust the step size of each move type
+        QMMMOpts.MCMoves.adaptSteps(QMMMOpts.accRatio,QMMMOpts.MCStream);
         //Reset counters
         ct = 0;
         Nacc = 0;
@@ -731,6 +829,10 @@ int main(int argc, char* argv[])
     Nct = 0; //Reset counter to zero
     Nacc = 0; //Reset counter to zero
     Nrej = 0; //Reset counter to zero
+    NScreenTry = 0; //Reset counter to zero
+    NScreenPass = 0; //Reset counter to zero
+    NScreenAcc = 0; //Reset counter to zero
+    QMMMOpts.MCMoves.resetStats(); //Reset counters to zero
     cout << '\n';
     cout << "Monte Carlo production:" << '\n';
     cout.flush();
@@ -757,15 +859,20 @@ int main(int argc, char* argv[])
       Emc = 0; //Set energy to zero
       acc = MCMove(QMMMData,QMMMOpts,Emc);
       //Update averages
+      VectorXd EBeads = Get_PI_BeadEspring(QMMMData,QMMMOpts); //Springs
       Et = 0;
       Et += Ek+Emc;
-      Et -= 2*Get_PI_Espring(QMMMData,QMMMOpts);
-      denAvg += LICHEMDensity(QMMMData,QMMMOpts);
-      LxAvg += Lx;
-      LyAvg += Ly;
-      LzAvg += Lz;
-      sumE += Et;
-      sumE2 += Et*Et;
+      Et -= 2*EBeads.sum();
+      EStats.add(Et);
+      denStats.add(LICHEMDensity(QMMMData,QMMMOpts));
+      LxStats.add(Lx);
+      LyStats.add(Ly);
+      LzStats.add(Lz);
+      accStats.add((double)acc);
+      for (int p=0;p<QMMMOpts.NBeads;p++)
+      {
+        springStats[p].add(EBeads(p));
+      }
       //Update counters and print output
       if (acc)
       {
@@ -789,7 +896,22 @@ int main(int argc, char* argv[])
             cout << " g/cm\u00B3";
           }
           cout << '\n';
+          //Print the running average and error bar
+          cout << "   Average energy: ";
+          cout << LICHEMFormFloat(EStats.mean(),12);
+          cout << " +/- " << LICHEMFormFloat(EStats.stdErr(),8) << " eV";
+          cout << " | Correlation time: ";
+          cout << LICHEMFormFloat(EStats.corrTime(),8);
+          cout << '\n';
           cout.flush(); //Print results
+          //Check if the error bar is small enough to stop
+          if ((QMMMOpts.MCTargetErr > 0) && EStats.converged() &&
+             (EStats.stdErr() <= QMMMOpts.MCTargetErr))
+          {
+            cout << " Target error bar reached." << '\n';
+            cout.flush();
+            break;
+          }
         }
       }
       else
@@ -802,12 +924,6 @@ int main(int argc, char* argv[])
       //Print final geometry if it was not already written
       Print_traj(QMMMData,outFile,QMMMOpts);
     }
-    sumE /= Nrej+Nacc; //Average energy
-    sumE2 /= Nrej+Nacc; //Variance of the energy
-    denAvg /= Nrej+Nacc; //Average density
-    LxAvg /= Nrej+Nacc; //Average box size
-    LyAvg /= Nrej+Nacc; //Average box size
-    LzAvg /= Nrej+Nacc; //Average box size
     //Print simulation details and statistics
     cout << '\n';
     if (QMMMOpts.NBeads > 1)
@@ -819,27 +935,66 @@ int main(int argc, char* argv[])
     {
       //Print simulation box information
       cout << " | Density: ";
-      cout << LICHEMFormFloat(denAvg,8);
+      cout << LICHEMFormFloat(denStats.mean(),8);
+      cout << " +/- " << LICHEMFormFloat(denStats.stdErr(),6);
       cout << " g/cm\u00B3" << '\n';
       cout << " | Average box size (\u212B): " << '\n';
-      cout << "  "; //Indent
-      cout << " Lx = " << LICHEMFormFloat(LxAvg,12);
-      cout << " Ly = " << LICHEMFormFloat(LyAvg,12);
-      cout << " Lz = " << LICHEMFormFloat(LzAvg,12);
-      cout << '\n';
+      cout << "   Lx = " << LICHEMFormFloat(LxStats.mean(),12);
+      cout << " +/- " << LICHEMFormFloat(LxStats.stdErr(),6) << '\n';
+      cout << "   Ly = " << LICHEMFormFloat(LyStats.mean(),12);
+      cout << " +/- " << LICHEMFormFloat(LyStats.stdErr(),6) << '\n';
+      cout << "   Lz = " << LICHEMFormFloat(LzStats.mean(),12);
+      cout << " +/- " << LICHEMFormFloat(LzStats.stdErr(),6) << '\n';
     }
     cout << " | Average energy: ";
-    cout << LICHEMFormFloat(sumE,16);
+    cout << LICHEMFormFloat(EStats.mean(),16);
+    cout << " +/- " << LICHEMFormFloat(EStats.stdErr(),8);
     cout << " eV | Variance: ";
-    cout << LICHEMFormFloat((sumE2-(sumE*sumE)),12);
+    cout << LICHEMFormFloat(EStats.variance(),12);
     cout << " eV\u00B2";
     cout << '\n';
+    cout << " | Correlation time: ";
+    cout << LICHEMFormFloat(EStats.corrTime(),8) << " moves";
+    if (!EStats.converged())
+    {
+      //The blocking analysis needs more data
+      cout << " (error bar not converged)";
+    }
+    cout << '\n';
+    if (QMMMOpts.NBeads > 1)
+    {
+      //Print the spring energy of each bead
+      cout << " | Average bead spring energies (eV): " << '\n';
+      for (int p=0;p<QMMMOpts.NBeads;p++)
+      {
+        cout << "   Bead " << setw(LICHEMCount(QMMMOpts.NBeads)) << p;
+        cout << ": " << LICHEMFormFloat(springStats[p].mean(),12);
+        cout << " +/- " << LICHEMFormFloat(springStats[p].stdErr(),8);
+        cout << '\n';
+      }
+    }
     cout << " | Acceptance ratio: ";
-    cout << LICHEMFormFloat((Nacc/(Nrej+Nacc)),6);
-    cout << " | Optimized step size: ";
-    cout << LICHEMFormFloat(mcStep,6);
-    cout << " \u212B";
+    cout << LICHEMFormFloat(accStats.mean(),6);
+    cout << " +/- " << LICHEMFormFloat(accStats.stdErr(),6);
     cout << '\n';
+    cout << " | Optimized moves: " << '\n';
+    PIPrintMoves(QMMMOpts,1);
+    if (NScreenTry > 0)
+    {
+      //Print delayed acceptance statistics
+      cout << " | Screening acceptance: ";
+      cout << LICHEMFormFloat((NScreenPass/NScreenTry),6);
+      cout << " | Second stage acceptance: ";
+      if (NScreenPass > 0)
+      {
+        cout << LICHEMFormFloat((NScreenAcc/NScreenPass),6);
+      }
+      else
+      {
+        cout << "N/A";
+      }
+      cout << '\n';
+    }
     cout << '\n';
     cout.flush();
   }
@@ -893,7 +1048,7 @@ int main(int argc, char* argv[])
         {
           //Increase step size
           double randVal; //Use random values to keep from cycling up and down
-          randVal = (((double)rand())/((double)RAND_MAX));
+          randVal = randGen.uniform();
           randVal /= 10.0;
           mcStep *= 1.001+randVal;
         }
@@ -901,7 +1056,7 @@ int main(int argc, char* argv[])
         {
           //Decrease step size
           double randVal; //Use random values to keep from cycling up and down
-          randVal = (((double)rand())/((double)RAND_MAX));
+          randVal = randGen.uniform();
           randVal /= 10.0;
           mcStep *= 0.999-randVal;
         }
@@ -1050,9 +1205,27 @@ int main(int argc, char* argv[])
     {
       QMMMOpts.MMOptTol = 0.25; //Speedy convergance on the first step
     }
+    //Start at the lower level of theory
+    bool preOpt = 0; //Flag for the pre-optimization of the path
+    string targFunc = QMMMOpts.func; //Target QM method
+    string targBasis = QMMMOpts.basis; //Target basis set
+    if (QMMMOpts.NEBPreFunc != "N/A")
+    {
+      preOpt = 1;
+      QMMMOpts.func = QMMMOpts.NEBPreFunc;
+      if (QMMMOpts.NEBPreBasis != "N/A")
+      {
+        QMMMOpts.basis = QMMMOpts.NEBPreBasis;
+      }
+    }
     //Print initial structure
     Print_traj(QMMMData,outFile,QMMMOpts);
     cout << "Nudged elastic band optimization:" << '\n';
+    if (preOpt)
+    {
+      cout << " | Pre-optimizing the path at the lower level of theory.";
+      cout << '\n' << '\n';
+    }
     if (QMMMOpts.climb)
     {
       cout << " | Short path detected. Starting climbing image NEB.";
@@ -1064,33 +1237,17 @@ int main(int argc, char* argv[])
     //Calculate reaction coordinate positions
     VectorXd reactCoord(QMMMOpts.NBeads); //Reaction coordinate
     reactCoord.setZero();
+    //Align neighboring replicas
+    vector<VectorXd> pathDistNext; //Displacements to p+1
+    vector<VectorXd> pathDistPrev; //Displacements to p-1
+    KabschPathDisplacement(QMMMData,QMMMOpts,pathDistNext,pathDistPrev);
     for (int p=0;p<(QMMMOpts.NBeads-1);p++)
     {
-      MatrixXd geom1((Nqm+Npseudo),3); //Current replica
-      MatrixXd geom2((Nqm+Npseudo),3); //Next replica
       VectorXd disp; //Store the displacement
-      //Save geometries
-      int ct = 0; //Reset counter for the number of atoms
-      for (int i=0;i<Natoms;i++)
-      {
-        //Only include QM and PB regions
-        if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
-        {
-          //Save current replica
-          geom1(ct,0) = QMMMData[i].P[p].x;
-          geom1(ct,1) = QMMMData[i].P[p].y;
-          geom1(ct,2) = QMMMData[i].P[p].z;
-          //Save replica p+1
-          geom2(ct,0) = QMMMData[i].P[p+1].x;
-          geom2(ct,1) = QMMMData[i].P[p+1].y;
-          geom2(ct,2) = QMMMData[i].P[p+1].z;
-          ct += 1;
-        }
-      }
       //Calculate displacement
-      disp = KabschDisplacement(geom1,geom2,(Nqm+Npseudo));
+      disp = pathDistNext[p];
       //Remove inactive atoms
-      ct = 0; //Reset counter for the number of atoms
+      int ct = 0; //Counter for the number of atoms
       for (int i=0;i<Natoms;i++)
       {
         //Only include QM and PB regions
@@ -1117,41 +1274,8 @@ int main(int argc, char* argv[])
     QMMMOpts.ETrans = -1*hugeNum; //Locate the initial transition state
     for (int p=0;p<QMMMOpts.NBeads;p++)
     {
-      sumE = 0; //Clear old energies
-      //Calculate QM energy
-      if (Gaussian)
-      {
-        int tStart = (unsigned)time(0);
-        sumE += GaussianEnergy(QMMMData,QMMMOpts,p);
-        QMTime += (unsigned)time(0)-tStart;
-      }
-      if (PSI4)
-      {
-        int tStart = (unsigned)time(0);
-        sumE += PSI4Energy(QMMMData,QMMMOpts,p);
-        QMTime += (unsigned)time(0)-tStart;
-        //Delete annoying useless files
-        globalSys = system("rm -f psi.* timer.*");
-      }
-      if (NWChem)
-      {
-        int tStart = (unsigned)time(0);
-        sumE += NWChemEnergy(QMMMData,QMMMOpts,p);
-        QMTime += (unsigned)time(0)-tStart;
-      }
-      //Calculate MM energy
-      if (TINKER)
-      {
-        int tStart = (unsigned)time(0);
-        sumE += TINKEREnergy(QMMMData,QMMMOpts,p);
-        MMTime += (unsigned)time(0)-tStart;
-      }
-      if (LAMMPS)
-      {
-        int tStart = (unsigned)time(0);
-        sumE += LAMMPSEnergy(QMMMData,QMMMOpts,p);
-        MMTime += (unsigned)time(0)-tStart;
-      }
+      //Calculate the QM and MM energy
+      sumE = LICHEMEnergy(QMMMData,QMMMOpts,p);
       if (p == 0)
       {
         //Save reactant energy
@@ -1239,10 +1363,21 @@ int main(int argc, char* argv[])
       }
       cout << '\n';
       //Run QM optimization
-      LICHEMNEB(QMMMData,QMMMOpts,optCt);
+      if (QMMMOpts.NEBSurrogate)
+      {
+        LICHEMGPNEB(QMMMData,QMMMOpts);
+      }
+      else
+      {
+        LICHEMNEB(QMMMData,QMMMOpts,optCt);
+      }
       //Reset tolerance before optimization check
-      QMMMOpts.QMOptTol = savedQMOptTol;
-      QMMMOpts.MMOptTol = savedMMOptTol;
+      if (!preOpt)
+      {
+        //The lower level path only needs the loose tolerance
+        QMMMOpts.QMOptTol = savedQMOptTol;
+        QMMMOpts.MMOptTol = savedMMOptTol;
+      }
       //Print optimized geometry
       Print_traj(QMMMData,outFile,QMMMOpts);
       //Check convergence
@@ -1254,6 +1389,56 @@ int main(int argc, char* argv[])
         //Avoid terminating restarts on the loose tolerance step
         pathDone = 0; //Not converged
       }
+      if (pathDone && preOpt)
+      {
+        //Restart from the converged path at the target level of theory
+        preOpt = 0;
+        pathDone = 0;
+        QMMMOpts.QMOptTol = savedQMOptTol;
+        QMMMOpts.MMOptTol = savedMMOptTol;
+        if (QMMMOpts.basis != targBasis)
+        {
+          //PSI4 and NWChem orbitals cannot be read in a new basis set
+          globalSys = system("rm -f LICHM_*.180 LICHM_*.movecs");
+        }
+        QMMMOpts.func = targFunc;
+        QMMMOpts.basis = targBasis;
+        cout << '\n';
+        cout << "Lower level path converged. Restarting at the target";
+        cout << " level of theory:";
+        cout << '\n';
+        cout.flush(); //Print progress
+        //Update the energies of the path
+        QMMMOpts.ETrans = -1*hugeNum;
+        for (int p=0;p<QMMMOpts.NBeads;p++)
+        {
+          sumE = LICHEMEnergy(QMMMData,QMMMOpts,p);
+          if (p == 0)
+          {
+            //Save reactant energy
+            QMMMOpts.EReact = sumE;
+          }
+          else if (p == (QMMMOpts.NBeads-1))
+          {
+            //Save product energy
+            QMMMOpts.EProd = sumE;
+          }
+          cout << "   Bead: ";
+          cout << setw(LICHEMCount(QMMMOpts.NBeads)) << p;
+          cout << " | Energy: ";
+          cout << LICHEMFormFloat(sumE,16) << " eV";
+          cout << '\n';
+          cout.flush(); //Print progress
+          //Update transition state
+          if (sumE > QMMMOpts.ETrans)
+          {
+            //Save new properties
+            QMMMOpts.TSBead = p;
+            QMMMOpts.ETrans = sumE;
+          }
+        }
+        cout << '\n';
+      }
     }
     BurstTraj(QMMMData,QMMMOpts);
     cout << '\n';
@@ -1294,39 +1479,47 @@ int main(int argc, char* argv[])
       //Calculate QMMM frequencies
       QMMMHess.setZero(); //Reset Hessian
       QMMMFreqs.setZero(); //Reset frequencies
-      //Calculate QM Hessian
-      if (Gaussian)
+      if (QMMMOpts.numHess)
       {
-        int tStart = (unsigned)time(0);
-        QMMMHess += GaussianHessian(QMMMData,QMMMOpts,QMMMOpts.TSBead);
-        QMTime += (unsigned)time(0)-tStart;
+        //Calculate the Hessian from finite differences of the forces
+        QMMMHess = LICHEMFDHessian(QMMMData,QMMMOpts,QMMMOpts.TSBead);
       }
-      if (PSI4)
-      {
-        int tStart = (unsigned)time(0);
-        QMMMHess += PSI4Hessian(QMMMData,QMMMOpts,QMMMOpts.TSBead);
-        QMTime += (unsigned)time(0)-tStart;
-        //Delete annoying useless files
-        globalSys = system("rm -f psi.* timer.*");
-      }
-      if (NWChem)
-      {
-        int tStart = (unsigned)time(0);
-        QMMMHess += NWChemHessian(QMMMData,QMMMOpts,QMMMOpts.TSBead);
-        QMTime += (unsigned)time(0)-tStart;
-      }
-      //Calculate MM Hessian
-      if (TINKER)
-      {
-        int tStart = (unsigned)time(0);
-        QMMMHess += TINKERHessian(QMMMData,QMMMOpts,QMMMOpts.TSBead);
-        MMTime += (unsigned)time(0)-tStart;
-      }
-      if (LAMMPS)
+      else
       {
-        int tStart = (unsigned)time(0);
-        QMMMHess += LAMMPSHessian(QMMMData,QMMMOpts,QMMMOpts.TSBead);
-        MMTime += (unsigned)time(0)-tStart;
+        //Calculate QM Hessian
+        if (Gaussian)
+        {
+          int tStart = (unsigned)time(0);
+          QMMMHess += GaussianHessian(QMMMData,QMMMOpts,QMMMOpts.TSBead);
+          QMTime += (unsigned)time(0)-tStart;
+        }
+        if (PSI4)
+        {
+          int tStart = (unsigned)time(0);
+          QMMMHess += PSI4Hessian(QMMMData,QMMMOpts,QMMMOpts.TSBead);
+          QMTime += (unsigned)time(0)-tStart;
+          //Delete annoying useless files
+          globalSys = system("rm -f psi.* timer.*");
+        }
+        if (NWChem)
+        {
+          int tStart = (unsigned)time(0);
+          QMMMHess += NWChemHessian(QMMMData,QMMMOpts,QMMMOpts.TSBead);
+          QMTime += (unsigned)time(0)-tStart;
+        }
+        //Calculate MM Hessian
+        if (TINKER)
+        {
+          int tStart = (unsigned)time(0);
+          QMMMHess += TINKERHessian(QMMMData,QMMMOpts,QMMMOpts.TSBead);
+          MMTime += (unsigned)time(0)-tStart;
+        }
+        if (LAMMPS)
+        {
+          int tStart = (unsigned)time(0);
+          QMMMHess += LAMMPSHessian(QMMMData,QMMMOpts,QMMMOpts.TSBead);
+          MMTime += (unsigned)time(0)-tStart;
+        }
       }
       //Calculate frequencies
       QMMMFreqs = LICHEMFreq(QMMMData,QMMMHess,QMMMOpts,QMMMOpts.TSBead,remCt);
@@ -1367,6 +1560,165 @@ int main(int argc, char* argv[])
   }
   //End of section
 
+  //Dimer saddle point search
+  else if (DimerSim)
+  {
+    VectorXd forces; //Dummy array needed for convergence tests
+    int optCt = 0; //Counter for optimization steps
+    int Ndof = 3*(Nqm+Npseudo); //Number of QM and PB degrees of freedom
+    VectorXd dimerVec(Ndof); //Direction of the lowest curvature mode
+    //Change optimization tolerance for the first step
+    double savedQMOptTol = QMMMOpts.QMOptTol; //Save value from input
+    double savedMMOptTol = QMMMOpts.MMOptTol; //Save value from input
+    if (QMMMOpts.QMOptTol < 0.005)
+    {
+      QMMMOpts.QMOptTol = 0.005; //Speedy convergance on the first step
+    }
+    if (QMMMOpts.MMOptTol < 0.25)
+    {
+      QMMMOpts.MMOptTol = 0.25; //Speedy convergance on the first step
+    }
+    //Print initial structure
+    Print_traj(QMMMData,outFile,QMMMOpts);
+    cout << "Dimer saddle point search:" << '\n';
+    cout.flush(); //Print progress
+    //Calculate initial energies
+    QMMMOpts.ETrans = -1*hugeNum; //Locate the highest energy bead
+    for (int p=0;p<QMMMOpts.NBeads;p++)
+    {
+      sumE = 0; //Clear old energies
+      //Calculate QM energy
+      if (Gaussian)
+      {
+        int tStart = (unsigned)time(0);
+        sumE += GaussianEnergy(QMMMData,QMMMOpts,p);
+        QMTime += (unsigned)time(0)-tStart;
+      }
+      if (PSI4)
+      {
+        int tStart = (unsigned)time(0);
+        sumE += PSI4Energy(QMMMData,QMMMOpts,p);
+        QMTime += (unsigned)time(0)-tStart;
+        //Delete annoying useless files
+        globalSys = system("rm -f psi.* timer.*");
+      }
+      if (NWChem)
+      {
+        int tStart = (unsigned)time(0);
+        sumE += NWChemEnergy(QMMMData,QMMMOpts,p);
+        QMTime += (unsigned)time(0)-tStart;
+      }
+      //Calculate MM energy
+      if (TINKER)
+      {
+        int tStart = (unsigned)time(0);
+        sumE += TINKEREnergy(QMMMData,QMMMOpts,p);
+        MMTime += (unsigned)time(0)-tStart;
+      }
+      if (LAMMPS)
+      {
+        int tStart = (unsigned)time(0);
+        sumE += LAMMPSEnergy(QMMMData,QMMMOpts,p);
+        MMTime += (unsigned)time(0)-tStart;
+      }
+      if (QMMMOpts.NBeads > 1)
+      {
+        cout << "   Bead: ";
+        cout << setw(LICHEMCount(QMMMOpts.NBeads)) << p;
+        cout << " | Energy: ";
+        cout << LICHEMFormFloat(sumE,16) << " eV";
+        cout << '\n';
+        cout.flush(); //Print progress
+      }
+      //Update transition state guess
+      if (sumE > QMMMOpts.ETrans)
+      {
+        QMMMOpts.TSBead = p;
+        QMMMOpts.ETrans = sumE;
+      }
+    }
+    int bead = QMMMOpts.TSBead; //Replica used for the search
+    dimerVec.setZero();
+    if (QMMMOpts.NBeads > 1)
+    {
+      //Start along the path tangent at the highest energy bead
+      vector<VectorXd> pathDistNext; //Displacements to p+1
+      vector<VectorXd> pathDistPrev; //Displacements to p-1
+      KabschPathDisplacement(QMMMData,QMMMOpts,pathDistNext,pathDistPrev);
+      if (bead > 0)
+      {
+        dimerVec += pathDistPrev[bead];
+      }
+      if (bead < (QMMMOpts.NBeads-1))
+      {
+        dimerVec -= pathDistNext[bead];
+      }
+    }
+    if (dimerVec.norm() < (1e-12))
+    {
+      //Start from a random direction
+      for (int i=0;i<Ndof;i++)
+      {
+        double randNum = randGen.uniform();
+        dimerVec(i) = 2*(randNum-0.5);
+      }
+    }
+    dimerVec.normalize();
+    cout << " | Opt. step: ";
+    cout << optCt << " | Bead: " << bead << " | Energy: ";
+    cout << LICHEMFormFloat(QMMMOpts.ETrans,16) << " eV";
+    cout << '\n';
+    cout.flush(); //Print progress
+    //Run saddle point search
+    bool optDone = 0;
+    while (!optDone)
+    {
+      //Copy structure
+      OldQMMMData = QMMMData;
+      //Run MM optimization
+      if (TINKER)
+      {
+        int tStart = (unsigned)time(0);
+        sumE = TINKEROpt(QMMMData,QMMMOpts,bead);
+        MMTime += (unsigned)time(0)-tStart;
+      }
+      if (LAMMPS)
+      {
+        int tStart = (unsigned)time(0);
+        sumE = LAMMPSOpt(QMMMData,QMMMOpts,bead);
+        MMTime += (unsigned)time(0)-tStart;
+      }
+      if (QMMM)
+      {
+        cout << "    MM optimization complete.";
+        cout << '\n';
+        cout.flush();
+      }
+      cout << '\n';
+      //Run QM dimer search
+      LICHEMDimer(QMMMData,QMMMOpts,dimerVec,bead);
+      //Reset tolerance before optimization check
+      QMMMOpts.QMOptTol = savedQMOptTol;
+      QMMMOpts.MMOptTol = savedMMOptTol;
+      //Print Optimized geometry
+      Print_traj(QMMMData,outFile,QMMMOpts);
+      //Check convergence
+      optCt += 1;
+      optDone = OptConverged(QMMMData,OldQMMMData,forces,optCt,QMMMOpts,
+                             bead,0);
+      if (optCt == 1)
+      {
+        //Avoid terminating restarts on the loose tolerance step
+        optDone = 0; //Not converged
+      }
+    }
+    cout << '\n';
+    cout << "Saddle point search complete.";
+    cout << '\n' << '\n';
+    cout.flush();
+  }
+  //End of section
+
   //Inform the user if no simulations were performed
   else
   {
@@ -1461,7 +1813,7 @@ int main(int argc, char* argv[])
     string quote; //Random quote
     vector<string> Quotes; //Stores all possible quotes
     FetchQuotes(Quotes); //Fetch list of quotes
-    randNum = rand() % 1000; //Randomly pick 1 of 1000 quotes
+    randNum = randGen.integer(1000); //Randomly pick 1 of 1000 quotes
     cout << Quotes[randNum]; //Print quote
     cout << '\n';
   }
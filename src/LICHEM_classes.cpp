@@ -82,10 +82,361 @@ OctCharges::~OctCharges()
   return;
 };
 
+//RandomStreams class function definitions
+RandomStreams::RandomStreams()
+{
+  //Constructor
+  seed(0,1);
+  return;
+};
+
+RandomStreams::~RandomStreams()
+{
+  //Generic destructor
+  return;
+};
+
+void RandomStreams::philox_(unsigned int* ctr, unsigned int* key)
+{
+  /*
+    Philox4x32-10 block function. The output only depends on the counter
+    and the key, so every stream can be reproduced without saving a state.
+
+    Reference:
+    Salmon et al., Proc. Int. Conf. High Perform. Comput., 16, (2011)
+  */
+  const unsigned long long mult0 = 0xD2511F53ULL; //Round multiplier
+  const unsigned long long mult1 = 0xCD9E8D57ULL; //Round multiplier
+  const unsigned int weyl0 = 0x9E3779B9U; //Key schedule increment
+  const unsigned int weyl1 = 0xBB67AE85U; //Key schedule increment
+  unsigned int k0 = key[0]; //Round key
+  unsigned int k1 = key[1]; //Round key
+  for (int i=0;i<10;i++)
+  {
+    unsigned long long prod0 = mult0*ctr[0]; //64-bit product
+    unsigned long long prod1 = mult1*ctr[2]; //64-bit product
+    unsigned int hi0 = (unsigned int)(prod0 >> 32);
+    unsigned int lo0 = (unsigned int)(prod0 & 0xFFFFFFFFULL);
+    unsigned int hi1 = (unsigned int)(prod1 >> 32);
+    unsigned int lo1 = (unsigned int)(prod1 & 0xFFFFFFFFULL);
+    ctr[0] = hi1^ctr[1]^k0;
+    ctr[1] = lo1;
+    ctr[2] = hi0^ctr[3]^k1;
+    ctr[3] = lo0;
+    k0 += weyl0;
+    k1 += weyl1;
+  }
+  return;
+};
+
+void RandomStreams::block_(int s, unsigned int* rands)
+{
+  //Function to generate the next four random integers of a stream
+  unsigned int key[2]; //Key from the seed
+  key[0] = (unsigned int)(seed_ & 0xFFFFFFFFULL);
+  key[1] = (unsigned int)(seed_ >> 32);
+  //The counter holds the block, stream, and walker numbers
+  rands[0] = (unsigned int)(counter_[s] & 0xFFFFFFFFULL);
+  rands[1] = (unsigned int)(counter_[s] >> 32);
+  rands[2] = streamID_[s];
+  rands[3] = walker_[s];
+  philox_(rands,key);
+  counter_[s] += 1;
+  return;
+};
+
+void RandomStreams::seed(unsigned long long newSeed, int Nstreams)
+{
+  //Function to reset the generator with one stream per thread
+  seed_ = newSeed;
+  counter_.assign(Nstreams,0);
+  streamID_.resize(Nstreams);
+  for (int i=0;i<Nstreams;i++)
+  {
+    streamID_[i] = (unsigned int)i;
+  }
+  walker_.assign(Nstreams,0);
+  return;
+};
+
+int RandomStreams::addStream(unsigned int walker)
+{
+  /*
+    Function to create an independent stream for a walker. Walker streams
+    do not depend on the number of threads, so walkers numbered from one
+    are reproducible on any machine.
+  */
+  counter_.push_back(0);
+  streamID_.push_back(0xFFFFFFFFU);
+  walker_.push_back(walker);
+  return (int)(counter_.size()-1);
+};
+
+unsigned long long RandomStreams::getSeed()
+{
+  //Function to return the seed
+  return seed_;
+};
+
+double RandomStreams::uniform()
+{
+  //Function to draw a number from the stream of the current thread
+  return uniform(omp_get_thread_num());
+};
+
+double RandomStreams::uniform(int s)
+{
+  //Function to draw a uniform number with 53 random bits
+  if (s < 0)
+  {
+    //Use the stream of the current thread
+    s = omp_get_thread_num();
+  }
+  unsigned int rands[4]; //Random integers
+  block_(s,rands);
+  unsigned long long bits; //Random bits for the mantissa
+  bits = (((unsigned long long)rands[0]) << 21)^(rands[1] >> 11);
+  return ((double)bits)/9007199254740992.0; //Divide by 2^53
+};
+
+double RandomStreams::gauss()
+{
+  //Function to draw a number from the stream of the current thread
+  return gauss(omp_get_thread_num());
+};
+
+double RandomStreams::gauss(int s)
+{
+  //Function to draw a normal random number with the Box-Muller transform
+  double randU = 1-uniform(s); //Avoids log(0)
+  double randV = uniform(s);
+  return sqrt(-2*log(randU))*cos(2*pi*randV);
+};
+
+int RandomStreams::integer(int N)
+{
+  //Function to draw a number from the stream of the current thread
+  return integer(omp_get_thread_num(),N);
+};
+
+int RandomStreams::integer(int s, int N)
+{
+  //Function to draw a random integer between 0 and N-1
+  int val = (int)floor(uniform(s)*N);
+  if (val >= N)
+  {
+    //Safety check for rounding errors
+    val = N-1;
+  }
+  return val;
+};
+
+//BlockStats class function definitions
+BlockStats::BlockStats()
+{
+  //Constructor
+  reset();
+  return;
+};
+
+BlockStats::~BlockStats()
+{
+  //Generic destructor
+  return;
+};
+
+double BlockStats::levelErr_(int k)
+{
+  //Function to calculate the standard error assuming independent blocks
+  double n = count_[k]; //Number of blocks
+  if (n < 2)
+  {
+    return 0;
+  }
+  double avg = sum_[k]/n; //Average of the blocks
+  double var = (sum2_[k]/n)-(avg*avg); //Variance of the blocks
+  if (var < 0)
+  {
+    //Safety check for rounding errors
+    var = 0;
+  }
+  return sqrt(var/(n-1));
+};
+
+int BlockStats::optLevel_()
+{
+  /*
+    Function to find the smallest block size where the error estimate has
+    reached the plateau. The criterion from Lee, Needs, and Towler is
+    B^3 > 2N(err_B/err_0)^4, where B is the block size.
+  */
+  double err0 = levelErr_(0); //Error without blocking
+  if (err0 <= 0)
+  {
+    //No fluctuations
+    return 0;
+  }
+  for (unsigned int k=0;k<count_.size();k++)
+  {
+    if (count_[k] < 4)
+    {
+      //Too few blocks for a reliable error
+      break;
+    }
+    double blockSize = pow(2.0,(double)k); //Samples per block
+    double ratio = levelErr_(k)/err0; //Growth of the error
+    ratio *= ratio;
+    if ((blockSize*blockSize*blockSize) > (2*count_[0]*ratio*ratio))
+    {
+      return k;
+    }
+  }
+  return -1;
+};
+
+void BlockStats::reset()
+{
+  //Function to remove all samples
+  sum_.clear();
+  sum2_.clear();
+  count_.clear();
+  pending_.clear();
+  hasPending_.clear();
+  return;
+};
+
+void BlockStats::add(double val)
+{
+  //Function to add a sample and update the blocks at all levels
+  unsigned int k = 0; //Blocking level
+  while (1)
+  {
+    if (k == count_.size())
+    {
+      //Start a new level
+      sum_.push_back(0);
+      sum2_.push_back(0);
+      count_.push_back(0);
+      pending_.push_back(0);
+      hasPending_.push_back(0);
+    }
+    sum_[k] += val;
+    sum2_[k] += val*val;
+    count_[k] += 1;
+    if (!hasPending_[k])
+    {
+      //Wait for the next block at this level
+      pending_[k] = val;
+      hasPending_[k] = 1;
+      break;
+    }
+    //Combine the pair of blocks and move to the next level
+    val = 0.5*(pending_[k]+val);
+    hasPending_[k] = 0;
+    k += 1;
+  }
+  return;
+};
+
+double BlockStats::samples()
+{
+  //Function to return the number of samples
+  if (count_.size() == 0)
+  {
+    return 0;
+  }
+  return count_[0];
+};
+
+double BlockStats::mean()
+{
+  //Function to return the average of the samples
+  if (count_.size() == 0)
+  {
+    return 0;
+  }
+  return sum_[0]/count_[0];
+};
+
+double BlockStats::variance()
+{
+  //Function to return the variance of the samples
+  if (count_.size() == 0)
+  {
+    return 0;
+  }
+  double avg = sum_[0]/count_[0]; //Average of the samples
+  double var = (sum2_[0]/count_[0])-(avg*avg); //Variance
+  if (var < 0)
+  {
+    //Safety check for rounding errors
+    var = 0;
+  }
+  return var;
+};
+
+double BlockStats::stdErr()
+{
+  //Function to return the standard error of the mean
+  if (count_.size() == 0)
+  {
+    return 0;
+  }
+  int k = optLevel_(); //Optimal blocking level
+  if (k >= 0)
+  {
+    return levelErr_(k);
+  }
+  //No plateau, so use the largest error as a conservative estimate
+  double err = 0; //Largest error
+  for (unsigned int i=0;i<count_.size();i++)
+  {
+    if (count_[i] < 4)
+    {
+      break;
+    }
+    if (levelErr_(i) > err)
+    {
+      err = levelErr_(i);
+    }
+  }
+  return err;
+};
+
+double BlockStats::corrTime()
+{
+  //Function to estimate the integrated autocorrelation time
+  double err0 = 0; //Error without blocking
+  if (count_.size() > 0)
+  {
+    err0 = levelErr_(0);
+  }
+  if (err0 <= 0)
+  {
+    //Uncorrelated or no samples
+    return 0.5;
+  }
+  //The error of the mean grows by a factor of 2*tau
+  double ratio = stdErr()/err0; //Growth of the error
+  return 0.5*ratio*ratio;
+};
+
+bool BlockStats::converged()
+{
+  //Function to check if the error estimate has reached the plateau
+  if (count_.size() == 0)
+  {
+    return 0;
+  }
+  return (optLevel_() >= 0);
+};
+
 //GEMDen class function definitions
 GEMDen::GEMDen()
 {
   //Generic constructor
+  basID_ = -1; //No basis set
+  elemID_ = 0;
   return;
 };
 
@@ -105,7 +456,17 @@ GEMDen::~GEMDen()
 void GEMDen::setBasis(string typ, string basName)
 {
   //Set the basis set
-  dens_ = HermBasis(typ,basName);
+  basID_ = basisLib.basisID(basName);
+  elemID_ = chemTable.revTyping(typ);
+  //Check for errors
+  if (!basisLib.defined(basID_,elemID_))
+  {
+    cerr << "Error: Basis set " << basName;
+    cerr << " is not defined for atom " << typ;
+    cerr << "!!!" << '\n' << '\n';
+    cerr.flush();
+    exit(0);
+  }
   return;
 };
 
@@ -120,9 +481,16 @@ void GEMDen::setFrame(bool flip, string frame, int at1, int at2, int at3)
   return;
 };
 
+const vector<HermGau>& GEMDen::density()
+{
+  //Return the basis functions shared by all atoms of this element
+  return basisLib.getBasis(basID_,elemID_);
+};
+
 MPole GEMDen::GEMDM()
 {
   //Function to convert GEM density to distributed multipoles
+  const vector<HermGau>& dens = density(); //Shared basis functions
   MPole dmpole; //Blank set of multipoles
   //Save frame of reference
   dmpole.chiralFlip = chiralFlip_;
@@ -144,77 +512,77 @@ MPole GEMDen::GEMDM()
   dmpole.Qyy = 0;
   dmpole.Qxz = 0;
   dmpole.Qzz = 0;
-  //Add the nuclear charge from the periodic table
-  dmpole.q += chemTable.revTyping(type_);
+  //Add the nuclear charge (element ID is the atomic number)
+  dmpole.q += elemID_;
   //Convert Hermite Gaussians to multipoles
-  for (unsigned int i=0;i<dens_.size();i++)
+  for (unsigned int i=0;i<dens.size();i++)
   {
     //Check for a monopole
-    if ((dens_[i].xPow() == 0) && (dens_[i].yPow() == 0) &&
-       (dens_[i].zPow() == 0))
+    if ((dens[i].xPow() == 0) && (dens[i].yPow() == 0) &&
+       (dens[i].zPow() == 0))
     {
       //Update monopole
-      dmpole.q += dens_[i].coeff();
+      dmpole.q += dens[i].coeff();
       //Update diagonal quadrupole moments
-      dmpole.Qxx += dens_[i].coeff()/(2*dens_[i].getAlpha());
-      dmpole.Qyy += dens_[i].coeff()/(2*dens_[i].getAlpha());
-      dmpole.Qzz += dens_[i].coeff()/(2*dens_[i].getAlpha());
+      dmpole.Qxx += dens[i].coeff()/(2*dens[i].getAlpha());
+      dmpole.Qyy += dens[i].coeff()/(2*dens[i].getAlpha());
+      dmpole.Qzz += dens[i].coeff()/(2*dens[i].getAlpha());
     }
     //Check for a dipole
-    if ((dens_[i].xPow() == 1) && (dens_[i].yPow() == 0) &&
-       (dens_[i].zPow() == 0))
+    if ((dens[i].xPow() == 1) && (dens[i].yPow() == 0) &&
+       (dens[i].zPow() == 0))
     {
       //Update x dipole
-      dmpole.Dx += dens_[i].coeff();
+      dmpole.Dx += dens[i].coeff();
     }
-    if ((dens_[i].xPow() == 0) && (dens_[i].yPow() == 1) &&
-       (dens_[i].zPow() == 0))
+    if ((dens[i].xPow() == 0) && (dens[i].yPow() == 1) &&
+       (dens[i].zPow() == 0))
     {
       //Update y dipole
-      dmpole.Dy += dens_[i].coeff();
+      dmpole.Dy += dens[i].coeff();
     }
-    if ((dens_[i].xPow() == 0) && (dens_[i].yPow() == 0) &&
-       (dens_[i].zPow() == 1))
+    if ((dens[i].xPow() == 0) && (dens[i].yPow() == 0) &&
+       (dens[i].zPow() == 1))
     {
       //Update z dipole
-      dmpole.Dz += dens_[i].coeff();
+      dmpole.Dz += dens[i].coeff();
     }
     //Check for a quadrupole
-    if ((dens_[i].xPow() == 2) && (dens_[i].yPow() == 0) &&
-       (dens_[i].zPow() == 0))
+    if ((dens[i].xPow() == 2) && (dens[i].yPow() == 0) &&
+       (dens[i].zPow() == 0))
     {
       //Update xx quadrupole
-      dmpole.Qxx += 2*dens_[i].coeff();
+      dmpole.Qxx += 2*dens[i].coeff();
     }
-    if ((dens_[i].xPow() == 1) && (dens_[i].yPow() == 1) &&
-       (dens_[i].zPow() == 0))
+    if ((dens[i].xPow() == 1) && (dens[i].yPow() == 1) &&
+       (dens[i].zPow() == 0))
     {
       //Update xy quadrupole
-      dmpole.Qxy += dens_[i].coeff();
+      dmpole.Qxy += dens[i].coeff();
     }
-    if ((dens_[i].xPow() == 1) && (dens_[i].yPow() == 0) &&
-       (dens_[i].zPow() == 1))
+    if ((dens[i].xPow() == 1) && (dens[i].yPow() == 0) &&
+       (dens[i].zPow() == 1))
     {
       //Update xz quadrupole
-      dmpole.Qxz += dens_[i].coeff();
+      dmpole.Qxz += dens[i].coeff();
     }
-    if ((dens_[i].xPow() == 0) && (dens_[i].yPow() == 2) &&
-       (dens_[i].zPow() == 0))
+    if ((dens[i].xPow() == 0) && (dens[i].yPow() == 2) &&
+       (dens[i].zPow() == 0))
     {
       //Update xx quadrupole
-      dmpole.Qyy += 2*dens_[i].coeff();
+      dmpole.Qyy += 2*dens[i].coeff();
     }
-    if ((dens_[i].xPow() == 0) && (dens_[i].yPow() == 1) &&
-       (dens_[i].zPow() == 1))
+    if ((dens[i].xPow() == 0) && (dens[i].yPow() == 1) &&
+       (dens[i].zPow() == 1))
     {
       //Update yz quadrupole
-      dmpole.Qyz += dens_[i].coeff();
+      dmpole.Qyz += dens[i].coeff();
     }
-    if ((dens_[i].xPow() == 0) && (dens_[i].yPow() == 0) &&
-       (dens_[i].zPow() == 2))
+    if ((dens[i].xPow() == 0) && (dens[i].yPow() == 0) &&
+       (dens[i].zPow() == 2))
     {
       //Update yz quadrupole
-      dmpole.Qzz += 2*dens_[i].coeff();
+      dmpole.Qzz += 2*dens[i].coeff();
     }
   }
   //Convert to a traceless quadrupole
@@ -226,6 +594,311 @@ MPole GEMDen::GEMDM()
   return dmpole;
 };
 
+vector<HermGau> GEMDen::placeDensity(Coord& atPos, Vector3d& vecX,
+                                     Vector3d& vecY, Vector3d& vecZ)
+{
+  //Function to rotate the density into the local frame of an atom and
+  //translate it to the position of the atom
+  //NB: Hermite Gaussians are derivatives with respect to the center, so
+  //each derivative rotates like a vector
+  const vector<HermGau>& dens = density(); //Shared basis functions
+  vector<HermGau> newDens; //Density at the new position
+  Matrix3d frame; //Local axes in the global frame
+  frame.col(0) = vecX;
+  frame.col(1) = vecY;
+  frame.col(2) = vecZ;
+  for (unsigned int i=0;i<dens.size();i++)
+  {
+    int order = dens[i].xPow()+dens[i].yPow()+dens[i].zPow(); //Total order
+    int Nw = order+1; //Width of the coefficient table
+    vector<int> locAxes; //Local axis of each derivative
+    locAxes.insert(locAxes.end(),dens[i].xPow(),0);
+    locAxes.insert(locAxes.end(),dens[i].yPow(),1);
+    locAxes.insert(locAxes.end(),dens[i].zPow(),2);
+    //Coefficients of the global Hermite orders, indexed as (t*Nw+u)*Nw+v
+    vector<double> coeffs(Nw*Nw*Nw,0.0);
+    coeffs[0] = dens[i].coeff();
+    for (int k=0;k<order;k++)
+    {
+      //Rotate one derivative at a time
+      vector<double> newCoeffs(Nw*Nw*Nw,0.0);
+      int a = locAxes[k]; //Local axis of the derivative
+      for (int t=0;t<=k;t++)
+      {
+        for (int u=0;u<=(k-t);u++)
+        {
+          int v = k-t-u; //Remaining order
+          double c = coeffs[(t*Nw+u)*Nw+v]; //Current coefficient
+          if (c != 0)
+          {
+            newCoeffs[((t+1)*Nw+u)*Nw+v] += c*frame(0,a);
+            newCoeffs[(t*Nw+u+1)*Nw+v] += c*frame(1,a);
+            newCoeffs[(t*Nw+u)*Nw+v+1] += c*frame(2,a);
+          }
+        }
+      }
+      coeffs = newCoeffs;
+    }
+    //Rotate the offset from the atom
+    Vector3d locPos; //Offset in the local frame
+    locPos(0) = dens[i].xPos();
+    locPos(1) = dens[i].yPos();
+    locPos(2) = dens[i].zPos();
+    Vector3d globPos = frame*locPos; //Offset in the global frame
+    double xNew = atPos.x+globPos(0); //New x position
+    double yNew = atPos.y+globPos(1); //New y position
+    double zNew = atPos.z+globPos(2); //New z position
+    for (int t=0;t<=order;t++)
+    {
+      for (int u=0;u<=(order-t);u++)
+      {
+        int v = order-t-u; //Remaining order
+        double c = coeffs[(t*Nw+u)*Nw+v]; //Rotated coefficient
+        if (c != 0)
+        {
+          //Copy the Hermite Gaussian with the new center and order
+          HermGau tmp(c,dens[i].getAlpha(),t,u,v,xNew,yNew,zNew);
+          newDens.push_back(tmp);
+        }
+      }
+    }
+  }
+  //Return rotated and translated density
+  return newDens;
+};
+
+//GPModel class function definitions
+GPModel::GPModel()
+{
+  //Constructor
+  lenScale_ = 1.0;
+  sigma2_ = 1.0;
+  prior_ = 0.0;
+  jitter_ = 1e-8;
+  trained_ = 0;
+  return;
+};
+
+GPModel::~GPModel()
+{
+  //Generic destructor
+  return;
+};
+
+void GPModel::addPoint(VectorXd& pos, double E, VectorXd& forces)
+{
+  //Function to add a structure to the training data
+  pos_.push_back(pos);
+  energy_.push_back(E);
+  grad_.push_back(-1*forces);
+  trained_ = 0; //The weights are out of date
+  return;
+};
+
+void GPModel::clear()
+{
+  //Function to remove all training data
+  pos_.clear();
+  energy_.clear();
+  grad_.clear();
+  trained_ = 0;
+  return;
+};
+
+int GPModel::size()
+{
+  //Return the number of training structures
+  return (int)pos_.size();
+};
+
+double GPModel::getLength()
+{
+  //Return the length scale
+  return lenScale_;
+};
+
+void GPModel::buildCov_(MatrixXd& covMat, double lenScale)
+{
+  //Function to calculate the covariance of the energies and gradients
+  //NB: The signal variance is factored out of the matrix
+  int Npts = (int)pos_.size(); //Number of training structures
+  int Ndim = (int)pos_[0].size(); //Number of coordinates
+  int blockSize = Ndim+1; //Energy and gradient observations
+  double invL2 = 1/(lenScale*lenScale); //Inverse squared length scale
+  covMat.resize(Npts*blockSize,Npts*blockSize);
+  #pragma omp parallel for schedule(dynamic)
+  for (int i=0;i<Npts;i++)
+  {
+    for (int j=0;j<=i;j++)
+    {
+      //Derivatives of the squared exponential kernel
+      VectorXd dist = pos_[i]-pos_[j]; //Displacement
+      double kij = exp(-0.5*invL2*dist.squaredNorm()); //Kernel
+      MatrixXd block(blockSize,blockSize); //Covariance of the pair
+      block(0,0) = kij;
+      block.block(0,1,1,Ndim) = (kij*invL2)*dist.transpose();
+      block.block(1,0,Ndim,1) = (-1*kij*invL2)*dist;
+      block.block(1,1,Ndim,Ndim) = dist*dist.transpose();
+      block.block(1,1,Ndim,Ndim) *= -1*kij*invL2*invL2;
+      block.block(1,1,Ndim,Ndim).diagonal().array() += kij*invL2;
+      covMat.block(i*blockSize,j*blockSize,blockSize,blockSize) = block;
+      if (i != j)
+      {
+        //Copy to the upper triangle
+        covMat.block(j*blockSize,i*blockSize,blockSize,blockSize) =
+               block.transpose();
+      }
+    }
+  }
+  //Add noise to stabilize the factorization
+  for (int i=0;i<Npts;i++)
+  {
+    covMat(i*blockSize,i*blockSize) += jitter_;
+    for (int k=1;k<blockSize;k++)
+    {
+      covMat(i*blockSize+k,i*blockSize+k) += jitter_*invL2;
+    }
+  }
+  return;
+};
+
+bool GPModel::train()
+{
+  //Function to select the length scale from the marginal likelihood
+  trained_ = 0;
+  if (pos_.size() == 0)
+  {
+    //Nothing to fit
+    return trained_;
+  }
+  int Npts = (int)pos_.size(); //Number of training structures
+  int Ndim = (int)pos_[0].size(); //Number of coordinates
+  int blockSize = Ndim+1; //Energy and gradient observations
+  int Nobs = Npts*blockSize; //Total number of observations
+  double lenList[7] = {0.25,0.4,0.6,1.0,1.6,2.5,4.0}; //Length scales
+  //Use the highest energy as the prior to keep the path near the data
+  prior_ = energy_[0];
+  for (int i=1;i<Npts;i++)
+  {
+    if (energy_[i] > prior_)
+    {
+      prior_ = energy_[i];
+    }
+  }
+  VectorXd obs(Nobs); //Observations relative to the prior
+  for (int i=0;i<Npts;i++)
+  {
+    obs(i*blockSize) = energy_[i]-prior_;
+    obs.segment(i*blockSize+1,Ndim) = grad_[i];
+  }
+  //Search the length scales
+  jitter_ = 1e-8;
+  while ((!trained_) && (jitter_ < 1e-2))
+  {
+    double bestML = -1*hugeNum; //Best log marginal likelihood
+    for (int k=0;k<7;k++)
+    {
+      MatrixXd covMat; //Covariance matrix
+      buildCov_(covMat,lenList[k]);
+      LLT<MatrixXd> cholTmp(covMat); //Cholesky factorization
+      if (cholTmp.info() != Success)
+      {
+        //Skip ill-conditioned matrices
+        continue;
+      }
+      VectorXd alphaTmp = cholTmp.solve(obs); //Weights
+      //Maximum likelihood estimate of the signal variance
+      double sig2 = obs.dot(alphaTmp)/Nobs;
+      if (sig2 < (1e-12))
+      {
+        sig2 = 1e-12;
+      }
+      double logML = -0.5*Nobs*log(sig2); //Log marginal likelihood
+      for (int i=0;i<Nobs;i++)
+      {
+        logML -= log(cholTmp.matrixLLT()(i,i));
+      }
+      if (logML > bestML)
+      {
+        //Save the model
+        bestML = logML;
+        lenScale_ = lenList[k];
+        sigma2_ = sig2;
+        alpha_ = alphaTmp;
+        chol_ = cholTmp;
+        trained_ = 1;
+      }
+    }
+    if (!trained_)
+    {
+      //Increase the noise if all factorizations failed
+      jitter_ *= 100;
+    }
+  }
+  if (!trained_)
+  {
+    //Remove the stale fit
+    alpha_.resize(0);
+  }
+  return trained_;
+};
+
+double GPModel::predict(VectorXd& pos, VectorXd& forces)
+{
+  //Function to calculate the posterior mean energy and forces
+  int Npts = (int)pos_.size(); //Number of training structures
+  int Ndim = (int)pos.size(); //Number of coordinates
+  int blockSize = Ndim+1; //Energy and gradient observations
+  double invL2 = 1/(lenScale_*lenScale_); //Inverse squared length scale
+  double E = prior_; //Energy
+  forces.setZero(Ndim);
+  if (!trained_)
+  {
+    //Only the prior is available
+    return E;
+  }
+  for (int i=0;i<Npts;i++)
+  {
+    VectorXd dist = pos-pos_[i]; //Displacement from the training point
+    double ki = exp(-0.5*invL2*dist.squaredNorm()); //Kernel
+    double alphaE = alpha_(i*blockSize); //Energy weight
+    double distDotG = dist.dot(alpha_.segment(i*blockSize+1,Ndim));
+    E += ki*(alphaE+invL2*distDotG);
+    forces -= (ki*invL2)*alpha_.segment(i*blockSize+1,Ndim);
+    forces += (ki*invL2*(alphaE+invL2*distDotG))*dist;
+  }
+  return E;
+};
+
+double GPModel::variance(VectorXd& pos)
+{
+  //Function to calculate the posterior variance of the energy
+  int Npts = (int)pos_.size(); //Number of training structures
+  int Ndim = (int)pos.size(); //Number of coordinates
+  int blockSize = Ndim+1; //Energy and gradient observations
+  double invL2 = 1/(lenScale_*lenScale_); //Inverse squared length scale
+  if (!trained_)
+  {
+    //Nothing is known about the surface
+    return hugeNum;
+  }
+  VectorXd crossCov(Npts*blockSize); //Covariance with the observations
+  for (int i=0;i<Npts;i++)
+  {
+    VectorXd dist = pos-pos_[i]; //Displacement from the training point
+    double ki = exp(-0.5*invL2*dist.squaredNorm()); //Kernel
+    crossCov(i*blockSize) = ki;
+    crossCov.segment(i*blockSize+1,Ndim) = (ki*invL2)*dist;
+  }
+  VectorXd tmp = chol_.matrixL().solve(crossCov); //Whitened covariance
+  double var = sigma2_*(1-tmp.squaredNorm()); //Variance
+  if (var < 0)
+  {
+    var = 0;
+  }
+  return var;
+};
+
 //QMMMAtom class function definitions
 QMMMAtom::QMMMAtom()
 {
@@ -239,6 +912,281 @@ QMMMAtom::~QMMMAtom()
   return;
 };
 
+//MCMoveSet class function definitions
+MCMoveSet::MCMoveSet()
+{
+  //Constructor
+  clear();
+  return;
+};
+
+MCMoveSet::~MCMoveSet()
+{
+  //Generic destructor
+  return;
+};
+
+void MCMoveSet::clear()
+{
+  //Function to remove all moves
+  names_.clear();
+  weights_.clear();
+  totWeight_ = 0;
+  steps_.clear();
+  minStep_.clear();
+  maxStep_.clear();
+  Nacc_.clear();
+  Nrej_.clear();
+  totAcc_.clear();
+  totRej_.clear();
+  return;
+};
+
+int MCMoveSet::addMove(string name, double weight, double step,
+                       double minStep, double maxStep)
+{
+  //Function to register a move type and return its ID
+  if (weight <= 0)
+  {
+    //The move would never be used
+    return -1;
+  }
+  names_.push_back(name);
+  weights_.push_back(weight);
+  totWeight_ += weight;
+  steps_.push_back(step);
+  minStep_.push_back(minStep);
+  maxStep_.push_back(maxStep);
+  Nacc_.push_back(0);
+  Nrej_.push_back(0);
+  totAcc_.push_back(0);
+  totRej_.push_back(0);
+  return (int)(names_.size()-1);
+};
+
+void MCMoveSet::setAtoms(vector<QMMMAtom>& QMMMData)
+{
+  //Function to find the atoms and molecules which can be moved
+  int NAt = (int)QMMMData.size(); //Local number of atoms
+  atoms_.clear();
+  mols_.clear();
+  for (int i=0;i<NAt;i++)
+  {
+    if (!QMMMData[i].frozen)
+    {
+      atoms_.push_back(i);
+    }
+  }
+  //Find the molecules from the connectivity
+  vector<bool> found(NAt,0); //Atoms which are already in a molecule
+  for (int i=0;i<NAt;i++)
+  {
+    if (found[i])
+    {
+      continue;
+    }
+    vector<int> mol; //Atoms in the molecule
+    bool molFrozen = 0; //Flag for molecules with frozen atoms
+    mol.push_back(i);
+    found[i] = 1;
+    for (unsigned int k=0;k<mol.size();k++)
+    {
+      //Add the bonded atoms
+      int j = mol[k]; //Current atom
+      if (QMMMData[j].frozen)
+      {
+        molFrozen = 1;
+      }
+      for (unsigned int l=0;l<QMMMData[j].bonds.size();l++)
+      {
+        int bondID = QMMMData[j].bonds[l]; //Bonded atom
+        if ((bondID >= 0) && (bondID < NAt) && (!found[bondID]))
+        {
+          found[bondID] = 1;
+          mol.push_back(bondID);
+        }
+      }
+    }
+    if (!molFrozen)
+    {
+      mols_.push_back(mol);
+    }
+  }
+  return;
+};
+
+int MCMoveSet::NMoves()
+{
+  //Function to return the number of move types
+  return (int)names_.size();
+};
+
+int MCMoveSet::NAtoms()
+{
+  //Function to return the number of active atoms
+  return (int)atoms_.size();
+};
+
+int MCMoveSet::NMols()
+{
+  //Function to return the number of active molecules
+  return (int)mols_.size();
+};
+
+int MCMoveSet::pickMove(int s)
+{
+  //Function to pick a move type based on the weights
+  double randVal = randGen.uniform(s)*totWeight_; //Random weight
+  for (unsigned int k=0;k<weights_.size();k++)
+  {
+    randVal -= weights_[k];
+    if (randVal < 0)
+    {
+      return k;
+    }
+  }
+  //Safety check for rounding errors
+  return (int)(weights_.size()-1);
+};
+
+int MCMoveSet::pickAtom(int s)
+{
+  //Function to pick an atom which is not frozen
+  return atoms_[randGen.integer(s,(int)atoms_.size())];
+};
+
+vector<int>& MCMoveSet::pickMol(int s)
+{
+  //Function to pick a molecule which does not contain frozen atoms
+  return mols_[randGen.integer(s,(int)mols_.size())];
+};
+
+string MCMoveSet::getName(int k)
+{
+  //Function to return the name of a move type
+  return names_[k];
+};
+
+int MCMoveSet::findMove(string moveName)
+{
+  //Function to find a move type from its name
+  for (unsigned int k=0;k<names_.size();k++)
+  {
+    if (names_[k] == moveName)
+    {
+      return k;
+    }
+  }
+  return -1;
+};
+
+double MCMoveSet::getProb(int k)
+{
+  //Function to return the probability of a move type
+  return weights_[k]/totWeight_;
+};
+
+double MCMoveSet::getStep(int k)
+{
+  //Function to return the step size of a move type
+  return steps_[k];
+};
+
+void MCMoveSet::setStep(int k, double step)
+{
+  //Function to change the step size of a move type
+  steps_[k] = step;
+  return;
+};
+
+void MCMoveSet::update(int k, bool acc)
+{
+  //Function to count an accepted or rejected move
+  if (acc)
+  {
+    Nacc_[k] += 1;
+    totAcc_[k] += 1;
+  }
+  else
+  {
+    Nrej_[k] += 1;
+    totRej_[k] += 1;
+  }
+  return;
+};
+
+double MCMoveSet::accRatio(int k)
+{
+  //Function to return the acceptance ratio since the last check
+  if ((Nacc_[k]+Nrej_[k]) == 0)
+  {
+    return 0;
+  }
+  return Nacc_[k]/(Nacc_[k]+Nrej_[k]);
+};
+
+double MCMoveSet::totRatio(int k)
+{
+  //Function to return the acceptance ratio since the last reset
+  if ((totAcc_[k]+totRej_[k]) == 0)
+  {
+    return 0;
+  }
+  return totAcc_[k]/(totAcc_[k]+totRej_[k]);
+};
+
+void MCMoveSet::adaptSteps(double targetRatio, int s)
+{
+  //Function to adjust the step size of each move type
+  for (unsigned int k=0;k<steps_.size();k++)
+  {
+    if ((Nacc_[k]+Nrej_[k]) == 0)
+    {
+      //The move was not attempted
+      continue;
+    }
+    double randVal; //Use random values to keep from cycling up and down
+    randVal = randGen.uniform(s)/10.0;
+    if (accRatio(k) > targetRatio)
+    {
+      //Increase step size
+      steps_[k] *= 1.001+randVal;
+    }
+    if (accRatio(k) < targetRatio)
+    {
+      //Decrease step size
+      steps_[k] *= 0.999-randVal;
+    }
+    if (steps_[k] < minStep_[k])
+    {
+      //Set to minimum
+      steps_[k] = minStep_[k];
+    }
+    if (steps_[k] > maxStep_[k])
+    {
+      //Set to maximum
+      steps_[k] = maxStep_[k];
+    }
+    //Reset counters
+    Nacc_[k] = 0;
+    Nrej_[k] = 0;
+  }
+  return;
+};
+
+void MCMoveSet::resetStats()
+{
+  //Function to clear all counters
+  for (unsigned int k=0;k<names_.size();k++)
+  {
+    Nacc_[k] = 0;
+    Nrej_[k] = 0;
+    totAcc_[k] = 0;
+    totRej_[k] = 0;
+  }
+  return;
+};
+
 //QMMMSettings class function definitions
 QMMMSettings::QMMMSettings()
 {
@@ -251,6 +1199,10 @@ QMMMSettings::QMMMSettings()
   spin = 1;
   unitsQM = "Angstrom";
   backDir = "Old_files";
+  //Frozen density settings
+  GEMBasis = "N/A";
+  useGEMDen = 0;
+  GEMExch = 0.0;
   //QMMM long-range electrostatics settings
   useLREC = 0;
   LRECCut = 1000.0; //Effectively infinite
@@ -269,24 +1221,61 @@ QMMMSettings::QMMMSettings()
   NEq = 0;
   NSteps = 0;
   NBeads = 1; //Key for printing
+  NQMBeads = 0; //Evaluate QM on all beads
   accRatio = 0.5;
+  PINormModes = 0;
+  MCRejectBound = 0.0; //No early rejection
+  MCTargetErr = 0.0; //Run all production steps
+  MCScreenFunc = "N/A";
+  MCScreenBasis = "N/A";
   NPrint = 5000;
+  randSeed = 0; //Seed from the clock
+  NReplicas = 1; //No replica exchange
+  maxTemp = 300.0;
+  NExchange = 100;
+  NWalkers = 1; //Single Markov chain
+  MCStream = -1; //Use the thread streams
+  PISlot = 0; //Wrapper files of the beads
+  MCBeadWeight = 0.60;
+  MCCentWeight = 0.50;
+  MCForceWeight = 0.0; //No force-bias moves
+  MCModeWeight = 0.0; //No normal mode moves
+  MCMolWeight = 0.0; //No rigid molecule moves
+  MCVolWeight = 0.35;
   //Optimization settings
   maxOptSteps = 200;
   MMOptTol = 1e-2;
+  adaptMM = 0;
+  MMSkipDisp = 0.01;
   QMOptTol = 5e-4;
   stepScale = 1.0;
   maxStep = 0.1;
+  LBFGSMem = 10;
+  initHess = "identity";
+  reuseHess = 0;
   //Additional RP settings
   kSpring = 1.0;
   TSBead = 0;
   climb = 0;
   frznEnds = 0;
+  NEBOpt = "dfp";
+  NEBPreFunc = "N/A";
+  NEBPreBasis = "N/A";
+  NEBFreeze = 0;
+  NEBFreezeTol = 0.01;
+  NEBSurrogate = 0;
+  GPUncertTol = 0.05;
+  dimerDist = 0.01;
   NEBFreq = 0;
   printNormModes = 0;
+  NFreqModes = 0; //Calculate all frequencies
+  numHess = 0; //Use the wrapper Hessians
+  FDStep = 0.005;
   startPathChk = 1; //Speeds up reaction pathways
   //Temporary energy storage
   EOld = 0.0;
+  EScreen = 0.0;
+  EForce = 0.0;
   EReact = 0.0;
   EProd = 0.0;
   ETrans = 0.0;
@@ -299,6 +1288,276 @@ QMMMSettings::~QMMMSettings()
   return;
 };
 
+//MCWalker class function definitions
+MCWalker::MCWalker()
+{
+  //Constructor
+  resetStats();
+  return;
+};
+
+MCWalker::~MCWalker()
+{
+  //Generic destructor
+  return;
+};
+
+void MCWalker::setup(vector<QMMMAtom>& startData, QMMMSettings& startOpts,
+                     int walkerID)
+{
+  /*
+    Function to copy the starting state, create a random number stream, and
+    give the walker its own wrapper replicas. Walker one uses the files of
+    the beads, and the other walkers start from copies of the checkpoints.
+  */
+  stringstream call; //Stream for system calls
+  QMMMData = startData;
+  QMMMOpts = startOpts;
+  QMMMOpts.MCStream = randGen.addStream(walkerID);
+  QMMMOpts.PISlot = (walkerID-1)*QMMMOpts.NBeads;
+  for (int p=0;p<QMMMOpts.NBeads;p++)
+  {
+    int slot = QMMMOpts.PISlot+p; //Wrapper replica
+    if (slot == p)
+    {
+      //The walker uses the files of the beads
+      continue;
+    }
+    if (Gaussian && (QMMMOpts.func != "SemiEmp"))
+    {
+      call.str("");
+      call << "cp LICHM_" << p << ".chk ";
+      call << "LICHM_" << slot << ".chk";
+      call << " 2> LICHM_" << slot << ".trash; ";
+      call << "rm -f LICHM_" << slot << ".trash";
+      globalSys = system(call.str().c_str());
+    }
+    if (PSI4)
+    {
+      call.str("");
+      call << "cp LICHM_" << p << ".180 ";
+      call << "LICHM_" << slot << ".180";
+      call << " 2> LICHM_" << slot << ".trash; ";
+      call << "rm -f LICHM_" << slot << ".trash";
+      globalSys = system(call.str().c_str());
+    }
+  }
+  resetStats();
+  return;
+};
+
+void MCWalker::clearSlots()
+{
+  //Function to delete the files of the scratch wrapper replicas
+  stringstream call; //Stream for system calls
+  for (int p=0;p<QMMMOpts.NBeads;p++)
+  {
+    int slot = QMMMOpts.PISlot+p; //Wrapper replica
+    if (slot == p)
+    {
+      //Keep the files of the beads
+      continue;
+    }
+    call.str("");
+    call << "rm -f LICHM_" << slot << ".*";
+    call << " MMCharges_" << slot << ".txt";
+    globalSys = system(call.str().c_str());
+  }
+  return;
+};
+
+void MCWalker::randomStart()
+{
+  //Function to give the walker a different starting structure
+  for (int i=0;i<Natoms;i++)
+  {
+    if (!QMMMData[i].frozen)
+    {
+      for (int j=0;j<QMMMOpts.NBeads;j++)
+      {
+        //Randomly displace each bead by up to one step
+        double randX = randGen.uniform(QMMMOpts.MCStream);
+        double randY = randGen.uniform(QMMMOpts.MCStream);
+        double randZ = randGen.uniform(QMMMOpts.MCStream);
+        QMMMData[i].P[j].x += 2*(randX-0.5)*mcStep;
+        QMMMData[i].P[j].y += 2*(randY-0.5)*mcStep;
+        QMMMData[i].P[j].z += 2*(randZ-0.5)*mcStep;
+      }
+    }
+  }
+  return;
+};
+
+void MCWalker::initEnergy()
+{
+  //Function to calculate the effective energy of the current structure
+  QMMMOpts.EOld = Get_PI_Epot(QMMMData,QMMMOpts);
+  QMMMOpts.EOld += Get_PI_Espring(QMMMData,QMMMOpts);
+  if (QMMMOpts.MCScreenFunc != "N/A")
+  {
+    //Initial screening energy for delayed acceptance
+    QMMMOpts.EScreen = Get_PI_Escreen(QMMMData,QMMMOpts);
+  }
+  return;
+};
+
+bool MCWalker::move(bool prodRun)
+{
+  //Function to perform a Monte Carlo move and update the statistics
+  double Emc = 0; //Monte Carlo energy
+  bool acc = MCMove(QMMMData,QMMMOpts,Emc);
+  if (acc)
+  {
+    Nacc += 1;
+  }
+  else
+  {
+    Nrej += 1;
+  }
+  if (prodRun)
+  {
+    //Update averages
+    lastE = Emc;
+    if (QMMMOpts.NBeads > 1)
+    {
+      //Add kinetic energy
+      lastE += 3*Natoms*QMMMOpts.NBeads/(2*QMMMOpts.beta);
+    }
+    lastE -= 2*Get_PI_Espring(QMMMData,QMMMOpts);
+    NSamp += 1;
+    sumE += lastE;
+    sumE2 += lastE*lastE;
+  }
+  return acc;
+};
+
+void MCWalker::adaptStep()
+{
+  //Function to adjust the step sizes during equilibration
+  QMMMOpts.MCMoves.adaptSteps(QMMMOpts.accRatio,QMMMOpts.MCStream);
+  //Reset counters
+  Nacc = 0;
+  Nrej = 0;
+  return;
+};
+
+void MCWalker::resetStats()
+{
+  //Function to clear the statistics
+  Nacc = 0;
+  Nrej = 0;
+  NSamp = 0;
+  sumE = 0;
+  sumE2 = 0;
+  lastE = 0;
+  QMMMOpts.MCMoves.resetStats();
+  return;
+};
+
+double MCWalker::avgE()
+{
+  //Function to return the average total energy
+  if (NSamp == 0)
+  {
+    return 0;
+  }
+  return sumE/NSamp;
+};
+
+double MCWalker::varE()
+{
+  //Function to return the variance of the total energy
+  if (NSamp == 0)
+  {
+    return 0;
+  }
+  return (sumE2/NSamp)-(avgE()*avgE());
+};
+
+bool MCWalker::readRestart(string fileName)
+{
+  //Function to read a restart file for the walker
+  fstream repFile; //Restart file
+  string dummy; //Generic string
+  if (!CheckFile(fileName))
+  {
+    //Start from the input structure
+    return 0;
+  }
+  repFile.open(fileName.c_str(),ios_base::in);
+  int atTest = 0; //Number of particles in the file
+  repFile >> atTest;
+  if (atTest != (Natoms*QMMMOpts.NBeads))
+  {
+    //Print warning if the XYZ file has incorrect dimensions
+    cout << "Error: Restart file " << fileName;
+    cout << " does not have the correct format!";
+    cout << '\n' << '\n';
+    cout.flush();
+    //Quit
+    exit(0);
+  }
+  //Read the step sizes from the comment line
+  getline(repFile,dummy); //Clear the end of the first line
+  getline(repFile,dummy);
+  stringstream line(dummy); //Comment line
+  line >> dummy >> dummy >> dummy; //Box lengths (fixed in the NVT ensemble)
+  string moveName; //Name of a saved move type
+  double step; //Saved step size
+  while (line >> moveName >> step)
+  {
+    //Match the step sizes by name, since the available moves can change
+    int k = QMMMOpts.MCMoves.findMove(moveName); //Type of move
+    if (k >= 0)
+    {
+      QMMMOpts.MCMoves.setStep(k,step);
+    }
+  }
+  //Read atom/bead positions
+  for (int i=0;i<Natoms;i++)
+  {
+    for (int j=0;j<QMMMOpts.NBeads;j++)
+    {
+      repFile >> dummy; //Atom type
+      repFile >> QMMMData[i].P[j].x;
+      repFile >> QMMMData[i].P[j].y;
+      repFile >> QMMMData[i].P[j].z;
+    }
+  }
+  repFile.close();
+  return 1;
+};
+
+void MCWalker::writeRestart(string fileName)
+{
+  //Function to write a restart file for the walker
+  fstream repFile; //Restart file
+  repFile.open(fileName.c_str(),ios_base::out);
+  repFile << (Natoms*QMMMOpts.NBeads) << '\n';
+  //Save the box and step sizes in the comment line
+  repFile << LICHEMFormFloat(Lx,16) << " ";
+  repFile << LICHEMFormFloat(Ly,16) << " ";
+  repFile << LICHEMFormFloat(Lz,16);
+  for (int k=0;k<QMMMOpts.MCMoves.NMoves();k++)
+  {
+    repFile << " " << QMMMOpts.MCMoves.getName(k);
+    repFile << " " << LICHEMFormFloat(QMMMOpts.MCMoves.getStep(k),16);
+  }
+  repFile << '\n';
+  for (int i=0;i<Natoms;i++)
+  {
+    for (int j=0;j<QMMMOpts.NBeads;j++)
+    {
+      repFile << setw(3) << left << QMMMData[i].QMTyp << " ";
+      repFile << LICHEMFormFloat(QMMMData[i].P[j].x,16) << " ";
+      repFile << LICHEMFormFloat(QMMMData[i].P[j].y,16) << " ";
+      repFile << LICHEMFormFloat(QMMMData[i].P[j].z,16) << '\n';
+    }
+  }
+  repFile.close();
+  return;
+};
+
 //PeriodicTable class function definitions
 PeriodicTable::PeriodicTable()
 {
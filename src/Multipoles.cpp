@@ -18,6 +18,10 @@
  Stone, The Theory of Intermolecular Forces, (2013)
  Devereux et al., J. Chem. Theory Comp., 10, 10, 4229, (2014)
 
+ References for the 3x3 eigenvalue problem:
+ Smith, Commun. ACM, 4, 4, 168, (1961)
+ Kopp, Int. J. Mod. Phys. C, 19, 3, 523, (2008)
+
 */
 
 /*!
@@ -170,198 +174,230 @@ void ExtractTINKpoles(vector<QMMMAtom>& QMMMData, int bead)
   return;
 };
 
+bool FindTINKFrame(vector<QMMMAtom>& QMMMData, int i, int bead,
+                   Vector3d& vecX, Vector3d& vecY, Vector3d& vecZ)
+{
+  //Function to find the local frame of reference of an atom
+  //NB: The vectors are left as the global axes when the atom has no frame
+  bool hasFrame = 0; //Flag for a local frame
+  //Initialize vectors in the global frame
+  vecX(0) = 1;
+  vecX(1) = 0;
+  vecX(2) = 0;
+  vecY(0) = 0;
+  vecY(1) = 1;
+  vecY(2) = 0;
+  vecZ(0) = 0;
+  vecZ(1) = 0;
+  vecZ(2) = 1;
+  //Find current orientation
+  double x,y,z;
+  if (QMMMData[i].MP[bead].type == "Bisector")
+  {
+    hasFrame = 1;
+    //Find z vector
+    x = QMMMData[i].P[bead].x;
+    x -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].x;
+    y = QMMMData[i].P[bead].y;
+    y -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].y;
+    z = QMMMData[i].P[bead].z;
+    z -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].z;
+    vecZ(0) = -1*x; //Correct the direction
+    vecZ(1) = -1*y; //Correct the direction
+    vecZ(2) = -1*z; //Correct the direction
+    vecZ.normalize();
+    x = QMMMData[i].P[bead].x;
+    x -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].x;
+    y = QMMMData[i].P[bead].y;
+    y -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].y;
+    z = QMMMData[i].P[bead].z;
+    z -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].z;
+    vecX(0) = -1*x; //Correct the direction
+    vecX(1) = -1*y; //Correct the direction
+    vecX(2) = -1*z; //Correct the direction
+    vecX.normalize();
+    //Fill in z vector
+    vecZ += vecX;
+    vecZ.normalize();
+    //Find x vector by subtracting overlap
+    vecX -= vecZ*(vecX.dot(vecZ));
+    vecX.normalize();
+  }
+  if (QMMMData[i].MP[bead].type == "Z-then-X")
+  {
+    hasFrame = 1;
+    //Find z vector
+    x = QMMMData[i].P[bead].x;
+    x -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].x;
+    y = QMMMData[i].P[bead].y;
+    y -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].y;
+    z = QMMMData[i].P[bead].z;
+    z -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].z;
+    vecZ(0) = -1*x; //Correct the direction
+    vecZ(1) = -1*y; //Correct the direction
+    vecZ(2) = -1*z; //Correct the direction
+    vecZ.normalize();
+    //Find x vector
+    x = QMMMData[i].P[bead].x;
+    x -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].x;
+    y = QMMMData[i].P[bead].y;
+    y -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].y;
+    z = QMMMData[i].P[bead].z;
+    z -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].z;
+    vecX(0) = -1*x; //Correct the direction
+    vecX(1) = -1*y; //Correct the direction
+    vecX(2) = -1*z; //Correct the direction
+    vecX.normalize();
+    //Subtract overlap and normalize
+    vecX -= vecZ*(vecX.dot(vecZ));
+    vecX.normalize();
+  }
+  if (QMMMData[i].MP[bead].type == "Z-Bisect")
+  {
+    hasFrame = 1;
+    //Find first vector
+    x = QMMMData[i].P[bead].x;
+    x -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].x;
+    y = QMMMData[i].P[bead].y;
+    y -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].y;
+    z = QMMMData[i].P[bead].z;
+    z -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].z;
+    vecZ(0) = -1*x; //Correct the direction
+    vecZ(1) = -1*y; //Correct the direction
+    vecZ(2) = -1*z; //Correct the direction
+    vecZ.normalize();
+    //Find second vector
+    x = QMMMData[i].P[bead].x;
+    x -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].x;
+    y = QMMMData[i].P[bead].y;
+    y -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].y;
+    z = QMMMData[i].P[bead].z;
+    z -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].z;
+    vecX(0) = -1*x; //Correct the direction
+    vecX(1) = -1*y; //Correct the direction
+    vecX(2) = -1*z; //Correct the direction
+    vecX.normalize();
+    //Find third vector
+    x = QMMMData[i].P[bead].x;
+    x -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].x;
+    y = QMMMData[i].P[bead].y;
+    y -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].y;
+    z = QMMMData[i].P[bead].z;
+    z -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].z;
+    vecY(0) = -1*x; //Correct the direction
+    vecY(1) = -1*y; //Correct the direction
+    vecY(2) = -1*z; //Correct the direction
+    vecY.normalize();
+    //Combine vectors
+    vecX += vecY;
+    vecX.normalize();
+    //Subtract overlap and normalize
+    vecX -= vecZ*(vecX.dot(vecZ));
+    vecX.normalize();
+  }
+  if (QMMMData[i].MP[bead].type == "3-Fold")
+  {
+    hasFrame = 1;
+    //First vector
+    x = QMMMData[i].P[bead].x;
+    x -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].x;
+    y = QMMMData[i].P[bead].y;
+    y -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].y;
+    z = QMMMData[i].P[bead].z;
+    z -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].z;
+    vecZ(0) = -1*x; //Correct the direction
+    vecZ(1) = -1*y; //Correct the direction
+    vecZ(2) = -1*z; //Correct the direction
+    vecZ.normalize();
+    //Second vector
+    x = QMMMData[i].P[bead].x;
+    x -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].x;
+    y = QMMMData[i].P[bead].y;
+    y -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].y;
+    z = QMMMData[i].P[bead].z;
+    z -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].z;
+    vecX(0) = -1*x; //Correct the direction
+    vecX(1) = -1*y; //Correct the direction
+    vecX(2) = -1*z; //Correct the direction
+    vecX.normalize();
+    //Third vector
+    x = QMMMData[i].P[bead].x;
+    x -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].x;
+    y = QMMMData[i].P[bead].y;
+    y -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].y;
+    z = QMMMData[i].P[bead].z;
+    z -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].z;
+    vecY(0) = -1*x; //Correct the direction
+    vecY(1) = -1*y; //Correct the direction
+    vecY(2) = -1*z; //Correct the direction
+    vecY.normalize();
+    //Combine vectors and normalize
+    vecZ += vecX+vecY;
+    vecZ.normalize();
+    //Find second axis by subtracting overlap and normalizing
+    vecX -= vecZ*(vecX.dot(vecZ));
+    vecX.normalize();
+  }
+  if (QMMMData[i].MP[bead].type == "Z-Only")
+  {
+    hasFrame = 1;
+    //Primary vector
+    x = QMMMData[i].P[bead].x;
+    x -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].x;
+    y = QMMMData[i].P[bead].y;
+    y -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].y;
+    z = QMMMData[i].P[bead].z;
+    z -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].z;
+    vecZ(0) = -1*x; //Correct the direction
+    vecZ(1) = -1*y; //Correct the direction
+    vecZ(2) = -1*z; //Correct the direction
+    vecZ.normalize();
+    //Use a global axis for the second vector
+    vecX(0) = 1.0;
+    vecX(1) = 0.0;
+    vecX(2) = 0.0;
+    if (vecZ.dot(vecX) > 0.85)
+    {
+      //Switch to y axis if overlap is large
+      vecX(0) = 0.0;
+      vecX(1) = 1.0;
+    }
+    //Subtract overlap and normalize
+    vecX -= vecZ*(vecX.dot(vecZ));
+    vecX.normalize();
+  }
+  if (hasFrame)
+  {
+    //Fill in y vector
+    vecY = vecX.cross(vecZ);
+    vecY.normalize();
+  }
+  return hasFrame;
+};
+
 void RotateTINKCharges(vector<QMMMAtom>& QMMMData, int bead)
 {
   //Switches from the local frame of reference to the global frame
   //of reference
+  vector<MPole> globalPoles; //Multipoles in the global frame
+  vector<int> mmIDs; //Atoms with rotated multipoles
+  globalPoles.resize(Natoms);
+  for (int i=0;i<Natoms;i++)
+  {
+    if (QMMMData[i].MMRegion)
+    {
+      mmIDs.push_back(i);
+    }
+  }
   #pragma omp parallel for schedule(dynamic) num_threads(Ncpus)
   for (int i=0;i<Natoms;i++)
   {
     Vector3d vecX,vecY,vecZ; //Local frame vectors
-    //Initialize vectors in the global frame
-    vecX(0) = 1;
-    vecX(1) = 0;
-    vecX(2) = 0;
-    vecY(0) = 0;
-    vecY(1) = 1;
-    vecY(2) = 0;
-    vecZ(0) = 0;
-    vecZ(1) = 0;
-    vecZ(2) = 1;
     //Rotate the charges
     if (QMMMData[i].MMRegion)
     {
       //Find current orientation
-      double x,y,z;
-      if (QMMMData[i].MP[bead].type == "Bisector")
-      {
-        //Find z vector
-        x = QMMMData[i].P[bead].x;
-        x -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].x;
-        y = QMMMData[i].P[bead].y;
-        y -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].y;
-        z = QMMMData[i].P[bead].z;
-        z -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].z;
-        vecZ(0) = -1*x; //Correct the direction
-        vecZ(1) = -1*y; //Correct the direction
-        vecZ(2) = -1*z; //Correct the direction
-        vecZ.normalize();
-        x = QMMMData[i].P[bead].x;
-        x -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].x;
-        y = QMMMData[i].P[bead].y;
-        y -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].y;
-        z = QMMMData[i].P[bead].z;
-        z -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].z;
-        vecX(0) = -1*x; //Correct the direction
-        vecX(1) = -1*y; //Correct the direction
-        vecX(2) = -1*z; //Correct the direction
-        vecX.normalize();
-        //Fill in z vector
-        vecZ += vecX;
-        vecZ.normalize();
-        //Find x vector by subtracting overlap
-        vecX -= vecZ*(vecX.dot(vecZ));
-        vecX.normalize();
-      }
-      if (QMMMData[i].MP[bead].type == "Z-then-X")
-      {
-        //Find z vector
-        x = QMMMData[i].P[bead].x;
-        x -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].x;
-        y = QMMMData[i].P[bead].y;
-        y -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].y;
-        z = QMMMData[i].P[bead].z;
-        z -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].z;
-        vecZ(0) = -1*x; //Correct the direction
-        vecZ(1) = -1*y; //Correct the direction
-        vecZ(2) = -1*z; //Correct the direction
-        vecZ.normalize();
-        //Find x vector
-        x = QMMMData[i].P[bead].x;
-        x -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].x;
-        y = QMMMData[i].P[bead].y;
-        y -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].y;
-        z = QMMMData[i].P[bead].z;
-        z -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].z;
-        vecX(0) = -1*x; //Correct the direction
-        vecX(1) = -1*y; //Correct the direction
-        vecX(2) = -1*z; //Correct the direction
-        vecX.normalize();
-        //Subtract overlap and normalize
-        vecX -= vecZ*(vecX.dot(vecZ));
-        vecX.normalize();
-      }
-      if (QMMMData[i].MP[bead].type == "Z-Bisect")
-      {
-        //Find first vector
-        x = QMMMData[i].P[bead].x;
-        x -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].x;
-        y = QMMMData[i].P[bead].y;
-        y -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].y;
-        z = QMMMData[i].P[bead].z;
-        z -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].z;
-        vecZ(0) = -1*x; //Correct the direction
-        vecZ(1) = -1*y; //Correct the direction
-        vecZ(2) = -1*z; //Correct the direction
-        vecZ.normalize();
-        //Find second vector
-        x = QMMMData[i].P[bead].x;
-        x -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].x;
-        y = QMMMData[i].P[bead].y;
-        y -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].y;
-        z = QMMMData[i].P[bead].z;
-        z -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].z;
-        vecX(0) = -1*x; //Correct the direction
-        vecX(1) = -1*y; //Correct the direction
-        vecX(2) = -1*z; //Correct the direction
-        vecX.normalize();
-        //Find third vector
-        x = QMMMData[i].P[bead].x;
-        x -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].x;
-        y = QMMMData[i].P[bead].y;
-        y -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].y;
-        z = QMMMData[i].P[bead].z;
-        z -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].z;
-        vecY(0) = -1*x; //Correct the direction
-        vecY(1) = -1*y; //Correct the direction
-        vecY(2) = -1*z; //Correct the direction
-        vecY.normalize();
-        //Combine vectors
-        vecX += vecY;
-        vecX.normalize();
-        //Subtract overlap and normalize
-        vecX -= vecZ*(vecX.dot(vecZ));
-        vecX.normalize();
-      }
-      if (QMMMData[i].MP[bead].type == "3-Fold")
-      {
-        //First vector
-        x = QMMMData[i].P[bead].x;
-        x -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].x;
-        y = QMMMData[i].P[bead].y;
-        y -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].y;
-        z = QMMMData[i].P[bead].z;
-        z -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].z;
-        vecZ(0) = -1*x; //Correct the direction
-        vecZ(1) = -1*y; //Correct the direction
-        vecZ(2) = -1*z; //Correct the direction
-        vecZ.normalize();
-        //Second vector
-        x = QMMMData[i].P[bead].x;
-        x -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].x;
-        y = QMMMData[i].P[bead].y;
-        y -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].y;
-        z = QMMMData[i].P[bead].z;
-        z -= QMMMData[QMMMData[i].MP[bead].atom2].P[bead].z;
-        vecX(0) = -1*x; //Correct the direction
-        vecX(1) = -1*y; //Correct the direction
-        vecX(2) = -1*z; //Correct the direction
-        vecX.normalize();
-        //Third vector
-        x = QMMMData[i].P[bead].x;
-        x -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].x;
-        y = QMMMData[i].P[bead].y;
-        y -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].y;
-        z = QMMMData[i].P[bead].z;
-        z -= QMMMData[QMMMData[i].MP[bead].atom3].P[bead].z;
-        vecY(0) = -1*x; //Correct the direction
-        vecY(1) = -1*y; //Correct the direction
-        vecY(2) = -1*z; //Correct the direction
-        vecY.normalize();
-        //Combine vectors and normalize
-        vecZ += vecX+vecY;
-        vecZ.normalize();
-        //Find second axis by subtracting overlap and normalizing
-        vecX -= vecZ*(vecX.dot(vecZ));
-        vecX.normalize();
-      }
-      if (QMMMData[i].MP[bead].type == "Z-Only")
-      {
-        //Primary vector
-        x = QMMMData[i].P[bead].x;
-        x -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].x;
-        y = QMMMData[i].P[bead].y;
-        y -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].y;
-        z = QMMMData[i].P[bead].z;
-        z -= QMMMData[QMMMData[i].MP[bead].atom1].P[bead].z;
-        vecZ(0) = -1*x; //Correct the direction
-        vecZ(1) = -1*y; //Correct the direction
-        vecZ(2) = -1*z; //Correct the direction
-        vecZ.normalize();
-        //Use a global axis for the second vector
-        vecX(0) = 1.0;
-        vecX(1) = 0.0;
-        vecX(2) = 0.0;
-        if (vecZ.dot(vecX) > 0.85)
-        {
-          //Switch to y axis if overlap is large
-          vecX(0) = 0.0;
-          vecX(1) = 1.0;
-        }
-        //Subtract overlap and normalize
-        vecX -= vecZ*(vecX.dot(vecZ));
-        vecX.normalize();
-      }
+      FindTINKFrame(QMMMData,i,bead,vecX,vecY,vecZ);
       if (QMMMData[i].MP[bead].type == "None")
       {
         QMMMData[i].PC[bead].q1 = 0;
@@ -460,27 +496,8 @@ void RotateTINKCharges(vector<QMMMAtom>& QMMMData, int bead)
       newPoles.Qzz += vecZ(2)*vecX(2)*QMMMData[i].MP[bead].Qxz;
       newPoles.Qzz += vecZ(2)*vecY(2)*QMMMData[i].MP[bead].Qyz;
       newPoles.Qzz += vecZ(2)*vecZ(2)*QMMMData[i].MP[bead].Qzz;
-      //switch to point-charges
-      QMMMData[i].PC[bead] = SphHarm2Charges(Cart2SphHarm(newPoles));
-      //Translate charges to the atom's location in the global frame
-      QMMMData[i].PC[bead].x1 += QMMMData[i].P[bead].x;
-      QMMMData[i].PC[bead].y1 += QMMMData[i].P[bead].y;
-      QMMMData[i].PC[bead].z1 += QMMMData[i].P[bead].z;
-      QMMMData[i].PC[bead].x2 += QMMMData[i].P[bead].x;
-      QMMMData[i].PC[bead].y2 += QMMMData[i].P[bead].y;
-      QMMMData[i].PC[bead].z2 += QMMMData[i].P[bead].z;
-      QMMMData[i].PC[bead].x3 += QMMMData[i].P[bead].x;
-      QMMMData[i].PC[bead].y3 += QMMMData[i].P[bead].y;
-      QMMMData[i].PC[bead].z3 += QMMMData[i].P[bead].z;
-      QMMMData[i].PC[bead].x4 += QMMMData[i].P[bead].x;
-      QMMMData[i].PC[bead].y4 += QMMMData[i].P[bead].y;
-      QMMMData[i].PC[bead].z4 += QMMMData[i].P[bead].z;
-      QMMMData[i].PC[bead].x5 += QMMMData[i].P[bead].x;
-      QMMMData[i].PC[bead].y5 += QMMMData[i].P[bead].y;
-      QMMMData[i].PC[bead].z5 += QMMMData[i].P[bead].z;
-      QMMMData[i].PC[bead].x6 += QMMMData[i].P[bead].x;
-      QMMMData[i].PC[bead].y6 += QMMMData[i].P[bead].y;
-      QMMMData[i].PC[bead].z6 += QMMMData[i].P[bead].z;
+      //Save the rotated multipoles
+      globalPoles[i] = newPoles;
     }
     else
     {
@@ -512,6 +529,41 @@ void RotateTINKCharges(vector<QMMMAtom>& QMMMData, int bead)
       QMMMData[i].PC[bead].z6 = QMMMData[i].P[bead].z;
     }
   }
+  //Diagonalize all quadrupoles in one pass
+  vector<MPole> mmPoles; //Rotated multipoles for the MM atoms
+  vector<RedMPole> SHPoles; //Spherical harmonic multipoles
+  for (unsigned int k=0;k<mmIDs.size();k++)
+  {
+    mmPoles.push_back(globalPoles[mmIDs[k]]);
+  }
+  Cart2SphHarmBatch(mmPoles,SHPoles);
+  int NmmPoles = (int)mmIDs.size(); //Number of rotated multipoles
+  #pragma omp parallel for schedule(dynamic) num_threads(Ncpus)
+  for (int k=0;k<NmmPoles;k++)
+  {
+    int i = mmIDs[k]; //Atom ID
+    //switch to point-charges
+    QMMMData[i].PC[bead] = SphHarm2Charges(SHPoles[k]);
+    //Translate charges to the atom's location in the global frame
+    QMMMData[i].PC[bead].x1 += QMMMData[i].P[bead].x;
+    QMMMData[i].PC[bead].y1 += QMMMData[i].P[bead].y;
+    QMMMData[i].PC[bead].z1 += QMMMData[i].P[bead].z;
+    QMMMData[i].PC[bead].x2 += QMMMData[i].P[bead].x;
+    QMMMData[i].PC[bead].y2 += QMMMData[i].P[bead].y;
+    QMMMData[i].PC[bead].z2 += QMMMData[i].P[bead].z;
+    QMMMData[i].PC[bead].x3 += QMMMData[i].P[bead].x;
+    QMMMData[i].PC[bead].y3 += QMMMData[i].P[bead].y;
+    QMMMData[i].PC[bead].z3 += QMMMData[i].P[bead].z;
+    QMMMData[i].PC[bead].x4 += QMMMData[i].P[bead].x;
+    QMMMData[i].PC[bead].y4 += QMMMData[i].P[bead].y;
+    QMMMData[i].PC[bead].z4 += QMMMData[i].P[bead].z;
+    QMMMData[i].PC[bead].x5 += QMMMData[i].P[bead].x;
+    QMMMData[i].PC[bead].y5 += QMMMData[i].P[bead].y;
+    QMMMData[i].PC[bead].z5 += QMMMData[i].P[bead].z;
+    QMMMData[i].PC[bead].x6 += QMMMData[i].P[bead].x;
+    QMMMData[i].PC[bead].y6 += QMMMData[i].P[bead].y;
+    QMMMData[i].PC[bead].z6 += QMMMData[i].P[bead].z;
+  }
   return;
 };
 
@@ -1285,59 +1337,175 @@ void ExtractGlobalPoles(int& argc, char**& argv)
 RedMPole Cart2SphHarm(MPole& pole)
 {
   //Converts Cartesian multipoles to spherical harmonic multipoles
-  RedMPole SHPole; //Spherical harmonic multipoles
-  //Diagonalize quadrupole moment tensor
-  Matrix3d QPole;
-  QPole(0,0) = pole.Qxx;
-  QPole(0,1) = pole.Qxy;
-  QPole(0,2) = pole.Qxz;
-  QPole(1,0) = pole.Qxy;
-  QPole(1,1) = pole.Qyy;
-  QPole(1,2) = pole.Qyz;
-  QPole(2,0) = pole.Qxz;
-  QPole(2,1) = pole.Qyz;
-  QPole(2,2) = pole.Qzz;
-  //Change out of a.u.
-  QPole *= bohrRad*bohrRad; //NB: TINKER also divides by 3
-  EigenSolver<Matrix3d> QTensor; //There might be a better method
-  QTensor.compute(QPole);
-  Vector3d SHTensor;
-  SHTensor = QTensor.eigenvalues().real();
-  //Save vector
-  Matrix3d vec = QTensor.eigenvectors().real();
-  SHPole.vecX(0) = vec(0,0);
-  SHPole.vecX(1) = vec(1,0);
-  SHPole.vecX(2) = vec(2,0);
-  SHPole.vecY(0) = vec(0,1);
-  SHPole.vecY(1) = vec(1,1);
-  SHPole.vecY(2) = vec(2,1);
-  SHPole.vecZ(0) = vec(0,2);
-  SHPole.vecZ(1) = vec(1,2);
-  SHPole.vecZ(2) = vec(2,2);
-  //Normalize vectors (Probably not needed)
-  SHPole.vecX.normalize();
-  SHPole.vecY.normalize();
-  SHPole.vecZ.normalize();
-  //Convert to spherical harmonics and rotate dipoles
-  SHPole.Q00 = pole.q;
-  SHPole.Q11c = 0; //X component
-  SHPole.Q11c += pole.Dx*SHPole.vecX(0);
-  SHPole.Q11c += pole.Dy*SHPole.vecX(1);
-  SHPole.Q11c += pole.Dz*SHPole.vecX(2);
-  SHPole.Q11c *= bohrRad; //Change out of a.u.
-  SHPole.Q11s = 0; //Y component
-  SHPole.Q11s += pole.Dx*SHPole.vecY(0);
-  SHPole.Q11s += pole.Dy*SHPole.vecY(1);
-  SHPole.Q11s += pole.Dz*SHPole.vecY(2);
-  SHPole.Q11s *= bohrRad; //Change out of a.u.
-  SHPole.Q10 = 0; //Z component
-  SHPole.Q10 += pole.Dx*SHPole.vecZ(0);
-  SHPole.Q10 += pole.Dy*SHPole.vecZ(1);
-  SHPole.Q10 += pole.Dz*SHPole.vecZ(2);
-  SHPole.Q10 *= bohrRad; //Change out of a.u.
-  SHPole.Q22c = (SHTensor(0)-SHTensor(1))/sqrt(3); //Diagonal Qxx-Qyy
-  SHPole.Q20 = SHTensor(2); //Diagonal Qzz
-  return SHPole;
+  vector<MPole> poles; //Single multipole
+  vector<RedMPole> SHPoles; //Spherical harmonic multipoles
+  poles.push_back(pole);
+  Cart2SphHarmBatch(poles,SHPoles);
+  return SHPoles[0];
+};
+
+void Cart2SphHarmBatch(vector<MPole>& poles, vector<RedMPole>& SHPoles)
+{
+  //Converts a set of Cartesian multipoles to spherical harmonic multipoles
+  int Npoles = (int)poles.size(); //Number of multipoles
+  double thirdPi = 2*pi/3; //Angle between the trigonometric roots
+  SHPoles.resize(Npoles);
+  //Copy the quadrupole tensors into contiguous arrays
+  VectorXd Qxx(Npoles),Qxy(Npoles),Qxz(Npoles); //Quadrupole components
+  VectorXd Qyy(Npoles),Qyz(Npoles),Qzz(Npoles); //Quadrupole components
+  for (int i=0;i<Npoles;i++)
+  {
+    //Change out of a.u.
+    Qxx(i) = poles[i].Qxx*bohrRad*bohrRad; //NB: TINKER also divides by 3
+    Qxy(i) = poles[i].Qxy*bohrRad*bohrRad;
+    Qxz(i) = poles[i].Qxz*bohrRad*bohrRad;
+    Qyy(i) = poles[i].Qyy*bohrRad*bohrRad;
+    Qyz(i) = poles[i].Qyz*bohrRad*bohrRad;
+    Qzz(i) = poles[i].Qzz*bohrRad*bohrRad;
+  }
+  //Closed-form eigenvalues (trigonometric solution of the cubic)
+  VectorXd eigMin(Npoles); //Smallest eigenvalue
+  VectorXd eigMid(Npoles); //Middle eigenvalue
+  VectorXd eigMax(Npoles); //Largest eigenvalue
+  #pragma omp simd
+  for (int i=0;i<Npoles;i++)
+  {
+    double m = (Qxx(i)+Qyy(i)+Qzz(i))/3; //Mean of the diagonal
+    double kxx = Qxx(i)-m; //Shifted diagonal
+    double kyy = Qyy(i)-m; //Shifted diagonal
+    double kzz = Qzz(i)-m; //Shifted diagonal
+    double offDiag; //Sum of the squared off-diagonal elements
+    offDiag = Qxy(i)*Qxy(i)+Qxz(i)*Qxz(i)+Qyz(i)*Qyz(i);
+    double p = (kxx*kxx+kyy*kyy+kzz*kzz+2*offDiag)/6; //Scaled norm
+    double q; //Half of the determinant of the shifted tensor
+    q = kxx*(kyy*kzz-Qyz(i)*Qyz(i));
+    q -= Qxy(i)*(Qxy(i)*kzz-Qyz(i)*Qxz(i));
+    q += Qxz(i)*(Qxy(i)*Qyz(i)-kyy*Qxz(i));
+    q *= 0.5;
+    double sqrtP = sqrt(p); //Radius of the roots
+    double cosArg = 0; //Argument of the arc-cosine
+    if (p > 0)
+    {
+      cosArg = q/(p*sqrtP);
+    }
+    //Avoid round-off outside of [-1,1]
+    cosArg = min(1.0,max(-1.0,cosArg));
+    double phi = acos(cosArg)/3; //Angle of the largest root
+    eigMax(i) = m+2*sqrtP*cos(phi);
+    eigMin(i) = m+2*sqrtP*cos(phi+thirdPi);
+    eigMid(i) = 3*m-eigMax(i)-eigMin(i); //Use the trace
+  }
+  //Eigenvectors and spherical harmonics
+  #pragma omp parallel for schedule(dynamic) num_threads(Ncpus)
+  for (int i=0;i<Npoles;i++)
+  {
+    Matrix3d QPole; //Quadrupole tensor
+    Vector3d SHTensor; //Diagonal quadrupole
+    Matrix3d vec; //Eigenvectors
+    QPole(0,0) = Qxx(i);
+    QPole(0,1) = Qxy(i);
+    QPole(0,2) = Qxz(i);
+    QPole(1,0) = Qxy(i);
+    QPole(1,1) = Qyy(i);
+    QPole(1,2) = Qyz(i);
+    QPole(2,0) = Qxz(i);
+    QPole(2,1) = Qyz(i);
+    QPole(2,2) = Qzz(i);
+    //Find the eigenvector of the most isolated eigenvalue
+    double isoEig = eigMax(i); //Isolated eigenvalue
+    if ((eigMid(i)-eigMin(i)) > (eigMax(i)-eigMid(i)))
+    {
+      isoEig = eigMin(i);
+    }
+    Matrix3d shiftMat = QPole; //Tensor minus the isolated eigenvalue
+    shiftMat -= isoEig*Matrix3d::Identity();
+    Vector3d isoVec; //Isolated eigenvector
+    Vector3d crossVec; //Candidate eigenvector
+    isoVec = shiftMat.row(0).transpose().cross(shiftMat.row(1).transpose());
+    crossVec = shiftMat.row(0).transpose().cross(shiftMat.row(2).transpose());
+    if (crossVec.squaredNorm() > isoVec.squaredNorm())
+    {
+      isoVec = crossVec;
+    }
+    crossVec = shiftMat.row(1).transpose().cross(shiftMat.row(2).transpose());
+    if (crossVec.squaredNorm() > isoVec.squaredNorm())
+    {
+      isoVec = crossVec;
+    }
+    if (isoVec.squaredNorm() < 1e-30)
+    {
+      //Spherical tensor, any frame works
+      isoVec << 0,0,1;
+    }
+    isoVec.normalize();
+    //Create two vectors perpendicular to the isolated eigenvector
+    Vector3d uVec,wVec; //Basis for the remaining plane
+    uVec << 1,0,0;
+    if (abs(isoVec(0)) > 0.85)
+    {
+      //Switch to the y axis if the overlap is large
+      uVec << 0,1,0;
+    }
+    uVec -= isoVec*(uVec.dot(isoVec));
+    uVec.normalize();
+    wVec = isoVec.cross(uVec);
+    //Solve the remaining 2x2 problem with a Jacobi rotation
+    double b11 = uVec.dot(QPole*uVec); //Projected tensor
+    double b12 = uVec.dot(QPole*wVec); //Projected tensor
+    double b22 = wVec.dot(QPole*wVec); //Projected tensor
+    double theta = 0.5*atan2(2*b12,b11-b22); //Rotation angle
+    Vector3d eVec1 = cos(theta)*uVec+sin(theta)*wVec; //Second eigenvector
+    Vector3d eVec2 = cos(theta)*wVec-sin(theta)*uVec; //Third eigenvector
+    //Sort the eigenpairs in ascending order
+    Vector3d eigs; //Rayleigh quotients
+    eigs(0) = isoVec.dot(QPole*isoVec);
+    eigs(1) = eVec1.dot(QPole*eVec1);
+    eigs(2) = eVec2.dot(QPole*eVec2);
+    vec.col(0) = isoVec;
+    vec.col(1) = eVec1;
+    vec.col(2) = eVec2;
+    for (int j=0;j<2;j++)
+    {
+      for (int k=0;k<(2-j);k++)
+      {
+        if (eigs(k) > eigs(k+1))
+        {
+          double tmpEig = eigs(k); //Temporary storage
+          Vector3d tmpVec = vec.col(k); //Temporary storage
+          eigs(k) = eigs(k+1);
+          eigs(k+1) = tmpEig;
+          vec.col(k) = vec.col(k+1);
+          vec.col(k+1) = tmpVec;
+        }
+      }
+    }
+    SHTensor = eigs;
+    //Save vector
+    RedMPole& SHPole = SHPoles[i]; //Local alias
+    SHPole.vecX = vec.col(0);
+    SHPole.vecY = vec.col(1);
+    SHPole.vecZ = vec.col(2);
+    //Convert to spherical harmonics and rotate dipoles
+    SHPole.Q00 = poles[i].q;
+    SHPole.Q11c = 0; //X component
+    SHPole.Q11c += poles[i].Dx*SHPole.vecX(0);
+    SHPole.Q11c += poles[i].Dy*SHPole.vecX(1);
+    SHPole.Q11c += poles[i].Dz*SHPole.vecX(2);
+    SHPole.Q11c *= bohrRad; //Change out of a.u.
+    SHPole.Q11s = 0; //Y component
+    SHPole.Q11s += poles[i].Dx*SHPole.vecY(0);
+    SHPole.Q11s += poles[i].Dy*SHPole.vecY(1);
+    SHPole.Q11s += poles[i].Dz*SHPole.vecY(2);
+    SHPole.Q11s *= bohrRad; //Change out of a.u.
+    SHPole.Q10 = 0; //Z component
+    SHPole.Q10 += poles[i].Dx*SHPole.vecZ(0);
+    SHPole.Q10 += poles[i].Dy*SHPole.vecZ(1);
+    SHPole.Q10 += poles[i].Dz*SHPole.vecZ(2);
+    SHPole.Q10 *= bohrRad; //Change out of a.u.
+    SHPole.Q22c = (SHTensor(0)-SHTensor(1))/sqrt(3); //Diagonal Qxx-Qyy
+    SHPole.Q20 = SHTensor(2); //Diagonal Qzz
+  }
+  return;
 };
 
 OctCharges SphHarm2Charges(RedMPole pole)
@@ -16,6 +16,13 @@
  Reference for optimization routines:
  Press et al., Numerical Recipes 3nd Edition, (2007)
 
+ Reference for L-BFGS:
+ Nocedal, Math. Comput., 35, 773, (1980)
+ Liu and Nocedal, Math. Program., 45, 503, (1989)
+
+ Reference for FIRE:
+ Bitzek et al., Phys. Rev. Lett., 97, 170201, (2006)
+
 */
 
 /*!
@@ -177,6 +184,664 @@ bool OptConverged(vector<QMMMAtom>& QMMMData, vector<QMMMAtom>& oldQMMMData,
   return optDone;
 };
 
+//L-BFGS utility functions
+VectorXd LBFGSDirection(VectorXd& forces, vector<VectorXd>& stepHist,
+                        vector<VectorXd>& gradHist)
+{
+  //Two-loop recursion for the L-BFGS optimization direction
+  int Nhist = (int)stepHist.size(); //Number of saved correction pairs
+  VectorXd optVec = forces; //Optimization direction (H*forces)
+  VectorXd alphas(Nhist); //Coefficients from the first loop
+  VectorXd rhos(Nhist); //Inverse curvatures
+  //First loop (newest to oldest)
+  for (int k=(Nhist-1);k>=0;k--)
+  {
+    rhos(k) = 1/gradHist[k].dot(stepHist[k]);
+    alphas(k) = rhos(k)*stepHist[k].dot(optVec);
+    optVec -= alphas(k)*gradHist[k];
+  }
+  //Scale the initial inverse Hessian
+  if (Nhist > 0)
+  {
+    double gamma; //Scale factor
+    gamma = stepHist[Nhist-1].dot(gradHist[Nhist-1]);
+    gamma /= gradHist[Nhist-1].squaredNorm();
+    optVec *= gamma;
+  }
+  //Second loop (oldest to newest)
+  for (int k=0;k<Nhist;k++)
+  {
+    double beta; //Correction coefficient
+    beta = rhos(k)*gradHist[k].dot(optVec);
+    optVec += (alphas(k)-beta)*stepHist[k];
+  }
+  return optVec;
+};
+
+bool LBFGSUpdate(VectorXd& stepVec, VectorXd& gradDiff,
+                 vector<VectorXd>& stepHist, vector<VectorXd>& gradHist,
+                 int maxHist)
+{
+  //Saves a new L-BFGS correction pair and removes the oldest pair
+  bool pairSaved = 0; //Flag to show if the pair was used
+  double curv = stepVec.dot(gradDiff); //Curvature along the step
+  //Skip pairs which do not keep the inverse Hessian positive definite
+  if (curv > (1e-10*stepVec.norm()*gradDiff.norm()))
+  {
+    stepHist.push_back(stepVec);
+    gradHist.push_back(gradDiff);
+    if ((int)stepHist.size() > maxHist)
+    {
+      //Remove the oldest pair
+      stepHist.erase(stepHist.begin());
+      gradHist.erase(gradHist.begin());
+    }
+    pairSaved = 1;
+  }
+  return pairSaved;
+};
+
+//FIRE utility functions
+void FIREStep(VectorXd& forces, VectorXd& vel, VectorXd& optVec,
+              double& dt, double& alpha, int& NPos, QMMMSettings& QMMMOpts)
+{
+  //Fast inertial relaxation engine step for a single structure
+  int NMin = 5; //Number of downhill steps before increasing the time step
+  double alphaStart = 0.1; //Initial mixing parameter
+  double dtMax = QMMMOpts.stepScale; //Maximum time step
+  double power = forces.dot(vel); //Power of the forces
+  if (power >= 0)
+  {
+    //Mix the velocities with the direction of the forces
+    double forceNorm = forces.norm(); //Magnitude of the forces
+    if (forceNorm > 0)
+    {
+      double velNorm = vel.norm(); //Magnitude of the velocities
+      vel *= (1-alpha);
+      vel += (alpha*velNorm/forceNorm)*forces;
+    }
+    if (NPos > NMin)
+    {
+      //Accelerate
+      dt *= 1.1;
+      if (dt > dtMax)
+      {
+        dt = dtMax;
+      }
+      alpha *= 0.99;
+    }
+    NPos += 1;
+  }
+  else
+  {
+    //Going uphill, stop and take smaller steps
+    vel.setZero();
+    dt *= 0.5;
+    alpha = alphaStart;
+    NPos = 0;
+  }
+  //Semi-implicit Euler step with unit masses
+  vel += dt*forces;
+  optVec = dt*vel;
+  //Check step size
+  double vecMax = optVec.norm(); //Displacement of the structure
+  if (vecMax > QMMMOpts.maxStep)
+  {
+    //Scale step size
+    optVec *= (QMMMOpts.maxStep/vecMax);
+  }
+  return;
+};
+
+//Inverse Hessian utility functions
+MatrixXd InitInvHessian(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts,
+                        int bead)
+{
+  //Creates the starting inverse Hessian for the optimizers
+  int Ndof = 3*(Nqm+Npseudo); //Number of QM and PB degrees of freedom
+  double minCurv = 0.1; //Smallest allowed curvature (eV/Ang^2)
+  MatrixXd iHess(Ndof,Ndof); //Inverse Hessian
+  iHess.setIdentity(); //Already an "inverse" Hessian
+  if (QMMMOpts.initHess == "identity")
+  {
+    //Nothing to do
+    return iHess;
+  }
+  //Calculate the Hessian
+  MatrixXd QMMMHess(Ndof,Ndof); //Hessian (a.u.)
+  QMMMHess.setZero();
+  if (QMMMOpts.initHess == "lindh")
+  {
+    //Model Hessian
+    QMMMHess = LindhHessian(QMMMData,bead);
+  }
+  else if (QMMMOpts.numHess)
+  {
+    //Finite differences of the wrapper forces
+    QMMMHess = LICHEMFDHessian(QMMMData,QMMMOpts,bead);
+  }
+  else
+  {
+    //Calculate QM Hessian
+    if (Gaussian)
+    {
+      int tStart = (unsigned)time(0);
+      QMMMHess += GaussianHessian(QMMMData,QMMMOpts,bead);
+      QMTime += (unsigned)time(0)-tStart;
+    }
+    if (PSI4)
+    {
+      int tStart = (unsigned)time(0);
+      QMMMHess += PSI4Hessian(QMMMData,QMMMOpts,bead);
+      QMTime += (unsigned)time(0)-tStart;
+      //Delete annoying useless files
+      globalSys = system("rm -f psi.* timer.*");
+    }
+    if (NWChem)
+    {
+      int tStart = (unsigned)time(0);
+      QMMMHess += NWChemHessian(QMMMData,QMMMOpts,bead);
+      QMTime += (unsigned)time(0)-tStart;
+    }
+    //Calculate MM Hessian
+    if (TINKER)
+    {
+      int tStart = (unsigned)time(0);
+      QMMMHess += TINKERHessian(QMMMData,QMMMOpts,bead);
+      MMTime += (unsigned)time(0)-tStart;
+    }
+    if (LAMMPS)
+    {
+      int tStart = (unsigned)time(0);
+      QMMMHess += LAMMPSHessian(QMMMData,QMMMOpts,bead);
+      MMTime += (unsigned)time(0)-tStart;
+    }
+  }
+  //Change units to eV/Ang^2
+  QMMMHess *= har2eV/(bohrRad*bohrRad);
+  //Invert the Hessian with positive curvatures
+  SelfAdjointEigenSolver<MatrixXd> hessAnalysis(QMMMHess);
+  VectorXd curvs = hessAnalysis.eigenvalues(); //Curvatures
+  for (int i=0;i<Ndof;i++)
+  {
+    //Flip negative modes and lift flat modes
+    curvs(i) = abs(curvs(i));
+    if (curvs(i) < minCurv)
+    {
+      curvs(i) = minCurv;
+    }
+    curvs(i) = 1/curvs(i);
+  }
+  iHess = hessAnalysis.eigenvectors()*curvs.asDiagonal()*
+          hessAnalysis.eigenvectors().transpose();
+  return iHess;
+};
+
+bool CheckOptFingerprint(fstream& histFile, vector<QMMMAtom>& QMMMData,
+                         int bead)
+{
+  //Compares the atoms saved with an inverse Hessian or L-BFGS history
+  //to the current QM and PB atoms
+  bool sameAtoms = 1; //Flag to show if the saved data matches
+  int Nact = 0; //Number of saved atoms
+  double sumDisp = 0; //Sum of the squared displacements
+  histFile >> Nact;
+  if (histFile.fail() || (Nact != (Nqm+Npseudo)))
+  {
+    return 0;
+  }
+  for (int i=0;i<Natoms;i++)
+  {
+    if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+    {
+      int atomID = -1; //Saved atom number
+      string atTyp; //Saved QM atom type
+      Coord atPos; //Saved position
+      histFile >> atomID >> atTyp;
+      histFile >> atPos.x >> atPos.y >> atPos.z;
+      if (histFile.fail() || (atomID != i) || (atTyp != QMMMData[i].QMTyp))
+      {
+        sameAtoms = 0;
+        break;
+      }
+      sumDisp += CoordDist2(QMMMData[i].P[bead],atPos).vecMag();
+    }
+  }
+  if (sameAtoms && (sqrt(sumDisp/Nact) > hessReuseDisp))
+  {
+    //The structure has changed too much
+    sameAtoms = 0;
+  }
+  if (!sameAtoms)
+  {
+    cout << "    The saved optimizer data does not match the structure.";
+    cout << '\n';
+  }
+  return sameAtoms;
+};
+
+void WriteOptFingerprint(fstream& histFile, vector<QMMMAtom>& QMMMData,
+                         int bead)
+{
+  //Saves the QM and PB atoms used to build an inverse Hessian
+  histFile << (Nqm+Npseudo) << '\n';
+  for (int i=0;i<Natoms;i++)
+  {
+    if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+    {
+      histFile << i << " " << QMMMData[i].QMTyp;
+      histFile << " " << LICHEMFormFloat(QMMMData[i].P[bead].x,16);
+      histFile << " " << LICHEMFormFloat(QMMMData[i].P[bead].y,16);
+      histFile << " " << LICHEMFormFloat(QMMMData[i].P[bead].z,16);
+      histFile << '\n';
+    }
+  }
+  return;
+};
+
+bool ReadInvHessian(MatrixXd& iHess, vector<QMMMAtom>& QMMMData, int bead)
+{
+  //Reads a saved inverse Hessian for bead
+  bool hessRead = 0; //Flag to show if the file was usable
+  fstream hessFile; //Checkpoint file
+  stringstream call; //Stream for file names
+  call.str("");
+  call << "LICHM_" << bead << ".ihess";
+  if (!CheckFile(call.str()))
+  {
+    //No checkpoint
+    return hessRead;
+  }
+  hessFile.open(call.str().c_str(),ios_base::in);
+  if (!CheckOptFingerprint(hessFile,QMMMData,bead))
+  {
+    //The Hessian belongs to a different structure
+    hessFile.close();
+    return hessRead;
+  }
+  int Nrows = 0; //Size of the saved matrix
+  hessFile >> Nrows;
+  if (Nrows == iHess.rows())
+  {
+    //Read the matrix
+    MatrixXd tmpHess(Nrows,Nrows); //Temporary storage
+    for (int i=0;i<Nrows;i++)
+    {
+      for (int j=0;j<Nrows;j++)
+      {
+        hessFile >> tmpHess(i,j);
+      }
+    }
+    if (!hessFile.fail())
+    {
+      //Only keep complete matrices
+      iHess = tmpHess;
+      hessRead = 1;
+    }
+  }
+  hessFile.close();
+  return hessRead;
+};
+
+void WriteInvHessian(MatrixXd& iHess, vector<QMMMAtom>& QMMMData,
+                     int bead)
+{
+  //Saves the inverse Hessian for later optimizations of bead
+  fstream hessFile; //Checkpoint file
+  stringstream call; //Stream for file names
+  call.str("");
+  call << "LICHM_" << bead << ".ihess";
+  hessFile.open(call.str().c_str(),ios_base::out);
+  WriteOptFingerprint(hessFile,QMMMData,bead);
+  hessFile << iHess.rows() << '\n';
+  for (int i=0;i<iHess.rows();i++)
+  {
+    for (int j=0;j<iHess.cols();j++)
+    {
+      hessFile << " " << LICHEMFormFloat(iHess(i,j),16);
+    }
+    hessFile << '\n';
+  }
+  hessFile.flush();
+  hessFile.close();
+  return;
+};
+
+bool ReadLBFGSHist(vector<VectorXd>& stepHist, vector<VectorXd>& gradHist,
+                   vector<QMMMAtom>& QMMMData, int Ndof, int maxHist,
+                   int bead)
+{
+  //Reads a saved L-BFGS history for bead
+  bool histRead = 0; //Flag to show if the file was usable
+  fstream histFile; //Checkpoint file
+  stringstream call; //Stream for file names
+  call.str("");
+  call << "LICHM_" << bead << ".lbfgs";
+  if (!CheckFile(call.str()))
+  {
+    //No checkpoint
+    return histRead;
+  }
+  histFile.open(call.str().c_str(),ios_base::in);
+  if (!CheckOptFingerprint(histFile,QMMMData,bead))
+  {
+    //The history belongs to a different structure
+    histFile.close();
+    return histRead;
+  }
+  int Npairs = 0; //Number of saved correction pairs
+  int Nrows = 0; //Size of the saved vectors
+  histFile >> Npairs >> Nrows;
+  if (Nrows == Ndof)
+  {
+    //Read the correction pairs
+    vector<VectorXd> tmpSteps; //Temporary storage
+    vector<VectorXd> tmpGrads; //Temporary storage
+    for (int k=0;k<Npairs;k++)
+    {
+      VectorXd stepVec(Ndof); //Saved step
+      VectorXd gradDiff(Ndof); //Saved change in the gradient
+      for (int i=0;i<Ndof;i++)
+      {
+        histFile >> stepVec(i);
+      }
+      for (int i=0;i<Ndof;i++)
+      {
+        histFile >> gradDiff(i);
+      }
+      tmpSteps.push_back(stepVec);
+      tmpGrads.push_back(gradDiff);
+    }
+    while ((int)tmpSteps.size() > maxHist)
+    {
+      //Remove the oldest pairs if the memory was reduced
+      tmpSteps.erase(tmpSteps.begin());
+      tmpGrads.erase(tmpGrads.begin());
+    }
+    if (!histFile.fail())
+    {
+      //Only keep complete histories
+      stepHist = tmpSteps;
+      gradHist = tmpGrads;
+      histRead = 1;
+    }
+  }
+  histFile.close();
+  return histRead;
+};
+
+void WriteLBFGSHist(vector<VectorXd>& stepHist, vector<VectorXd>& gradHist,
+                    vector<QMMMAtom>& QMMMData, int bead)
+{
+  //Saves the L-BFGS history for later optimizations of bead
+  fstream histFile; //Checkpoint file
+  stringstream call; //Stream for file names
+  call.str("");
+  call << "LICHM_" << bead << ".lbfgs";
+  histFile.open(call.str().c_str(),ios_base::out);
+  WriteOptFingerprint(histFile,QMMMData,bead);
+  int Ndof = 3*(Nqm+Npseudo); //Number of QM and PB degrees of freedom
+  histFile << stepHist.size() << " " << Ndof << '\n';
+  for (unsigned int k=0;k<stepHist.size();k++)
+  {
+    for (int i=0;i<Ndof;i++)
+    {
+      histFile << " " << LICHEMFormFloat(stepHist[k](i),16);
+    }
+    histFile << '\n';
+    for (int i=0;i<Ndof;i++)
+    {
+      histFile << " " << LICHEMFormFloat(gradHist[k](i),16);
+    }
+    histFile << '\n';
+  }
+  histFile.flush();
+  histFile.close();
+  return;
+};
+
+//Microiteration utility functions
+bool MMRelaxNeeded(vector<QMMMAtom>& QMMMData, vector<QMMMAtom>& oldQMMMData,
+                   QMMMSettings& QMMMOpts, double relaxTol, int bead)
+{
+  //Checks if the MM environment needs to be relaxed after a QM step
+  bool relaxMM = 0; //Flag to run the MM optimization
+  //Find the largest displacement of the QM and PB atoms
+  double maxDisp = 0; //Largest displacement
+  for (int i=0;i<Natoms;i++)
+  {
+    if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+    {
+      double RDisp; //Displacement of atom i
+      RDisp = CoordDist2(QMMMData[i].P[bead],oldQMMMData[i].P[bead]).vecMag();
+      RDisp = sqrt(RDisp);
+      if (RDisp > maxDisp)
+      {
+        maxDisp = RDisp;
+      }
+    }
+  }
+  if (QMMMOpts.MMOptTol < relaxTol)
+  {
+    //The MM tolerance was tightened since the last MM relaxation
+    relaxMM = 1;
+  }
+  else if (maxDisp >= QMMMOpts.MMSkipDisp)
+  {
+    //The QM charges moved too far
+    relaxMM = 1;
+  }
+  else if (TINKER)
+  {
+    //Check the MM forces in the field of the current QM charges
+    VectorXd MMForces(3*Natoms); //Forces on the MM atoms
+    MMForces.setZero();
+    int tStart = (unsigned)time(0);
+    TINKERMMForces(QMMMData,MMForces,QMMMOpts,bead);
+    MMTime += (unsigned)time(0)-tStart;
+    int Nact = 0; //Number of active MM and BA atoms
+    for (int i=0;i<Natoms;i++)
+    {
+      if ((QMMMData[i].MMRegion || QMMMData[i].BARegion) &&
+         (!QMMMData[i].frozen))
+      {
+        Nact += 1;
+      }
+    }
+    if (Nact > 0)
+    {
+      //Compare the RMS gradient (kcal/mol/Ang) to the MM tolerance
+      double RMSGrad; //RMS gradient per atom
+      RMSGrad = sqrt(MMForces.squaredNorm()/Nact)/kcal2eV;
+      if (RMSGrad >= QMMMOpts.MMOptTol)
+      {
+        relaxMM = 1;
+      }
+    }
+  }
+  else
+  {
+    //No MM gradient test is available
+    relaxMM = 1;
+  }
+  return relaxMM;
+};
+
+//Energy and force utility functions
+double LICHEMEnergy(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts,
+                    int bead)
+{
+  //Calculates the total QM and MM energy of a bead
+  double E = 0; //Energy
+  //Calculate QM energy
+  if (Gaussian)
+  {
+    int tStart = (unsigned)time(0);
+    E += GaussianEnergy(QMMMData,QMMMOpts,bead);
+    QMTime += (unsigned)time(0)-tStart;
+  }
+  if (PSI4)
+  {
+    int tStart = (unsigned)time(0);
+    E += PSI4Energy(QMMMData,QMMMOpts,bead);
+    QMTime += (unsigned)time(0)-tStart;
+    //Delete annoying useless files
+    globalSys = system("rm -f psi.* timer.*");
+  }
+  if (NWChem)
+  {
+    int tStart = (unsigned)time(0);
+    E += NWChemEnergy(QMMMData,QMMMOpts,bead);
+    QMTime += (unsigned)time(0)-tStart;
+  }
+  //Calculate MM energy
+  if (TINKER)
+  {
+    int tStart = (unsigned)time(0);
+    E += TINKEREnergy(QMMMData,QMMMOpts,bead);
+    MMTime += (unsigned)time(0)-tStart;
+  }
+  if (LAMMPS)
+  {
+    int tStart = (unsigned)time(0);
+    E += LAMMPSEnergy(QMMMData,QMMMOpts,bead);
+    MMTime += (unsigned)time(0)-tStart;
+  }
+  return E;
+};
+
+double LICHEMForces(vector<QMMMAtom>& QMMMData, VectorXd& forces,
+                    QMMMSettings& QMMMOpts, int bead)
+{
+  //Adds the QM and MM forces on the QM and PB atoms of a bead
+  double E = 0; //Energy
+  //Calculate forces (QM part)
+  if (Gaussian)
+  {
+    int tStart = (unsigned)time(0);
+    E += GaussianForces(QMMMData,forces,QMMMOpts,bead);
+    QMTime += (unsigned)time(0)-tStart;
+  }
+  if (PSI4)
+  {
+    int tStart = (unsigned)time(0);
+    E += PSI4Forces(QMMMData,forces,QMMMOpts,bead);
+    QMTime += (unsigned)time(0)-tStart;
+    //Delete annoying useless files
+    globalSys = system("rm -f psi.* timer.*");
+  }
+  if (NWChem)
+  {
+    int tStart = (unsigned)time(0);
+    E += NWChemForces(QMMMData,forces,QMMMOpts,bead);
+    QMTime += (unsigned)time(0)-tStart;
+  }
+  //Calculate forces (MM part)
+  if (TINKER)
+  {
+    int tStart = (unsigned)time(0);
+    E += TINKERForces(QMMMData,forces,QMMMOpts,bead);
+    if (AMOEBA || QMMMOpts.useImpSolv)
+    {
+      //Forces from MM polarization
+      E += TINKERPolForces(QMMMData,forces,QMMMOpts,bead);
+    }
+    MMTime += (unsigned)time(0)-tStart;
+  }
+  if (LAMMPS)
+  {
+    int tStart = (unsigned)time(0);
+    E += LAMMPSForces(QMMMData,forces,QMMMOpts,bead);
+    MMTime += (unsigned)time(0)-tStart;
+  }
+  return E;
+};
+
+double LICHEMBeadForces(vector<QMMMAtom>& QMMMData, VectorXd& beadForces,
+                        QMMMSettings& QMMMOpts, int bead)
+{
+  /*
+    Calculates the QM+MM energy of a bead and the forces on all atoms for
+    the Monte Carlo moves. The timers are updated atomically, since the
+    beads of several chains can be calculated at the same time.
+  */
+  int Ndof = 3*(Nqm+Npseudo); //Number of QM and PB degrees of freedom
+  double Eqm = 0; //QM energy
+  double Emm = 0; //MM energy
+  int qmTime = 0; //Time spent in the QM wrappers
+  int mmTime = 0; //Time spent in the MM wrappers
+  //Create blank force arrays
+  VectorXd forces(Ndof); //Forces on the QM and PB atoms
+  forces.setZero();
+  beadForces.resize(3*Natoms);
+  beadForces.setZero();
+  //Calculate forces (QM part)
+  if (Gaussian)
+  {
+    int tStart = (unsigned)time(0);
+    Eqm += GaussianForces(QMMMData,forces,QMMMOpts,bead);
+    qmTime += (unsigned)time(0)-tStart;
+  }
+  if (PSI4)
+  {
+    int tStart = (unsigned)time(0);
+    Eqm += PSI4Forces(QMMMData,forces,QMMMOpts,bead);
+    qmTime += (unsigned)time(0)-tStart;
+    //Delete annoying useless files
+    globalSys = system("rm -f psi.* timer.*");
+  }
+  if (NWChem)
+  {
+    int tStart = (unsigned)time(0);
+    Eqm += NWChemForces(QMMMData,forces,QMMMOpts,bead);
+    qmTime += (unsigned)time(0)-tStart;
+  }
+  //Calculate forces (MM part)
+  if (TINKER)
+  {
+    int tStart = (unsigned)time(0);
+    TINKERForces(QMMMData,forces,QMMMOpts,bead);
+    if (AMOEBA || QMMMOpts.useImpSolv)
+    {
+      //Forces from MM polarization
+      TINKERPolForces(QMMMData,forces,QMMMOpts,bead);
+    }
+    Emm += TINKEREnergy(QMMMData,QMMMOpts,bead);
+    mmTime += (unsigned)time(0)-tStart;
+  }
+  if (LAMMPS)
+  {
+    int tStart = (unsigned)time(0);
+    LAMMPSForces(QMMMData,forces,QMMMOpts,bead);
+    Emm += LAMMPSEnergy(QMMMData,QMMMOpts,bead);
+    mmTime += (unsigned)time(0)-tStart;
+  }
+  //Save QM forces to the array for all atoms
+  int ct = 0; //Generic counter
+  for (int i=0;i<Natoms;i++)
+  {
+    if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+    {
+      beadForces(3*i) = forces(ct);
+      beadForces(3*i+1) = forces(ct+1);
+      beadForces(3*i+2) = forces(ct+2);
+      ct += 3;
+    }
+  }
+  //Add MM forces
+  if (TINKER)
+  {
+    int tStart = (unsigned)time(0);
+    TINKERMMForces(QMMMData,beadForces,QMMMOpts,bead);
+    mmTime += (unsigned)time(0)-tStart;
+  }
+  #pragma omp atomic
+  QMTime += qmTime;
+  #pragma omp atomic
+  MMTime += mmTime;
+  return Eqm+Emm;
+};
+
 //Optimizer functions
 void LICHEMSteepest(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts,
                     int bead)
@@ -343,6 +1008,26 @@ void LICHEMDFP(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int bead)
   forces.setZero();
   //Create an identity matrix as the initial Hessian
   iHess.setIdentity(); //Already an "inverse" Hessian
+  MatrixXd iHessStart(Ndof,Ndof); //Inverse Hessian used for restarts
+  iHessStart.setIdentity(); //Already an "inverse" Hessian
+  int sdSteps = 15; //Number of initial steepest descent steps
+  if (QMMMOpts.reuseHess && ReadInvHessian(iHess,QMMMData,bead))
+  {
+    //Continue from the previous optimization
+    cout << "    Reusing the saved inverse Hessian..." << '\n';
+    sdSteps = 0;
+  }
+  if ((QMMMOpts.initHess == "lindh") ||
+     ((QMMMOpts.initHess == "calc") && (sdSteps > 0)))
+  {
+    //Start from a model or calculated Hessian
+    iHessStart = InitInvHessian(QMMMData,QMMMOpts,bead);
+    if (sdSteps > 0)
+    {
+      iHess = iHessStart;
+      sdSteps = 0;
+    }
+  }
   //Initialize optimization variables
   double stepScale; //Local copy
   double E = 0; //Energy
@@ -393,7 +1078,10 @@ void LICHEMDFP(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int bead)
   vecMax = 0; //Using this variable to avoid creating a new one
   vecMax = forces.squaredNorm(); //Calculate initial RMS force
   vecMax = sqrt(vecMax/Ndof);
-  cout << "    Performing a steepest descent step..." << '\n';
+  if (sdSteps > 0)
+  {
+    cout << "    Performing a steepest descent step..." << '\n';
+  }
   cout << "    QM step: 0";
   cout << " | RMS force: " << LICHEMFormFloat(vecMax,12);
   cout << " eV/\u212B";
@@ -402,7 +1090,10 @@ void LICHEMDFP(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int bead)
   //Optimize structure
   EOld = E; //Save energy
   stepScale = QMMMOpts.stepScale;
-  stepScale *= sdScale; //Take a very small first step
+  if (sdSteps > 0)
+  {
+    stepScale *= sdScale; //Take a very small first step
+  }
   while ((!optDone) && (stepCt < QMMMOpts.maxOptSteps))
   {
     E = 0; // Reinitialize energy
@@ -495,13 +1186,19 @@ void LICHEMDFP(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int bead)
     }
     //Update Hessian
     gradDiff -= forces;
-    if (((stepCt%30) == 0) || (stepCt < 15))
+    bool newHess = (stepCt < sdSteps); //Flag to rebuild the Hessian
+    if (((stepCt%30) == 0) && ((stepCt > 0) || (sdSteps > 0)))
+    {
+      //Periodically rebuild the Hessian
+      newHess = 1;
+    }
+    if (newHess)
     {
       //Build a new Hessian after 30 steps
       cout << "    Performing a steepest descent step...";
       cout << '\n';
       //Shrink step size
-      if ((stepCt < 15) && (E < EOld))
+      if ((stepCt < sdSteps) && (E < EOld))
       {
         //Reduce step size
         stepScale = sdScale*QMMMOpts.stepScale; //Small step
@@ -516,8 +1213,8 @@ void LICHEMDFP(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int bead)
       {
         stepScale = 0.25*sdScale*QMMMOpts.stepScale;
       }
-      //Create new Hessian as an identity matrix
-      iHess.setIdentity(); //Already an "inverse" Hessian
+      //Restart from the initial Hessian
+      iHess = iHessStart;
     }
     else if (((stepCt+1)%30) == 0)
     {
@@ -540,8 +1237,8 @@ void LICHEMDFP(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int bead)
       {
         stepScale = 0.25*sdScale*QMMMOpts.stepScale;
       }
-      //Create new Hessian as an identity matrix
-      iHess.setIdentity(); //Already an "inverse" Hessian
+      //Restart from the initial Hessian
+      iHess = iHessStart;
     }
     else if (E < EOld)
     {
@@ -582,7 +1279,7 @@ void LICHEMDFP(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int bead)
       {
         stepScale = 0.25*sdScale*QMMMOpts.stepScale;
       }
-      iHess.setIdentity(); //Already an "inverse" Hessian
+      iHess = iHessStart;
     }
     //Save energy
     EOld = E;
@@ -590,6 +1287,286 @@ void LICHEMDFP(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int bead)
     stepCt += 1;
     optDone = OptConverged(QMMMData,oldQMMMData,forces,stepCt,QMMMOpts,bead,1);
   }
+  if (QMMMOpts.reuseHess)
+  {
+    //Save the inverse Hessian for the next optimization
+    WriteInvHessian(iHess,QMMMData,bead);
+  }
+  //Clean up files
+  call.str("");
+  call << "rm -f QMOpt_" << bead << ".xyz";
+  call << " MMCharges_" << bead << ".txt";
+  globalSys = system(call.str().c_str());
+  //Finish and return
+  return;
+};
+
+void LICHEMLBFGS(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts,
+                 int bead)
+{
+  //Limited-memory BFGS optimizer with a backtracking line search
+  stringstream call; //Stream for system calls and reading/writing files
+  int stepCt = 0; //Counter for optimization steps
+  fstream qmFile; //Generic file stream
+  int Ndof = 3*(Nqm+Npseudo); //Number of QM and PB degrees of freedom
+  double armijo = 1e-4; //Sufficient decrease parameter
+  double minLineStep = 0.05; //Smallest line search step before a restart
+  double stepScale = QMMMOpts.stepScale; //Steepest descent step size
+  double minScale = 0.001*QMMMOpts.stepScale; //Smallest SD step size
+  //Initialize charges
+  if (Nmm > 0)
+  {
+    WriteChargeFile(QMMMData,QMMMOpts,bead);
+  }
+  //Initialize QM trajectory file
+  call.str("");
+  call << "QMOpt_" << bead << ".xyz";
+  qmFile.open(call.str().c_str(),ios_base::out);
+  //Create L-BFGS arrays
+  vector<VectorXd> stepHist; //Saved steps
+  vector<VectorXd> gradHist; //Saved changes in the gradient
+  VectorXd optVec(Ndof); //Optimization direction
+  VectorXd forces(Ndof); //Forces at the current structure
+  VectorXd oldForces(Ndof); //Forces at the last accepted structure
+  //Initialize arrays
+  optVec.setZero();
+  forces.setZero();
+  //Initialize optimization variables
+  double E = 0; //Energy
+  double EOld = 0; //Energy of the last accepted structure
+  double lineStep = 1; //Fraction of the optimization vector
+  double vecMax = 0; //Maxium atomic displacement
+  bool optDone = 0; //Flag to end the optimization
+  bool newDirec = 1; //Flag to calculate a new optimization direction
+  vector<QMMMAtom> oldQMMMData = QMMMData; //Last accepted structure
+  int maxHist = QMMMOpts.LBFGSMem; //Local copy
+  if (QMMMOpts.reuseHess &&
+     ReadLBFGSHist(stepHist,gradHist,QMMMData,Ndof,maxHist,bead))
+  {
+    //Continue from the previous optimization
+    cout << "    Reusing the saved L-BFGS history..." << '\n';
+  }
+  //Calculate forces (QM part)
+  if (Gaussian)
+  {
+    int tStart = (unsigned)time(0);
+    E += GaussianForces(QMMMData,forces,QMMMOpts,bead);
+    QMTime += (unsigned)time(0)-tStart;
+  }
+  if (PSI4)
+  {
+    int tStart = (unsigned)time(0);
+    E += PSI4Forces(QMMMData,forces,QMMMOpts,bead);
+    QMTime += (unsigned)time(0)-tStart;
+    //Delete annoying useless files
+    globalSys = system("rm -f psi.* timer.*");
+  }
+  if (NWChem)
+  {
+    int tStart = (unsigned)time(0);
+    E += NWChemForces(QMMMData,forces,QMMMOpts,bead);
+    QMTime += (unsigned)time(0)-tStart;
+  }
+  //Calculate forces (MM part)
+  if (TINKER)
+  {
+    int tStart = (unsigned)time(0);
+    E += TINKERForces(QMMMData,forces,QMMMOpts,bead);
+    if (AMOEBA || QMMMOpts.useImpSolv)
+    {
+      //Forces from MM polarization
+      E += TINKERPolForces(QMMMData,forces,QMMMOpts,bead);
+    }
+    MMTime += (unsigned)time(0)-tStart;
+  }
+  if (LAMMPS)
+  {
+    int tStart = (unsigned)time(0);
+    E += LAMMPSForces(QMMMData,forces,QMMMOpts,bead);
+    MMTime += (unsigned)time(0)-tStart;
+  }
+  //Output initial RMS force
+  vecMax = forces.squaredNorm(); //Calculate initial RMS force
+  vecMax = sqrt(vecMax/Ndof);
+  cout << "    QM step: 0";
+  cout << " | RMS force: " << LICHEMFormFloat(vecMax,12);
+  cout << " eV/\u212B";
+  cout << '\n' << '\n';
+  cout.flush();
+  //Optimize structure
+  EOld = E; //Save energy
+  oldForces = forces; //Save forces
+  while ((!optDone) && (stepCt < QMMMOpts.maxOptSteps))
+  {
+    if (newDirec)
+    {
+      //Calculate a new optimization direction
+      optVec = LBFGSDirection(oldForces,stepHist,gradHist);
+      if (stepHist.size() == 0)
+      {
+        //Steepest descent step
+        optVec *= stepScale;
+      }
+      if (optVec.dot(oldForces) <= 0)
+      {
+        //The direction is uphill, restart from steepest descent
+        cout << "    Uphill L-BFGS direction. Clearing the history...";
+        cout << '\n';
+        stepHist.clear();
+        gradHist.clear();
+        optVec = stepScale*oldForces;
+      }
+      //Check step size
+      vecMax = optVec.norm();
+      if (vecMax > QMMMOpts.maxStep)
+      {
+        //Scale step size
+        optVec *= (QMMMOpts.maxStep/vecMax);
+      }
+      lineStep = 1; //Start with the full step
+      newDirec = 0;
+    }
+    //Update positions
+    E = 0; //Reinitialize energy
+    QMMMData = oldQMMMData; //Start from the last accepted structure
+    int ct = 0; //Counter
+    for (int i=0;i<Natoms;i++)
+    {
+      //Move QM atoms
+      if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+      {
+        QMMMData[i].P[bead].x += lineStep*optVec(ct);
+        QMMMData[i].P[bead].y += lineStep*optVec(ct+1);
+        QMMMData[i].P[bead].z += lineStep*optVec(ct+2);
+        ct += 3;
+      }
+    }
+    //Calculate forces (QM part)
+    forces.setZero();
+    if (Gaussian)
+    {
+      int tStart = (unsigned)time(0);
+      E += GaussianForces(QMMMData,forces,QMMMOpts,bead);
+      QMTime += (unsigned)time(0)-tStart;
+    }
+    if (PSI4)
+    {
+      int tStart = (unsigned)time(0);
+      E += PSI4Forces(QMMMData,forces,QMMMOpts,bead);
+      QMTime += (unsigned)time(0)-tStart;
+      //Delete annoying useless files
+      globalSys = system("rm -f psi.* timer.*");
+    }
+    if (NWChem)
+    {
+      int tStart = (unsigned)time(0);
+      E += NWChemForces(QMMMData,forces,QMMMOpts,bead);
+      QMTime += (unsigned)time(0)-tStart;
+    }
+    //Calculate forces (MM part)
+    if (TINKER)
+    {
+      int tStart = (unsigned)time(0);
+      E += TINKERForces(QMMMData,forces,QMMMOpts,bead);
+      if (AMOEBA || QMMMOpts.useImpSolv)
+      {
+        //Forces from MM polarization
+        E += TINKERPolForces(QMMMData,forces,QMMMOpts,bead);
+      }
+      MMTime += (unsigned)time(0)-tStart;
+    }
+    if (LAMMPS)
+    {
+      int tStart = (unsigned)time(0);
+      E += LAMMPSForces(QMMMData,forces,QMMMOpts,bead);
+      MMTime += (unsigned)time(0)-tStart;
+    }
+    stepCt += 1;
+    //Check for a sufficient decrease in the energy (Armijo condition)
+    bool accStep = 0; //Flag to accept the step
+    double slope = optVec.dot(oldForces); //Decrease along the direction
+    if (E <= (EOld-armijo*lineStep*slope))
+    {
+      accStep = 1;
+    }
+    else if (lineStep > minLineStep)
+    {
+      //Backtrack along the optimization direction
+      cout << "    Energy did not decrease. Reducing the step size...";
+      cout << '\n';
+      double newStep; //Minimum of the interpolating quadratic
+      newStep = slope*lineStep*lineStep;
+      newStep /= 2*(E-EOld+slope*lineStep);
+      //Keep the new step within safe bounds
+      if (newStep < (0.1*lineStep))
+      {
+        newStep = 0.1*lineStep;
+      }
+      if (newStep > (0.5*lineStep))
+      {
+        newStep = 0.5*lineStep;
+      }
+      lineStep = newStep;
+    }
+    else if (stepHist.size() > 0)
+    {
+      //Line search failed, restart from steepest descent
+      cout << "    Line search failed. Clearing the history...";
+      cout << '\n';
+      stepHist.clear();
+      gradHist.clear();
+      newDirec = 1;
+    }
+    else
+    {
+      //Reject the uphill step and retry with a shorter steepest descent step
+      QMMMData = oldQMMMData;
+      stepScale *= 0.25;
+      newDirec = 1;
+      if (stepScale < minScale)
+      {
+        //The energy cannot be lowered along the forces
+        cout << "    Line search failed. Stopping at the last structure...";
+        cout << '\n';
+        optDone = 1;
+      }
+      else
+      {
+        cout << "    Line search failed. Reducing the step size...";
+        cout << '\n';
+      }
+    }
+    if (accStep)
+    {
+      //Update the history
+      VectorXd stepVec = lineStep*optVec; //Actual displacement
+      VectorXd gradDiff = oldForces-forces; //Change in the gradient
+      LBFGSUpdate(stepVec,gradDiff,stepHist,gradHist,QMMMOpts.LBFGSMem);
+      //Print structure
+      Print_traj(QMMMData,qmFile,QMMMOpts);
+      //Check convergence
+      optDone = OptConverged(QMMMData,oldQMMMData,forces,stepCt,QMMMOpts,
+                             bead,1);
+      //Save structure, energy, and forces
+      oldQMMMData = QMMMData;
+      oldForces = forces;
+      EOld = E;
+      newDirec = 1;
+      //Recover the steepest descent step size
+      stepScale *= 1.20;
+      if (stepScale > QMMMOpts.stepScale)
+      {
+        stepScale = QMMMOpts.stepScale;
+      }
+    }
+  }
+  //Make sure the last accepted structure is kept
+  QMMMData = oldQMMMData;
+  if (QMMMOpts.reuseHess)
+  {
+    //Save the history for the next optimization
+    WriteLBFGSHist(stepHist,gradHist,QMMMData,bead);
+  }
   //Clean up files
   call.str("");
   call << "rm -f QMOpt_" << bead << ".xyz";
@@ -21,6 +21,103 @@
 ///@{
 
 //Path integral Monte Carlo functions
+void PICopyToSlots(vector<QMMMAtom>& QMMMData, vector<QMMMAtom>& slotData,
+                   int firstSlot, int Nbeads)
+{
+  /*
+    Copies the beads to the wrapper replicas firstSlot to firstSlot+Nbeads-1.
+    Concurrent Monte Carlo chains use different replicas, so their wrapper
+    input, output, and checkpoint files never collide.
+  */
+  slotData = QMMMData;
+  #pragma omp parallel for schedule(dynamic)
+  for (int i=0;i<Natoms;i++)
+  {
+    slotData[i].P.resize(firstSlot+Nbeads,QMMMData[i].P[0]);
+    slotData[i].MP.resize(firstSlot+Nbeads,QMMMData[i].MP[0]);
+    slotData[i].PC.resize(firstSlot+Nbeads,QMMMData[i].PC[0]);
+    for (int j=0;j<Nbeads;j++)
+    {
+      slotData[i].P[firstSlot+j] = QMMMData[i].P[j];
+      slotData[i].MP[firstSlot+j] = QMMMData[i].MP[j];
+      slotData[i].PC[firstSlot+j] = QMMMData[i].PC[j];
+    }
+  }
+  return;
+};
+
+void PICopyFromSlots(vector<QMMMAtom>& QMMMData, vector<QMMMAtom>& slotData,
+                     int firstSlot, int Nbeads)
+{
+  //Copies the multipoles updated by the wrappers back to the beads
+  #pragma omp parallel for schedule(dynamic)
+  for (int i=0;i<Natoms;i++)
+  {
+    for (int j=0;j<Nbeads;j++)
+    {
+      QMMMData[i].MP[j] = slotData[i].MP[firstSlot+j];
+      QMMMData[i].PC[j] = slotData[i].PC[firstSlot+j];
+    }
+  }
+  return;
+};
+
+double Get_PI_Escreen(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
+{
+  //Inexpensive screening potential for delayed acceptance
+  double E = 0.0;
+  if (QMMMOpts.MCScreenFunc != "MM")
+  {
+    //Use a lower level QM method
+    QMMMSettings screenOpts = QMMMOpts; //Copy of the settings
+    screenOpts.func = QMMMOpts.MCScreenFunc;
+    if (QMMMOpts.MCScreenBasis != "N/A")
+    {
+      screenOpts.basis = QMMMOpts.MCScreenBasis;
+    }
+    E = Get_PI_Epot(QMMMData,screenOpts);
+    return E;
+  }
+  //Fix parallel for classical MC
+  int mcThreads = omp_get_max_threads(); //Threads of this chain
+  if (QMMMOpts.NBeads == 1)
+  {
+    mcThreads = 1;
+  }
+  //Move the beads to the wrapper replicas of the chain
+  int slot0 = QMMMOpts.PISlot; //First wrapper replica
+  vector<QMMMAtom> slotData; //Structure in the wrapper replicas
+  if (slot0 > 0)
+  {
+    PICopyToSlots(QMMMData,slotData,slot0,QMMMOpts.NBeads);
+  }
+  vector<QMMMAtom>& MMData = (slot0 > 0) ? slotData : QMMMData;
+  //Calculate the MM energy
+  int mmTime = 0; //Local timer for concurrent chains
+  #pragma omp parallel for schedule(dynamic) num_threads(mcThreads) \
+          reduction(+:E,mmTime)
+  for (int p=0;p<QMMMOpts.NBeads;p++)
+  {
+    double Es = 0.0;
+    int t_mm_start = (unsigned)time(0); //Timer variable
+    if (TINKER)
+    {
+      Es += TINKEREnergy(MMData,QMMMOpts,slot0+p);
+    }
+    if (LAMMPS)
+    {
+      Es += LAMMPSEnergy(MMData,QMMMOpts,slot0+p);
+    }
+    E += Es;
+    mmTime += (unsigned)time(0)-t_mm_start;
+  }
+  #pragma omp atomic
+  MMTime += mmTime;
+  //Calculate the average energy
+  E /= QMMMOpts.NBeads;
+  return E;
+};
+
 double Get_PI_Espring(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
 {
   //Calculate total harmonic PI ring energy
@@ -51,101 +148,634 @@ double Get_PI_Espring(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
   return E;
 };
 
+VectorXd Get_PI_BeadEspring(vector<QMMMAtom>& QMMMData,
+                            QMMMSettings& QMMMOpts)
+{
+  //Calculate the harmonic energy of each bond in the PI rings
+  VectorXd EBeads(QMMMOpts.NBeads); //Energy between beads j-1 and j
+  double wZero; //Mass-independent force constant
+  wZero = 1/(QMMMOpts.beta*hbar);
+  wZero *= wZero*toeV*QMMMOpts.NBeads;
+  #pragma omp parallel for schedule(dynamic)
+  for (int j=0;j<QMMMOpts.NBeads;j++)
+  {
+    int j2 = j-1;
+    if (j2 == -1)
+    {
+      j2 = QMMMOpts.NBeads-1; //Ring PBC
+    }
+    EBeads(j) = 0;
+    for (int i=0;i<Natoms;i++)
+    {
+      //Calculate displacement with PBC
+      double dr2; //Squared displacement
+      dr2 = CoordDist2(QMMMData[i].P[j],QMMMData[i].P[j2]).vecMag();
+      EBeads(j) += 0.5*wZero*QMMMData[i].m*dr2; //Harmonic energy
+    }
+  }
+  return EBeads;
+};
+
 double Get_PI_Epot(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
 {
   //Potential for all beads
   double E = 0.0;
+  double EQM = 0.0; //Sum of the QM energies
+  double EMM = 0.0; //Sum of the MM energies
   //Fix parallel for classical MC
-  int mcThreads = Nthreads;
+  int mcThreads = omp_get_max_threads(); //Threads of this chain
   if (QMMMOpts.NBeads == 1)
   {
     mcThreads = 1;
   }
+  //Check for ring polymer contraction
+  int NQMBeads = QMMMOpts.NBeads; //Number of beads for the QM wrappers
+  vector<QMMMAtom> QMMMDataQM; //Contracted ring polymers
+  if ((QMMMOpts.NQMBeads > 0) && (QMMMOpts.NQMBeads < QMMMOpts.NBeads) &&
+     (QMonly || QMMM))
+  {
+    NQMBeads = QMMMOpts.NQMBeads;
+    QMMMDataQM = PIContractRing(QMMMData,QMMMOpts,NQMBeads);
+  }
+  vector<QMMMAtom>& QMRing = (NQMBeads < QMMMOpts.NBeads) ?
+                             QMMMDataQM : QMMMData; //Structure for the QM
+  //Move the beads to the wrapper replicas of the chain
+  int slot0 = QMMMOpts.PISlot; //First wrapper replica
+  vector<QMMMAtom> slotData; //Structure in the wrapper replicas
+  vector<QMMMAtom> slotDataQM; //Contracted rings in the wrapper replicas
+  if (slot0 > 0)
+  {
+    PICopyToSlots(QMMMData,slotData,slot0,QMMMOpts.NBeads);
+    if (NQMBeads < QMMMOpts.NBeads)
+    {
+      PICopyToSlots(QMMMDataQM,slotDataQM,slot0,NQMBeads);
+    }
+  }
+  vector<QMMMAtom>& MMData = (slot0 > 0) ? slotData : QMMMData;
+  vector<QMMMAtom>& QMData = (slot0 == 0) ? QMRing :
+                             ((NQMBeads < QMMMOpts.NBeads) ?
+                             slotDataQM : slotData);
   //Calculate energy
+  int qmTime = 0; //Local timer for concurrent chains
+  int mmTime = 0; //Local timer for concurrent chains
   #pragma omp parallel for schedule(dynamic) num_threads(mcThreads) \
-          reduction(+:E,QMTime,MMTime)
+          reduction(+:EQM,EMM,qmTime,mmTime)
   for (int p=0;p<QMMMOpts.NBeads;p++)
   {
     //Run the wrappers for all beads
-    double Es = 0.0;
+    double Eqm = 0.0;
+    double Emm = 0.0;
     //Timer variables
     int t_qm_start = 0;
     int t_mm_start = 0;
     int times_qm = 0;
     int times_mm = 0;
     //Calculate QM energy
-    if (Gaussian)
+    if (p < NQMBeads)
     {
-      t_qm_start = (unsigned)time(0);
-      Es += GaussianEnergy(QMMMData,QMMMOpts,p);
-      times_qm += (unsigned)time(0)-t_qm_start;
-    }
-    if (PSI4)
-    {
-      t_qm_start = (unsigned)time(0);
-      Es += PSI4Energy(QMMMData,QMMMOpts,p);
-      times_qm += (unsigned)time(0)-t_qm_start;
-      //Delete annoying useless files
-      globalSys = system("rm -f psi.* timer.*");
-    }
-    if (NWChem)
-    {
-      t_qm_start = (unsigned)time(0);
-      Es += NWChemEnergy(QMMMData,QMMMOpts,p);
-      times_qm += (unsigned)time(0)-t_qm_start;
+      if (Gaussian)
+      {
+        t_qm_start = (unsigned)time(0);
+        Eqm += GaussianEnergy(QMData,QMMMOpts,slot0+p);
+        times_qm += (unsigned)time(0)-t_qm_start;
+      }
+      if (PSI4)
+      {
+        t_qm_start = (unsigned)time(0);
+        Eqm += PSI4Energy(QMData,QMMMOpts,slot0+p);
+        times_qm += (unsigned)time(0)-t_qm_start;
+        //Delete annoying useless files
+        globalSys = system("rm -f psi.* timer.*");
+      }
+      if (NWChem)
+      {
+        t_qm_start = (unsigned)time(0);
+        Eqm += NWChemEnergy(QMData,QMMMOpts,slot0+p);
+        times_qm += (unsigned)time(0)-t_qm_start;
+      }
     }
     //Calculate MM energy
     if (TINKER)
     {
       t_mm_start = (unsigned)time(0);
-      Es += TINKEREnergy(QMMMData,QMMMOpts,p);
+      Emm += TINKEREnergy(MMData,QMMMOpts,slot0+p);
       times_mm += (unsigned)time(0)-t_mm_start;
     }
     if (LAMMPS)
     {
       t_mm_start = (unsigned)time(0);
-      Es += LAMMPSEnergy(QMMMData,QMMMOpts,p);
+      Emm += LAMMPSEnergy(MMData,QMMMOpts,slot0+p);
       times_mm += (unsigned)time(0)-t_mm_start;
     }
     //Add temp variables to the totals
-    E += Es;
-    QMTime += times_qm;
-    MMTime += times_mm;
+    EQM += Eqm;
+    EMM += Emm;
+    qmTime += times_qm;
+    mmTime += times_mm;
+  }
+  #pragma omp atomic
+  QMTime += qmTime;
+  #pragma omp atomic
+  MMTime += mmTime;
+  if (slot0 > 0)
+  {
+    //Save the charges from the wrappers
+    PICopyFromSlots(QMMMData,slotData,slot0,QMMMOpts.NBeads);
+    if (NQMBeads < QMMMOpts.NBeads)
+    {
+      PICopyFromSlots(QMMMDataQM,slotDataQM,slot0,NQMBeads);
+    }
+  }
+  if (NQMBeads < QMMMOpts.NBeads)
+  {
+    //Copy the QM charges from the nearest contracted bead
+    #pragma omp parallel for schedule(dynamic)
+    for (int i=0;i<Natoms;i++)
+    {
+      if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+      {
+        for (int j=0;j<QMMMOpts.NBeads;j++)
+        {
+          int k = ((2*j*NQMBeads+QMMMOpts.NBeads)/(2*QMMMOpts.NBeads));
+          k = k%NQMBeads; //Ring PBC
+          QMMMData[i].MP[j].q = QMMMDataQM[i].MP[k].q;
+        }
+      }
+    }
   }
   //Calculate the average energy
+  E = (EQM/NQMBeads)+(EMM/QMMMOpts.NBeads);
+  return E;
+};
+
+double Get_PI_Forces(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts,
+                     vector<VectorXd>& allForces)
+{
+  //Potential energy and forces for all beads
+  double E = 0.0; //Sum of the bead energies
+  //Fix parallel for classical MC
+  int mcThreads = omp_get_max_threads(); //Threads of this chain
+  if (QMMMOpts.NBeads == 1)
+  {
+    mcThreads = 1;
+  }
+  //Move the beads to the wrapper replicas of the chain
+  int slot0 = QMMMOpts.PISlot; //First wrapper replica
+  vector<QMMMAtom> slotData; //Structure in the wrapper replicas
+  if (slot0 > 0)
+  {
+    PICopyToSlots(QMMMData,slotData,slot0,QMMMOpts.NBeads);
+  }
+  vector<QMMMAtom>& beadData = (slot0 > 0) ? slotData : QMMMData;
+  allForces.resize(QMMMOpts.NBeads);
+  #pragma omp parallel for schedule(dynamic) num_threads(mcThreads) \
+          reduction(+:E)
+  for (int p=0;p<QMMMOpts.NBeads;p++)
+  {
+    E += LICHEMBeadForces(beadData,allForces[p],QMMMOpts,slot0+p);
+  }
+  if (slot0 > 0)
+  {
+    //Save the charges from the wrappers
+    PICopyFromSlots(QMMMData,slotData,slot0,QMMMOpts.NBeads);
+  }
+  //Return the average energy
   E /= QMMMOpts.NBeads;
   return E;
 };
 
+vector<QMMMAtom> PIContractRing(vector<QMMMAtom>& QMMMData,
+                                QMMMSettings& QMMMOpts, int NQMBeads)
+{
+  /*
+    Function to contract the ring polymers onto fewer beads. The bead
+    positions are expanded in the free ring normal modes and the Fourier
+    series is truncated to the modes which can be represented with the
+    smaller ring. Multipoles are copied from the nearest full bead.
+  */
+  int P = QMMMOpts.NBeads; //Local copy of the number of beads
+  vector<QMMMAtom> QMMMDataQM; //Contracted ring polymers
+  QMMMDataQM = QMMMData;
+  //Build the contraction matrix
+  MatrixXd contMat(NQMBeads,P); //Maps the full ring onto the smaller ring
+  contMat.setZero();
+  for (int k=0;k<NQMBeads;k++)
+  {
+    double tk = ((double)k)/NQMBeads; //Position on the contracted ring
+    for (int j=0;j<P;j++)
+    {
+      double tj = ((double)j)/P; //Position on the full ring
+      //Centroid mode
+      contMat(k,j) = 1.0/P;
+      for (int m=1;(2*m)<=NQMBeads;m++)
+      {
+        //Pairs of cosine and sine modes
+        double cosK = cos(2*pi*m*tk);
+        double cosJ = cos(2*pi*m*tj);
+        double sinK = sin(2*pi*m*tk);
+        double sinJ = sin(2*pi*m*tj);
+        if ((2*m) == NQMBeads)
+        {
+          //The highest mode of an even ring only has a cosine
+          sinK = 0;
+        }
+        contMat(k,j) += 2*(cosK*cosJ+sinK*sinJ)/P;
+      }
+    }
+  }
+  //Update positions
+  #pragma omp parallel for schedule(dynamic)
+  for (int i=0;i<Natoms;i++)
+  {
+    //Unwrap the ring with respect to the first bead
+    MatrixXd beadPos(P,3); //Bead positions
+    for (int j=0;j<P;j++)
+    {
+      Coord dist = CoordDist2(QMMMData[i].P[j],QMMMData[i].P[0]);
+      beadPos(j,0) = QMMMData[i].P[0].x+dist.x;
+      beadPos(j,1) = QMMMData[i].P[0].y+dist.y;
+      beadPos(j,2) = QMMMData[i].P[0].z+dist.z;
+    }
+    MatrixXd contPos = contMat*beadPos; //Contracted positions
+    QMMMDataQM[i].P.resize(NQMBeads);
+    QMMMDataQM[i].MP.resize(NQMBeads);
+    QMMMDataQM[i].PC.resize(NQMBeads);
+    for (int k=0;k<NQMBeads;k++)
+    {
+      //Nearest bead on the full ring
+      int j = ((2*k*P+NQMBeads)/(2*NQMBeads))%P;
+      QMMMDataQM[i].P[k].x = contPos(k,0);
+      QMMMDataQM[i].P[k].y = contPos(k,1);
+      QMMMDataQM[i].P[k].z = contPos(k,2);
+      QMMMDataQM[i].MP[k] = QMMMData[i].MP[j];
+      QMMMDataQM[i].PC[k] = QMMMData[i].PC[j];
+    }
+  }
+  return QMMMDataQM;
+};
+
+double PIModeMove(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int p,
+                  double step)
+{
+  /*
+    Function to move the internal normal modes of a ring polymer. The free
+    ring is sampled exactly, so the acceptance only depends on the change
+    in the potential energy. The returned spring energy change is removed
+    from the Metropolis criterion.
+  */
+  int P = QMMMOpts.NBeads; //Local copy of the number of beads
+  double w; //Mass-scaled force constant
+  w = 1/(QMMMOpts.beta*hbar);
+  w *= w*toeV*P*QMMMData[p].m;
+  //Normal modes of the free ring polymer
+  MatrixXd ringMat(P,P); //Connectivity of the ring
+  ringMat.setZero();
+  for (int j=0;j<P;j++)
+  {
+    int j2 = j-1;
+    if (j2 == -1)
+    {
+      j2 = P-1; //Ring PBC
+    }
+    ringMat(j,j) += 1;
+    ringMat(j2,j2) += 1;
+    ringMat(j,j2) -= 1;
+    ringMat(j2,j) -= 1;
+  }
+  SelfAdjointEigenSolver<MatrixXd> ringModes(ringMat);
+  VectorXd modeVals = ringModes.eigenvalues(); //Scaled mode frequencies
+  MatrixXd modeVecs = ringModes.eigenvectors(); //Orthonormal modes
+  //Unwrap the ring with respect to the first bead
+  MatrixXd beadPos(P,3); //Bead positions
+  for (int j=0;j<P;j++)
+  {
+    Coord dist = CoordDist2(QMMMData[p].P[j],QMMMData[p].P[0]);
+    beadPos(j,0) = QMMMData[p].P[0].x+dist.x;
+    beadPos(j,1) = QMMMData[p].P[0].y+dist.y;
+    beadPos(j,2) = QMMMData[p].P[0].z+dist.z;
+  }
+  MatrixXd modePos = modeVecs.transpose()*beadPos; //Mode amplitudes
+  //Find the mixing ratio for the old and new amplitudes
+  double sigMax = 0; //Largest thermal width of the internal modes
+  for (int k=0;k<P;k++)
+  {
+    if (modeVals(k) > 1e-8)
+    {
+      double sig = 1/sqrt(QMMMOpts.beta*w*modeVals(k)); //Thermal width
+      if (sig > sigMax)
+      {
+        sigMax = sig;
+      }
+    }
+  }
+  double mixNew = 1; //Fraction of the new random amplitudes
+  if (sigMax > step)
+  {
+    //Slowest mode moves by roughly one step
+    mixNew = step/sigMax;
+  }
+  double mixOld = sqrt(1-mixNew*mixNew); //Fraction of the old amplitudes
+  //Resample the internal modes
+  double dE = 0; //Change in the spring energy
+  for (int k=0;k<P;k++)
+  {
+    //Skip the centroid
+    if (modeVals(k) > 1e-8)
+    {
+      double sig = 1/sqrt(QMMMOpts.beta*w*modeVals(k)); //Thermal width
+      for (int i=0;i<3;i++)
+      {
+        double randG = randGen.gauss(QMMMOpts.MCStream); //Random number
+        dE -= 0.5*w*modeVals(k)*modePos(k,i)*modePos(k,i);
+        modePos(k,i) *= mixOld;
+        modePos(k,i) += mixNew*sig*randG;
+        dE += 0.5*w*modeVals(k)*modePos(k,i)*modePos(k,i);
+      }
+    }
+  }
+  //Update positions
+  beadPos = modeVecs*modePos;
+  for (int j=0;j<P;j++)
+  {
+    QMMMData[p].P[j].x = beadPos(j,0);
+    QMMMData[p].P[j].y = beadPos(j,1);
+    QMMMData[p].P[j].z = beadPos(j,2);
+  }
+  return dE;
+};
+
+vector<VectorXd> PIEffForces(vector<QMMMAtom>& QMMMData,
+                             QMMMSettings& QMMMOpts,
+                             vector<VectorXd>& potForces)
+{
+  //Function to add the spring forces to the scaled bead forces
+  int P = QMMMOpts.NBeads; //Local copy of the number of beads
+  vector<VectorXd> effForces = potForces; //Forces of the effective energy
+  double wZero; //Mass-independent force constant
+  wZero = 1/(QMMMOpts.beta*hbar);
+  wZero *= wZero*toeV*P;
+  #pragma omp parallel for schedule(dynamic)
+  for (int p=0;p<P;p++)
+  {
+    //Each bead contributes 1/P of the potential energy
+    effForces[p] /= P;
+    int pPrev = (p+P-1)%P; //Previous bead in the ring
+    int pNext = (p+1)%P; //Next bead in the ring
+    for (int i=0;i<Natoms;i++)
+    {
+      double w = wZero*QMMMData[i].m; //Mass-scaled force constant
+      Coord distPrev = CoordDist2(QMMMData[i].P[p],QMMMData[i].P[pPrev]);
+      Coord distNext = CoordDist2(QMMMData[i].P[p],QMMMData[i].P[pNext]);
+      effForces[p](3*i) -= w*(distPrev.x+distNext.x);
+      effForces[p](3*i+1) -= w*(distPrev.y+distNext.y);
+      effForces[p](3*i+2) -= w*(distPrev.z+distNext.z);
+    }
+  }
+  return effForces;
+};
+
+double PIForceStep(vector<QMMMAtom>& QMMMData, vector<QMMMAtom>& QMMMData2,
+                   QMMMSettings& QMMMOpts, vector<VectorXd>& effForces,
+                   double step)
+{
+  /*
+    Function to create a force-bias (MALA) trial structure. Each bead of
+    the atoms which are not frozen moves along the effective forces plus
+    Gaussian noise, and the log. probability of the move is returned.
+  */
+  int P = QMMMOpts.NBeads; //Local copy of the number of beads
+  double logFwd = 0; //Log. probability of the forward move
+  QMMMData2 = QMMMData;
+  for (int i=0;i<Natoms;i++)
+  {
+    if (!QMMMData[i].frozen)
+    {
+      double sig2 = step*step/QMMMData[i].m; //Variance of the noise
+      double sig = sqrt(sig2); //Width of the noise
+      double drift = 0.5*QMMMOpts.beta*sig2; //Scales the forces
+      for (int p=0;p<P;p++)
+      {
+        double randX = randGen.gauss(QMMMOpts.MCStream);
+        double randY = randGen.gauss(QMMMOpts.MCStream);
+        double randZ = randGen.gauss(QMMMOpts.MCStream);
+        QMMMData2[i].P[p].x += drift*effForces[p](3*i)+sig*randX;
+        QMMMData2[i].P[p].y += drift*effForces[p](3*i+1)+sig*randY;
+        QMMMData2[i].P[p].z += drift*effForces[p](3*i+2)+sig*randZ;
+        logFwd -= 0.5*(randX*randX+randY*randY+randZ*randZ);
+      }
+    }
+  }
+  return logFwd;
+};
+
+double PIForceLogProb(vector<QMMMAtom>& QMMMData, vector<QMMMAtom>& QMMMData2,
+                      QMMMSettings& QMMMOpts, vector<VectorXd>& effForces,
+                      double step)
+{
+  /*
+    Function to find the log. probability that a force-bias move from
+    QMMMData, which has the effective forces effForces, creates QMMMData2.
+    The normalization is the same for all moves and is not included.
+  */
+  int P = QMMMOpts.NBeads; //Local copy of the number of beads
+  double logProb = 0; //Log. probability of the move
+  for (int i=0;i<Natoms;i++)
+  {
+    if (!QMMMData[i].frozen)
+    {
+      double sig2 = step*step/QMMMData[i].m; //Variance of the noise
+      double drift = 0.5*QMMMOpts.beta*sig2; //Scales the forces
+      for (int p=0;p<P;p++)
+      {
+        double dx = QMMMData2[i].P[p].x-QMMMData[i].P[p].x;
+        double dy = QMMMData2[i].P[p].y-QMMMData[i].P[p].y;
+        double dz = QMMMData2[i].P[p].z-QMMMData[i].P[p].z;
+        dx -= drift*effForces[p](3*i);
+        dy -= drift*effForces[p](3*i+1);
+        dz -= drift*effForces[p](3*i+2);
+        logProb -= 0.5*(dx*dx+dy*dy+dz*dz)/sig2;
+      }
+    }
+  }
+  return logProb;
+};
+
+bool PIForceMove(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts,
+                 double step, double& Emc)
+{
+  /*
+    Force-bias (Metropolis adjusted Langevin) move of all atoms which are
+    not frozen. Every bead is displaced along the forces of the effective
+    energy plus Gaussian noise, so one set of force calculations moves the
+    whole system. The acceptance is corrected with the probabilities of
+    the forward and reverse moves. The step size is the width of the noise
+    for an atom with a mass of 1 amu.
+  */
+  bool acc = 0; //Accept or reject
+  int P = QMMMOpts.NBeads; //Local copy of the number of beads
+  //Calculate the forces of the current structure if they were not saved
+  if ((int)QMMMOpts.PIForces.size() != P)
+  {
+    QMMMOpts.EForce = Get_PI_Forces(QMMMData,QMMMOpts,QMMMOpts.PIForces);
+  }
+  vector<VectorXd> oldForces; //Effective forces of the current structure
+  oldForces = PIEffForces(QMMMData,QMMMOpts,QMMMOpts.PIForces);
+  //Move along the forces with random noise
+  vector<QMMMAtom> QMMMData2; //Trial structure
+  double logFwd = PIForceStep(QMMMData,QMMMData2,QMMMOpts,oldForces,step);
+  //Calculate the energy and forces of the trial structure
+  vector<VectorXd> newPotForces; //Bead forces of the trial structure
+  double EPotNew = Get_PI_Forces(QMMMData2,QMMMOpts,newPotForces);
+  vector<VectorXd> newForces; //Effective forces of the trial structure
+  newForces = PIEffForces(QMMMData2,QMMMOpts,newPotForces);
+  //Find the probability of the reverse move
+  double logRev; //Log. probability of the reverse move
+  logRev = PIForceLogProb(QMMMData2,QMMMData,QMMMOpts,newForces,step);
+  //Accept or reject
+  double EOld = QMMMOpts.EForce+Get_PI_Espring(QMMMData,QMMMOpts);
+  double ENew = EPotNew+Get_PI_Espring(QMMMData2,QMMMOpts);
+  double dE = QMMMOpts.beta*(ENew-EOld);
+  dE -= logRev-logFwd; //Correct for the biased moves
+  double randNum = randGen.uniform(QMMMOpts.MCStream);
+  if (randNum <= exp(-1*dE))
+  {
+    //Accept and save the forces
+    QMMMData = QMMMData2;
+    QMMMOpts.PIForces = newPotForces;
+    QMMMOpts.EForce = EPotNew;
+    if (QMMMOpts.ensemble == "NPT")
+    {
+      //Add PV term
+      ENew += QMMMOpts.press*Lx*Ly*Lz;
+    }
+    Emc = ENew;
+    QMMMOpts.EOld = ENew;
+    acc = 1;
+    if (QMMMOpts.MCScreenFunc != "N/A")
+    {
+      //Update the screening energy
+      QMMMOpts.EScreen = Get_PI_Escreen(QMMMData,QMMMOpts);
+    }
+  }
+  else
+  {
+    //Reject
+    Emc = QMMMOpts.EOld;
+  }
+  return acc;
+};
+
+void PIMoveSetup(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
+{
+  //Function to register the PIMC moves and find the active atoms
+  QMMMOpts.MCMoves.clear();
+  QMMMOpts.MCMoves.setAtoms(QMMMData);
+  double beadWeight = QMMMOpts.MCBeadWeight; //Weight of the bead moves
+  double modeWeight = QMMMOpts.MCModeWeight; //Weight of the mode moves
+  if (QMMMOpts.NBeads == 1)
+  {
+    //Classical atoms do not have internal modes
+    modeWeight = 0;
+  }
+  else if (QMMMOpts.PINormModes)
+  {
+    //Replace the bead moves with normal mode moves
+    modeWeight += beadWeight;
+    beadWeight = 0;
+  }
+  if (QMMMOpts.MCMoves.NAtoms() > 0)
+  {
+    //Single atom moves
+    QMMMOpts.MCMoves.addMove("Bead",beadWeight,mcStep,stepMin,stepMax);
+    QMMMOpts.MCMoves.addMove("Mode",modeWeight,mcStep,stepMin,stepMax);
+    QMMMOpts.MCMoves.addMove("Force",QMMMOpts.MCForceWeight,mcStep,stepMin,
+                             stepMax);
+    if (Natoms > 1)
+    {
+      //Translations of an isolated atom do not change the energy
+      QMMMOpts.MCMoves.addMove("Centroid",QMMMOpts.MCCentWeight,
+                               mcStep*centRatio,stepMin*centRatio,
+                               stepMax*centRatio);
+    }
+  }
+  if ((QMMMOpts.MCMoves.NMols() > 0) && (Natoms > 1))
+  {
+    //Rigid molecule moves
+    QMMMOpts.MCMoves.addMove("Molecule",QMMMOpts.MCMolWeight,
+                             mcStep*centRatio,stepMin*centRatio,
+                             stepMax*centRatio);
+  }
+  if (QMMMOpts.ensemble == "NPT")
+  {
+    //Volume changes
+    QMMMOpts.MCMoves.addMove("Volume",QMMMOpts.MCVolWeight,mcStep,stepMin,
+                             stepMax);
+  }
+  if (QMMMOpts.MCMoves.NMoves() == 0)
+  {
+    //Nothing can be moved
+    cout << "Error: None of the Monte Carlo moves can be used for this";
+    cout << " system!";
+    cout << '\n' << '\n';
+    cout.flush();
+    //Quit
+    exit(0);
+  }
+  return;
+};
+
+void PIPrintMoves(QMMMSettings& QMMMOpts, bool totStats)
+{
+  //Function to print the step sizes and acceptance ratios of the moves
+  for (int k=0;k<QMMMOpts.MCMoves.NMoves();k++)
+  {
+    double ratio = QMMMOpts.MCMoves.accRatio(k); //Acceptance ratio
+    if (totStats)
+    {
+      //Use all moves since the last reset
+      ratio = QMMMOpts.MCMoves.totRatio(k);
+    }
+    cout << "   " << setw(8) << left << QMMMOpts.MCMoves.getName(k) << right;
+    cout << " | Probability: ";
+    cout << LICHEMFormFloat(QMMMOpts.MCMoves.getProb(k),6);
+    cout << " | Step size: ";
+    cout << LICHEMFormFloat(QMMMOpts.MCMoves.getStep(k),6);
+    cout << " \u212B | Accept ratio: ";
+    cout << LICHEMFormFloat(ratio,6);
+    cout << '\n';
+  }
+  return;
+};
+
 bool MCMove(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, double& Emc)
 {
   //Function to perform Monte Carlo moves and accept/reject the moves
   bool acc = 0; //Accept or reject
+  //Pick a random move from the catalogue
+  int moveID = QMMMOpts.MCMoves.pickMove(QMMMOpts.MCStream); //Type of move
+  string moveTyp = QMMMOpts.MCMoves.getName(moveID); //Name of the move
+  double step = QMMMOpts.MCMoves.getStep(moveID); //Step size of the move
+  if (moveTyp == "Force")
+  {
+    //Move all atoms along the forces
+    acc = PIForceMove(QMMMData,QMMMOpts,step,Emc);
+    QMMMOpts.MCMoves.update(moveID,acc);
+    return acc;
+  }
   //Copy QMMMData
   vector<QMMMAtom> QMMMData2;
   QMMMData2 = QMMMData;
-  //Pick random move and apply PBC
-  double randNum = (((double)rand())/((double)RAND_MAX));
-  if (randNum > (1-centProb))
+  double randNum; //Random number
+  if (moveTyp == "Centroid")
   {
     //Move a centroid
-    int p;
-    bool frozenAt = 1;
-    while (frozenAt)
-    {
-      //Make sure the atom is not frozen
-      p = (rand()%Natoms);
-      if (QMMMData2[p].frozen == 0)
-      {
-        frozenAt = 0;
-      }
-    }
-    double randX = (((double)rand())/((double)RAND_MAX));
-    double randY = (((double)rand())/((double)RAND_MAX));
-    double randZ = (((double)rand())/((double)RAND_MAX));
-    double dx = 2*(randX-0.5)*mcStep*centRatio;
-    double dy = 2*(randY-0.5)*mcStep*centRatio;
-    double dz = 2*(randZ-0.5)*mcStep*centRatio;
+    int p = QMMMOpts.MCMoves.pickAtom(QMMMOpts.MCStream); //Active atom
+    double randX = randGen.uniform(QMMMOpts.MCStream);
+    double randY = randGen.uniform(QMMMOpts.MCStream);
+    double randZ = randGen.uniform(QMMMOpts.MCStream);
+    double dx = 2*(randX-0.5)*step;
+    double dy = 2*(randY-0.5)*step;
+    double dz = 2*(randZ-0.5)*step;
     //Update positions
     #pragma omp parallel
     {
@@ -167,34 +797,111 @@ bool MCMove(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, double& Emc)
     }
     #pragma omp barrier
   }
-  if (randNum < beadProb)
+  double ESample = 0; //Spring energy change which was sampled exactly
+  if (moveTyp == "Bead")
   {
     //Move all beads in a centroid
-    int p;
-    bool frozenAt = 1;
-    while (frozenAt)
-    {
-      //Make sure the atom is not frozen
-      p = (rand()%Natoms);
-      if (QMMMData2[p].frozen == 0)
-      {
-        frozenAt = 0;
-      }
-    }
+    int p = QMMMOpts.MCMoves.pickAtom(QMMMOpts.MCStream); //Active atom
     for (int i=0;i<QMMMOpts.NBeads;i++)
     {
       //Randomly displace each bead
-      double randX = (((double)rand())/((double)RAND_MAX));
-      double randY = (((double)rand())/((double)RAND_MAX));
-      double randZ = (((double)rand())/((double)RAND_MAX));
-      double dx = 2*(randX-0.5)*mcStep;
-      double dy = 2*(randY-0.5)*mcStep;
-      double dz = 2*(randZ-0.5)*mcStep;
+      double randX = randGen.uniform(QMMMOpts.MCStream);
+      double randY = randGen.uniform(QMMMOpts.MCStream);
+      double randZ = randGen.uniform(QMMMOpts.MCStream);
+      double dx = 2*(randX-0.5)*step;
+      double dy = 2*(randY-0.5)*step;
+      double dz = 2*(randZ-0.5)*step;
       QMMMData2[p].P[i].x += dx;
       QMMMData2[p].P[i].y += dy;
       QMMMData2[p].P[i].z += dz;
     }
   }
+  if (moveTyp == "Mode")
+  {
+    //Move the internal modes of the ring
+    int p = QMMMOpts.MCMoves.pickAtom(QMMMOpts.MCStream); //Active atom
+    ESample = PIModeMove(QMMMData2,QMMMOpts,p,step);
+  }
+  if (moveTyp == "Molecule")
+  {
+    //Rigid translation and rotation of a molecule
+    //Pick the atoms in the molecule
+    vector<int>& mol = QMMMOpts.MCMoves.pickMol(QMMMOpts.MCStream);
+    int molSize = (int)mol.size(); //Number of atoms in the molecule
+    //Find the centroids relative to the first atom
+    MatrixXd relPos(molSize,3); //Centroid positions
+    Coord cent0; //Centroid of the first atom
+    cent0.x = 0;
+    cent0.y = 0;
+    cent0.z = 0;
+    for (int j=0;j<QMMMOpts.NBeads;j++)
+    {
+      cent0.x += QMMMData2[mol[0]].P[j].x/QMMMOpts.NBeads;
+      cent0.y += QMMMData2[mol[0]].P[j].y/QMMMOpts.NBeads;
+      cent0.z += QMMMData2[mol[0]].P[j].z/QMMMOpts.NBeads;
+    }
+    for (int k=0;k<molSize;k++)
+    {
+      Coord centK; //Centroid of atom k
+      centK.x = 0;
+      centK.y = 0;
+      centK.z = 0;
+      for (int j=0;j<QMMMOpts.NBeads;j++)
+      {
+        centK.x += QMMMData2[mol[k]].P[j].x/QMMMOpts.NBeads;
+        centK.y += QMMMData2[mol[k]].P[j].y/QMMMOpts.NBeads;
+        centK.z += QMMMData2[mol[k]].P[j].z/QMMMOpts.NBeads;
+      }
+      Coord dist = CoordDist2(centK,cent0); //Displacement with PBC
+      relPos(k,0) = dist.x;
+      relPos(k,1) = dist.y;
+      relPos(k,2) = dist.z;
+    }
+    //Move the origin to the center of the molecule
+    Vector3d molCent = relPos.colwise().mean().transpose(); //Center
+    double molRad = 0; //Largest distance from the center
+    for (int k=0;k<molSize;k++)
+    {
+      relPos.row(k) -= molCent.transpose();
+      if (relPos.row(k).norm() > molRad)
+      {
+        molRad = relPos.row(k).norm();
+      }
+    }
+    //Random rotation which moves the outer atoms by up to one step
+    double maxAng = 0; //Largest rotation angle
+    if (molRad > 0)
+    {
+      maxAng = step/molRad;
+    }
+    Vector3d rotAxis; //Axis of rotation
+    rotAxis(0) = randGen.gauss(QMMMOpts.MCStream);
+    rotAxis(1) = randGen.gauss(QMMMOpts.MCStream);
+    rotAxis(2) = randGen.gauss(QMMMOpts.MCStream);
+    rotAxis.normalize();
+    randNum = randGen.uniform(QMMMOpts.MCStream);
+    Matrix3d rotMat; //Rotation matrix
+    rotMat = AngleAxisd(2*(randNum-0.5)*maxAng,rotAxis).toRotationMatrix();
+    //Random translation
+    Vector3d transVec; //Displacement of the center
+    for (int i=0;i<3;i++)
+    {
+      randNum = randGen.uniform(QMMMOpts.MCStream);
+      transVec(i) = 2*(randNum-0.5)*step;
+    }
+    //Shift all beads of each atom with its centroid
+    for (int k=0;k<molSize;k++)
+    {
+      Vector3d oldPos = relPos.row(k).transpose(); //Position in the molecule
+      Vector3d shift = (rotMat*oldPos)+transVec-oldPos; //Centroid change
+      for (int j=0;j<QMMMOpts.NBeads;j++)
+      {
+        QMMMData2[mol[k]].P[j].x += shift(0);
+        QMMMData2[mol[k]].P[j].y += shift(1);
+        QMMMData2[mol[k]].P[j].z += shift(2);
+      }
+    }
+  }
   //Initialize energies
   double EOld = QMMMOpts.EOld;
   double ENew = 0;
@@ -203,32 +910,31 @@ bool MCMove(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, double& Emc)
   double LySave = Ly;
   double LzSave = Lz;
   //Attempt a volume move
-  randNum = (((double)rand())/((double)RAND_MAX));
-  if (randNum < volProb)
+  if (moveTyp == "Volume")
   {
     //Anisotropic volume change
     if (isotrop == 0)
     {
       //Assumes that MM cutoffs are safe
-      randNum = (((double)rand())/((double)RAND_MAX));
-      Lx += 2*(randNum-0.5)*mcStep;
-      randNum = (((double)rand())/((double)RAND_MAX));
-      Ly += 2*(randNum-0.5)*mcStep;
-      randNum = (((double)rand())/((double)RAND_MAX));
-      Lz += 2*(randNum-0.5)*mcStep;
+      randNum = randGen.uniform(QMMMOpts.MCStream);
+      Lx += 2*(randNum-0.5)*step;
+      randNum = randGen.uniform(QMMMOpts.MCStream);
+      Ly += 2*(randNum-0.5)*step;
+      randNum = randGen.uniform(QMMMOpts.MCStream);
+      Lz += 2*(randNum-0.5)*step;
     }
     //Isotropic volume change
     if (isotrop == 1)
     {
       //Assumes that MM cutoffs are safe
-      randNum = (((double)rand())/((double)RAND_MAX));
-      Lx += 2*(randNum-0.5)*mcStep;
-      Ly += 2*(randNum-0.5)*mcStep;
-      Lz += 2*(randNum-0.5)*mcStep;
+      randNum = randGen.uniform(QMMMOpts.MCStream);
+      Lx += 2*(randNum-0.5)*step;
+      Ly += 2*(randNum-0.5)*step;
+      Lz += 2*(randNum-0.5)*step;
     }
     //Decide how to scale the centroids
     bool scaleRing = 0; //Shift the ring
-    randNum = (((double)rand())/((double)RAND_MAX));
+    randNum = randGen.uniform(QMMMOpts.MCStream);
     if (randNum >= 0.5)
     {
       //Evenly scale the size of the ring
@@ -439,37 +1145,97 @@ bool MCMove(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, double& Emc)
       #pragma omp barrier
     }
   }
-  //Update energies
-  ENew += Get_PI_Epot(QMMMData2,QMMMOpts);
-  ENew += Get_PI_Espring(QMMMData2,QMMMOpts);
+  //Draw the random number for the Metropolis test
+  randNum = randGen.uniform(QMMMOpts.MCStream);
+  //Calculate the inexpensive energy terms
+  double ECheap = Get_PI_Espring(QMMMData2,QMMMOpts); //Spring and PV terms
+  double volTerm = 0; //Nln(V) term
   if (QMMMOpts.ensemble == "NPT")
   {
     //Add PV energy term
-    ENew += QMMMOpts.press*Lx*Ly*Lz;
-  }
-  //Accept or reject
-  double dE = QMMMOpts.beta*(ENew-EOld);
-  if (QMMMOpts.ensemble == "NPT")
-  {
+    ECheap += QMMMOpts.press*Lx*Ly*Lz;
     //Add Nln(V) term
-    double volTerm;
     volTerm = Lx*Ly*Lz; //New volume
     volTerm /= LxSave*LySave*LzSave; //Divide by old volume
     volTerm = log(volTerm); //Take the natural logarithm
     volTerm *= Natoms*QMMMOpts.NBeads; //Scale by number of particles
-    dE -= volTerm; //Subtract from the energy
   }
-  double prob = exp(-1*dE);
-  randNum = (((double)rand())/((double)RAND_MAX));
-  if (randNum <= prob)
+  bool skipPot = 0; //Flag to skip the potential energy calculations
+  bool screen = (QMMMOpts.MCScreenFunc != "N/A"); //Delayed acceptance
+  double ECheapOld = 0; //Old spring and PV terms
+  if ((QMMMOpts.MCRejectBound > 0) || screen)
   {
-    //Accept
-    QMMMData = QMMMData2;
-    Emc = ENew;
-    QMMMOpts.EOld = ENew;
-    acc = 1;
+    ECheapOld = Get_PI_Espring(QMMMData,QMMMOpts);
+    if (QMMMOpts.ensemble == "NPT")
+    {
+      ECheapOld += QMMMOpts.press*LxSave*LySave*LzSave;
+    }
   }
-  else
+  if (QMMMOpts.MCRejectBound > 0)
+  {
+    //Check if the move fails for any bounded potential change
+    double dEMin; //Smallest possible change in the effective energy
+    dEMin = ECheap-ECheapOld-ESample-QMMMOpts.MCRejectBound;
+    dEMin *= QMMMOpts.beta;
+    dEMin -= volTerm;
+    if (randNum > exp(-1*dEMin))
+    {
+      //The move cannot be accepted
+      skipPot = 1;
+    }
+  }
+  //First stage of delayed acceptance
+  double dEScreen = 0; //Change in the effective energy from the screen
+  double EScreen = 0; //Screening potential of the trial structure
+  if (screen && (!skipPot))
+  {
+    #pragma omp atomic
+    NScreenTry += 1;
+    EScreen = Get_PI_Escreen(QMMMData2,QMMMOpts);
+    dEScreen = ECheap+EScreen-ECheapOld-QMMMOpts.EScreen-ESample;
+    dEScreen *= QMMMOpts.beta;
+    dEScreen -= volTerm;
+    if (randNum > exp(-1*dEScreen))
+    {
+      //Rejected by the screening Hamiltonian
+      skipPot = 1;
+    }
+    else
+    {
+      //Draw a new random number for the second stage
+      #pragma omp atomic
+      NScreenPass += 1;
+      randNum = randGen.uniform(QMMMOpts.MCStream);
+    }
+  }
+  //Accept or reject
+  if (!skipPot)
+  {
+    //Update energies
+    ENew += Get_PI_Epot(QMMMData2,QMMMOpts);
+    ENew += ECheap;
+    double dE = QMMMOpts.beta*(ENew-EOld-ESample);
+    dE -= volTerm; //Subtract the Nln(V) term from the energy
+    dE -= dEScreen; //Correct for the first stage
+    double prob = exp(-1*dE);
+    if (randNum <= prob)
+    {
+      //Accept
+      QMMMData = QMMMData2;
+      Emc = ENew;
+      QMMMOpts.EOld = ENew;
+      QMMMOpts.PIForces.clear(); //The saved forces are out of date
+      acc = 1;
+      if (screen)
+      {
+        //Save the screening energy
+        QMMMOpts.EScreen = EScreen;
+        #pragma omp atomic
+        NScreenAcc += 1;
+      }
+    }
+  }
+  if (!acc)
   {
     //Reject
     Emc = EOld;
@@ -478,10 +1244,411 @@ bool MCMove(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, double& Emc)
     Ly = LySave;
     Lz = LzSave;
   }
+  //Update the statistics of the move
+  QMMMOpts.MCMoves.update(moveID,acc);
   //Return decision
   return acc;
 };
 
+void LICHEMReplicaExchange(vector<QMMMAtom>& QMMMData,
+                           QMMMSettings& QMMMOpts, fstream& traj)
+{
+  /*
+    Replica exchange (parallel tempering) PIMC. Each replica has its own
+    random number stream and wrapper replicas, so the replicas move
+    concurrently and share the wrapper budget. The replicas only wait for
+    each other when neighboring temperatures attempt to swap structures,
+    when the step sizes are checked, and when the output is printed.
+    The trajectory of the lowest temperature is written to the output file.
+  */
+  stringstream call; //Stream for system calls and reading/writing files
+  int NRep = QMMMOpts.NReplicas; //Local copy of the number of replicas
+  //Divide the wrapper budget between the replicas
+  int repThreads = min(NRep,Nthreads); //Replicas which move at once
+  int beadThreads = Nthreads/repThreads; //Bead threads for each replica
+  if (beadThreads < 1)
+  {
+    beadThreads = 1;
+  }
+  int savedLevels = omp_get_max_active_levels(); //Saved OpenMP setting
+  omp_set_max_active_levels(2);
+  //Set up the replicas
+  vector<MCWalker> reps(NRep); //Replicas at each temperature
+  for (int r=0;r<NRep;r++)
+  {
+    reps[r].setup(QMMMData,QMMMOpts,r+1);
+    //Geometric temperature ladder
+    double tempRatio = QMMMOpts.maxTemp/QMMMOpts.temp; //Range of temps.
+    reps[r].QMMMOpts.temp = QMMMOpts.temp*pow(tempRatio,((double)r)/(NRep-1));
+    reps[r].QMMMOpts.beta = 1/(kBoltz*reps[r].QMMMOpts.temp);
+    //Read restart information
+    call.str("");
+    call << "ReplicaStruct_" << r << ".xyz";
+    reps[r].readRestart(call.str());
+  }
+  //Calculate the initial energies
+  #pragma omp parallel for schedule(dynamic) num_threads(repThreads)
+  for (int r=0;r<NRep;r++)
+  {
+    omp_set_num_threads(beadThreads);
+    reps[r].initEnergy();
+  }
+  VectorXd swapTry(NRep); //Exchange attempts with the next temperature
+  VectorXd swapAcc(NRep); //Accepted exchanges with the next temperature
+  swapTry.setZero();
+  swapAcc.setZero();
+  //Find the number of characters to print for the step counter
+  int simCharLen;
+  simCharLen = QMMMOpts.NEq+QMMMOpts.NSteps;
+  simCharLen = LICHEMCount(simCharLen);
+  //Run the simulation
+  cout << "Replica exchange Monte Carlo equilibration:" << '\n';
+  cout.flush();
+  int Ntot = QMMMOpts.NEq+QMMMOpts.NSteps; //Total number of steps
+  int Nct = 0; //Steps completed by all replicas
+  int swapStart = 0; //Alternates between even and odd pairs
+  while (Nct < Ntot)
+  {
+    bool prodRun = (Nct >= QMMMOpts.NEq); //Production or equilibration
+    if (Nct == QMMMOpts.NEq)
+    {
+      //Start production run
+      cout << " Equilibration complete." << '\n';
+      cout << '\n';
+      cout << "Replica exchange Monte Carlo production:" << '\n';
+      cout.flush();
+      for (int r=0;r<NRep;r++)
+      {
+        reps[r].resetStats();
+      }
+      swapTry.setZero();
+      swapAcc.setZero();
+    }
+    //Find the next step which needs all of the replicas
+    int Nsync = Ntot; //Next exchange, step size check, or print
+    int NexNext = ((Nct/QMMMOpts.NExchange)+1)*QMMMOpts.NExchange;
+    Nsync = min(Nsync,NexNext);
+    if (!prodRun)
+    {
+      Nsync = min(Nsync,QMMMOpts.NEq);
+      Nsync = min(Nsync,((Nct/acc_Check)+1)*acc_Check);
+    }
+    else
+    {
+      int prodCt = Nct-QMMMOpts.NEq; //Completed production steps
+      prodCt = ((prodCt/QMMMOpts.NPrint)+1)*QMMMOpts.NPrint;
+      Nsync = min(Nsync,QMMMOpts.NEq+prodCt);
+    }
+    //Move the replicas concurrently
+    #pragma omp parallel for schedule(dynamic) num_threads(repThreads)
+    for (int r=0;r<NRep;r++)
+    {
+      omp_set_num_threads(beadThreads);
+      for (int k=Nct;k<Nsync;k++)
+      {
+        reps[r].move(prodRun);
+      }
+    }
+    Nct = Nsync;
+    if ((!prodRun) && ((Nct%acc_Check) == 0))
+    {
+      //Print statistics and adjust the step sizes
+      cout << " | Step: " << setw(simCharLen) << Nct;
+      cout << " | Accept ratios:";
+      for (int r=0;r<NRep;r++)
+      {
+        double accRatio = reps[r].Nacc/(reps[r].Nrej+reps[r].Nacc);
+        cout << " " << LICHEMFormFloat(accRatio,4);
+        reps[r].adaptStep();
+      }
+      cout << '\n';
+      cout.flush();
+    }
+    //Attempt exchanges between neighboring temperatures
+    if ((Nct%QMMMOpts.NExchange) == 0)
+    {
+      for (int r=swapStart;r<(NRep-1);r+=2)
+      {
+        MCWalker& repI = reps[r]; //Lower temperature
+        MCWalker& repJ = reps[r+1]; //Higher temperature
+        //Separate the potential and spring energies
+        double Vi = repI.QMMMOpts.EOld; //Potential energy
+        Vi -= Get_PI_Espring(repI.QMMMData,repI.QMMMOpts);
+        double Vj = repJ.QMMMOpts.EOld; //Potential energy
+        Vj -= Get_PI_Espring(repJ.QMMMData,repJ.QMMMOpts);
+        //Effective energies after the exchange
+        double ENewI = Vj; //New energy of the lower temperature
+        ENewI += Get_PI_Espring(repJ.QMMMData,repI.QMMMOpts);
+        double ENewJ = Vi; //New energy of the higher temperature
+        ENewJ += Get_PI_Espring(repI.QMMMData,repJ.QMMMOpts);
+        double dE = repI.QMMMOpts.beta*(ENewI-repI.QMMMOpts.EOld);
+        dE += repJ.QMMMOpts.beta*(ENewJ-repJ.QMMMOpts.EOld);
+        swapTry(r) += 1;
+        if (randGen.uniform() <= exp(-1*dE))
+        {
+          //Swap the structures
+          swapAcc(r) += 1;
+          repI.QMMMData.swap(repJ.QMMMData);
+          swap(repI.QMMMOpts.EScreen,repJ.QMMMOpts.EScreen);
+          swap(repI.QMMMOpts.EForce,repJ.QMMMOpts.EForce);
+          repI.QMMMOpts.PIForces.swap(repJ.QMMMOpts.PIForces);
+          repI.QMMMOpts.EOld = ENewI;
+          repJ.QMMMOpts.EOld = ENewJ;
+        }
+      }
+      swapStart = 1-swapStart;
+    }
+    //Print trajectory and restart files
+    if (prodRun && (((Nct-QMMMOpts.NEq)%QMMMOpts.NPrint) == 0))
+    {
+      for (int r=0;r<NRep;r++)
+      {
+        call.str("");
+        call << "ReplicaStruct_" << r << ".xyz";
+        reps[r].writeRestart(call.str());
+      }
+      Print_traj(reps[0].QMMMData,traj,QMMMOpts);
+      cout << " | Step: " << setw(simCharLen) << (Nct-QMMMOpts.NEq);
+      cout << " | Energy: " << LICHEMFormFloat(reps[0].lastE,12);
+      cout << " eV" << '\n';
+      cout.flush();
+    }
+  }
+  if (QMMMOpts.NSteps == 0)
+  {
+    cout << " Equilibration complete." << '\n';
+  }
+  //Save the final structures
+  for (int r=0;r<NRep;r++)
+  {
+    call.str("");
+    call << "ReplicaStruct_" << r << ".xyz";
+    reps[r].writeRestart(call.str());
+  }
+  //Print statistics for each temperature
+  cout << '\n';
+  if (QMMMOpts.NBeads > 1)
+  {
+    cout << "PI";
+  }
+  cout << "MC replica exchange statistics:" << '\n';
+  for (int r=0;r<NRep;r++)
+  {
+    cout << " | T: " << LICHEMFormFloat(reps[r].QMMMOpts.temp,8) << " K";
+    if (reps[r].NSamp > 0)
+    {
+      cout << " | Average energy: " << LICHEMFormFloat(reps[r].avgE(),12);
+      cout << " eV | Variance: " << LICHEMFormFloat(reps[r].varE(),8);
+      cout << " eV\u00B2";
+    }
+    cout << '\n';
+    cout << "   Acceptance ratio: ";
+    cout << LICHEMFormFloat((reps[r].Nacc/(reps[r].Nrej+reps[r].Nacc)),6);
+    if ((r < (NRep-1)) && (swapTry(r) > 0))
+    {
+      cout << " | Exchange ratio: ";
+      cout << LICHEMFormFloat((swapAcc(r)/swapTry(r)),6);
+    }
+    cout << '\n';
+    PIPrintMoves(reps[r].QMMMOpts,1);
+  }
+  cout << '\n';
+  cout.flush();
+  //Clean up the wrapper files and return the lowest temperature replica
+  for (int r=0;r<NRep;r++)
+  {
+    reps[r].clearSlots();
+  }
+  omp_set_max_active_levels(savedLevels);
+  QMMMData = reps[0].QMMMData;
+  return;
+};
+
+void LICHEMMultiWalker(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts,
+                       fstream& traj)
+{
+  /*
+    Runs independent PIMC walkers of the same system in one process. Each
+    walker keeps its own structure, step sizes, random number stream,
+    wrapper replicas, and statistics, so the walkers move at the same time
+    and share the wrapper budget. The averages are pooled over the walkers,
+    and the spread of the walker averages gives the error bars.
+  */
+  stringstream call; //Stream for system calls and reading/writing files
+  int NWalk = QMMMOpts.NWalkers; //Local copy of the number of walkers
+  //Divide the wrapper budget between the walkers
+  int walkThreads = min(NWalk,Nthreads); //Walkers which move at once
+  int beadThreads = Nthreads/walkThreads; //Bead threads for each walker
+  if (beadThreads < 1)
+  {
+    beadThreads = 1;
+  }
+  int savedLevels = omp_get_max_active_levels(); //Saved OpenMP setting
+  omp_set_max_active_levels(2);
+  //Set up the walkers
+  vector<MCWalker> walkers(NWalk); //Independent Markov chains
+  for (int w=0;w<NWalk;w++)
+  {
+    walkers[w].setup(QMMMData,QMMMOpts,w+1);
+    call.str("");
+    call << "WalkerStruct_" << w << ".xyz";
+    if ((!walkers[w].readRestart(call.str())) && (w > 0))
+    {
+      //Start the extra walkers from different structures
+      walkers[w].randomStart();
+    }
+  }
+  #pragma omp parallel for schedule(dynamic) num_threads(walkThreads)
+  for (int w=0;w<NWalk;w++)
+  {
+    omp_set_num_threads(beadThreads);
+    walkers[w].initEnergy();
+  }
+  //Find the number of characters to print for the step counter
+  int simCharLen;
+  simCharLen = QMMMOpts.NEq+QMMMOpts.NSteps;
+  simCharLen = LICHEMCount(simCharLen);
+  //Run equilibration
+  cout << "Monte Carlo equilibration with " << NWalk << " walkers:" << '\n';
+  cout.flush();
+  int Nct = 0; //Steps completed by all walkers
+  while (Nct < QMMMOpts.NEq)
+  {
+    //Move the walkers concurrently until the next step size check
+    int Nsync = min(QMMMOpts.NEq,((Nct/acc_Check)+1)*acc_Check);
+    #pragma omp parallel for schedule(dynamic) num_threads(walkThreads)
+    for (int w=0;w<NWalk;w++)
+    {
+      omp_set_num_threads(beadThreads);
+      for (int k=Nct;k<Nsync;k++)
+      {
+        walkers[w].move(0);
+      }
+    }
+    Nct = Nsync;
+    if ((Nct%acc_Check) == 0)
+    {
+      //Print statistics and adjust the step sizes
+      cout << " | Step: " << setw(simCharLen) << Nct;
+      cout << " | Accept ratios:";
+      for (int w=0;w<NWalk;w++)
+      {
+        double accRatio = walkers[w].Nacc/(walkers[w].Nrej+walkers[w].Nacc);
+        cout << " " << LICHEMFormFloat(accRatio,4);
+        walkers[w].adaptStep();
+      }
+      cout << '\n';
+      cout.flush();
+    }
+  }
+  cout << " Equilibration complete." << '\n';
+  //Run production
+  for (int w=0;w<NWalk;w++)
+  {
+    walkers[w].resetStats();
+  }
+  cout << '\n';
+  cout << "Monte Carlo production with " << NWalk << " walkers:" << '\n';
+  cout.flush();
+  Nct = 0;
+  while (Nct < QMMMOpts.NSteps)
+  {
+    //Move the walkers concurrently until the next print
+    int Nsync = ((Nct/QMMMOpts.NPrint)+1)*QMMMOpts.NPrint;
+    Nsync = min(QMMMOpts.NSteps,Nsync);
+    #pragma omp parallel for schedule(dynamic) num_threads(walkThreads)
+    for (int w=0;w<NWalk;w++)
+    {
+      omp_set_num_threads(beadThreads);
+      for (int k=Nct;k<Nsync;k++)
+      {
+        walkers[w].move(1);
+      }
+    }
+    Nct = Nsync;
+    if ((Nct%QMMMOpts.NPrint) == 0)
+    {
+      //Print trajectory and restart files
+      double Et = 0; //Average instantaneous energy of the walkers
+      for (int w=0;w<NWalk;w++)
+      {
+        call.str("");
+        call << "WalkerStruct_" << w << ".xyz";
+        walkers[w].writeRestart(call.str());
+        Et += walkers[w].lastE;
+      }
+      Et /= NWalk;
+      Print_traj(walkers[0].QMMMData,traj,QMMMOpts);
+      cout << " | Step: " << setw(simCharLen) << Nct;
+      cout << " | Energy: " << LICHEMFormFloat(Et,12);
+      cout << " eV" << '\n';
+      cout.flush();
+    }
+  }
+  //Save the final structures
+  for (int w=0;w<NWalk;w++)
+  {
+    call.str("");
+    call << "WalkerStruct_" << w << ".xyz";
+    walkers[w].writeRestart(call.str());
+  }
+  //Pool the statistics
+  double avgE = 0; //Average of the walker energies
+  double avgVar = 0; //Average of the walker variances
+  double Nacc = 0; //Accepted moves
+  double Nrej = 0; //Rejected moves
+  for (int w=0;w<NWalk;w++)
+  {
+    avgE += walkers[w].avgE();
+    avgVar += walkers[w].varE();
+    Nacc += walkers[w].Nacc;
+    Nrej += walkers[w].Nrej;
+  }
+  avgE /= NWalk;
+  avgVar /= NWalk;
+  double stdErr = 0; //Standard error from the spread of the walkers
+  for (int w=0;w<NWalk;w++)
+  {
+    stdErr += (walkers[w].avgE()-avgE)*(walkers[w].avgE()-avgE);
+  }
+  stdErr /= NWalk*(NWalk-1);
+  stdErr = sqrt(stdErr);
+  //Print statistics
+  cout << '\n';
+  if (QMMMOpts.NBeads > 1)
+  {
+    cout << "PI";
+  }
+  cout << "MC statistics:" << '\n';
+  for (int w=0;w<NWalk;w++)
+  {
+    cout << " | Walker " << w << " average energy: ";
+    cout << LICHEMFormFloat(walkers[w].avgE(),12) << " eV";
+    cout << '\n';
+    PIPrintMoves(walkers[w].QMMMOpts,1);
+  }
+  cout << " | Average energy: ";
+  cout << LICHEMFormFloat(avgE,16);
+  cout << " +/- " << LICHEMFormFloat(stdErr,8);
+  cout << " eV | Variance: ";
+  cout << LICHEMFormFloat(avgVar,12);
+  cout << " eV\u00B2";
+  cout << '\n';
+  cout << " | Acceptance ratio: ";
+  cout << LICHEMFormFloat((Nacc/(Nrej+Nacc)),6);
+  cout << '\n';
+  cout << '\n';
+  cout.flush();
+  //Clean up the wrapper files and return the first walker
+  for (int w=0;w<NWalk;w++)
+  {
+    walkers[w].clearSlots();
+  }
+  omp_set_max_active_levels(savedLevels);
+  QMMMData = walkers[0].QMMMData;
+  return;
+};
+
 //End file group
 ///@}
 
@@ -16,6 +16,13 @@
  Henkelman et al., J. Chem. Phys., 113, 22, 9901, (2000)
  Henkelman et al., J. Chem. Phys., 113, 22, 9978, (2000)
 
+ Reference for Gaussian process accelerated NEB:
+ Koistinen et al., J. Chem. Phys., 147, 15, 152720, (2017)
+
+ References for the dimer method:
+ Henkelman and Jonsson, J. Chem. Phys., 111, 15, 7010, (1999)
+ Kastner and Sherwood, J. Chem. Phys., 128, 1, 014106, (2008)
+
  References for global DFP:
  Press et al., Numerical Recipes 3nd Edition, (2007)
  Sheppard et al., J. Chem. Phys., 128, 13, 134106, (2008)
@@ -337,35 +344,19 @@ bool PathConverged(vector<QMMMAtom>& QMMMData, vector<QMMMAtom>& oldQMMMData,
     //Calculate reaction coordinate
     VectorXd reactCoord(QMMMOpts.NBeads); //Reaction coordinate
     reactCoord.setZero();
+    //Align neighboring replicas
+    vector<VectorXd> pathDistNext; //Displacements to p+1
+    vector<VectorXd> pathDistPrev; //Displacements to p-1
+    KabschPathDisplacement(QMMMData,QMMMOpts,pathDistNext,pathDistPrev);
     for (int p=0;p<(QMMMOpts.NBeads-1);p++)
     {
-      MatrixXd geom1((Nqm+Npseudo),3); //Current replica
-      MatrixXd geom2((Nqm+Npseudo),3); //Next replica
       VectorXd disp; //Store the displacement
-      //Save geometries
-      int ct = 0; //Reset counter for the number of atoms
-      for (int i=0;i<Natoms;i++)
-      {
-        //Only include QM and PB regions
-        if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
-        {
-          //Save current replica
-          geom1(ct,0) = QMMMData[i].P[p].x;
-          geom1(ct,1) = QMMMData[i].P[p].y;
-          geom1(ct,2) = QMMMData[i].P[p].z;
-          //Save replica p+1
-          geom2(ct,0) = QMMMData[i].P[p+1].x;
-          geom2(ct,1) = QMMMData[i].P[p+1].y;
-          geom2(ct,2) = QMMMData[i].P[p+1].z;
-          ct += 1;
-        }
-      }
       //Calculate displacement
-      disp = KabschDisplacement(geom1,geom2,(Nqm+Npseudo));
+      disp = pathDistNext[p];
       if (NEBSim)
       {
         //Remove inactive atoms
-        ct = 0; //Reset counter for the number of atoms
+        int ct = 0; //Counter for the number of atoms
         for (int i=0;i<Natoms;i++)
         {
           //Only include QM and PB regions
@@ -476,10 +467,36 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
   VectorXd gForces(matrixSize); //Global forces
   VectorXd rForces(Ndof); //Reactant forces
   VectorXd pForces(Ndof); //Product forces
-  MatrixXd iHessG(matrixSize,matrixSize); //Path inverse Hessian
-  MatrixXd iHessR(Ndof,Ndof); //Reactant inverse Hessian
-  MatrixXd iHessP(Ndof,Ndof); //Product inverse Hessian
+  MatrixXd iHessG; //Path inverse Hessian
+  MatrixXd iHessR; //Reactant inverse Hessian
+  MatrixXd iHessP; //Product inverse Hessian
+  vector<VectorXd> stepHistG; //L-BFGS steps (path)
+  vector<VectorXd> stepHistR; //L-BFGS steps (reactant)
+  vector<VectorXd> stepHistP; //L-BFGS steps (product)
+  vector<VectorXd> gradHistG; //L-BFGS gradient changes (path)
+  vector<VectorXd> gradHistR; //L-BFGS gradient changes (reactant)
+  vector<VectorXd> gradHistP; //L-BFGS gradient changes (product)
+  VectorXd velG(matrixSize); //FIRE velocities (path)
+  VectorXd velR(Ndof); //FIRE velocities (reactant)
+  VectorXd velP(Ndof); //FIRE velocities (product)
+  VectorXd fireDt(QMMMOpts.NBeads); //FIRE time step for each bead
+  VectorXd fireAlpha(QMMMOpts.NBeads); //FIRE mixing for each bead
+  VectorXi firePos(QMMMOpts.NBeads); //Number of downhill FIRE steps
+  vector<bool> beadFrozen; //Flags for converged beads which do not move
+  VectorXd beadShift(QMMMOpts.NBeads); //Displacement in the last step
+  VectorXd frznShift(QMMMOpts.NBeads); //Neighbor motion since freezing
+  vector<VectorXd> cacheForces; //Wrapper forces of the frozen beads
+  VectorXd cacheEqm(QMMMOpts.NBeads); //QM energies of the frozen beads
+  VectorXd cacheEmm(QMMMOpts.NBeads); //MM energies of the frozen beads
+  VectorXd cacheE(QMMMOpts.NBeads); //Force energies of the frozen beads
   VectorXd forces(Ndof); //Local forces
+  if (QMMMOpts.NEBOpt == "dfp")
+  {
+    //Dense inverse Hessians are only needed for DFP
+    iHessG.resize(matrixSize,matrixSize);
+    iHessR.resize(Ndof,Ndof);
+    iHessP.resize(Ndof,Ndof);
+  }
   //Initialize arrays
   optVecG.setZero();
   optVecR.setZero();
@@ -491,6 +508,19 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
   rForces.setZero();
   pForces.setZero();
   forces.setZero();
+  velG.setZero();
+  velR.setZero();
+  velP.setZero();
+  fireDt.fill(0.1*QMMMOpts.stepScale);
+  fireAlpha.fill(0.1);
+  firePos.setZero();
+  beadFrozen.resize(QMMMOpts.NBeads,0);
+  beadShift.setZero();
+  frznShift.setZero();
+  cacheForces.resize(QMMMOpts.NBeads);
+  cacheEqm.setZero();
+  cacheEmm.setZero();
+  cacheE.setZero();
   //Create an identity matrix as the initial Hessian
   iHessG.setIdentity(); //Already an "inverse" Hessian
   iHessR.setIdentity(); //Already an "inverse" Hessian
@@ -501,6 +531,10 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
   //Run optimization
   newTS = 0; //Reactant
   newTSEnergy = -hugeNum; //All energies will be higher
+  //Align neighboring replicas
+  vector<VectorXd> pathDistNext; //Displacements to p+1
+  vector<VectorXd> pathDistPrev; //Displacements to p-1
+  KabschPathDisplacement(QMMMData,QMMMOpts,pathDistNext,pathDistPrev);
   for (int p=pathStart;p<pathEnd;p++)
   {
     double E = 0;
@@ -580,38 +614,11 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
     if ((p != 0) && (p != (QMMMOpts.NBeads-1)))
     {
       //Calculate tangents for middle replicas
-      MatrixXd geom1((Nqm+Npseudo),3); //Current replica
-      MatrixXd geom2((Nqm+Npseudo),3); //Second replica
-      MatrixXd geom3((Nqm+Npseudo),3); //Third replica
-      //Save geometries
-      int ct = 0; //Reset counter for the number of atoms
-      for (int i=0;i<Natoms;i++)
-      {
-        //Only include QM and PB regions
-        if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
-        {
-          //Save current replica
-          geom1(ct,0) = QMMMData[i].P[p].x;
-          geom1(ct,1) = QMMMData[i].P[p].y;
-          geom1(ct,2) = QMMMData[i].P[p].z;
-          //Save replica p+1
-          geom2(ct,0) = QMMMData[i].P[p+1].x;
-          geom2(ct,1) = QMMMData[i].P[p+1].y;
-          geom2(ct,2) = QMMMData[i].P[p+1].z;
-          //Save replica p-1
-          geom3(ct,0) = QMMMData[i].P[p-1].x;
-          geom3(ct,1) = QMMMData[i].P[p-1].y;
-          geom3(ct,2) = QMMMData[i].P[p-1].z;
-          //Advance counter
-          ct += 1;
-        }
-      }
-      //Calculate displacements
-      distp1 = KabschDisplacement(geom1,geom2,(Nqm+Npseudo));
+      distp1 = pathDistNext[p];
       distp1 *= -1; //Change direction
-      distm1 = KabschDisplacement(geom1,geom3,(Nqm+Npseudo));
+      distm1 = pathDistPrev[p];
       //Remove inactive atoms
-      ct = 0; //Reset counter for the number of atoms
+      int ct = 0; //Counter for the number of atoms
       for (int i=0;i<Natoms;i++)
       {
         //Only include QM and PB regions
@@ -758,30 +765,141 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
       gradDiffG(i) = gForces(i); //Path
     }
     //Determine new structure
-    optVecG = iHessG*gForces;
-    optVecG *= stepScale;
-    optVecR = iHessR*rForces;
-    optVecR *= stepScale;
-    optVecP = iHessP*pForces;
-    optVecP *= stepScale;
-    //Check average step size
-    vecMax = optVecG.norm()/QMMMOpts.NBeads;
-    if (vecMax > QMMMOpts.maxStep)
+    if (QMMMOpts.NEBOpt == "fire")
     {
-      //Scale step size
-      optVecG *= (QMMMOpts.maxStep/vecMax);
+      //Move each bead with its own FIRE velocities and time step
+      for (int p=pathStart;p<pathEnd;p++)
+      {
+        VectorXd beadForces(Ndof); //Forces on the bead
+        VectorXd beadVel(Ndof); //Velocities of the bead
+        VectorXd beadStep(Ndof); //Displacement of the bead
+        int gfID = Ndof*(p-1); //Location of the bead in the global arrays
+        if (p == 0)
+        {
+          //Reactant
+          beadForces = rForces;
+          beadVel = velR;
+        }
+        else if (p == (QMMMOpts.NBeads-1))
+        {
+          //Product
+          beadForces = pForces;
+          beadVel = velP;
+        }
+        else
+        {
+          //Path
+          beadForces = gForces.segment(gfID,Ndof);
+          beadVel = velG.segment(gfID,Ndof);
+        }
+        FIREStep(beadForces,beadVel,beadStep,fireDt(p),fireAlpha(p),
+                 firePos(p),QMMMOpts);
+        //Save velocities and displacements
+        if (p == 0)
+        {
+          velR = beadVel;
+          optVecR = beadStep;
+        }
+        else if (p == (QMMMOpts.NBeads-1))
+        {
+          velP = beadVel;
+          optVecP = beadStep;
+        }
+        else
+        {
+          velG.segment(gfID,Ndof) = beadVel;
+          optVecG.segment(gfID,Ndof) = beadStep;
+        }
+      }
     }
-    vecMax = optVecR.norm()/QMMMOpts.NBeads;
-    if (vecMax > QMMMOpts.maxStep)
+    else
     {
-      //Scale step size
-      optVecR *= (QMMMOpts.maxStep/vecMax);
+      if (QMMMOpts.NEBOpt == "lbfgs")
+      {
+        //Two-loop recursion
+        optVecG = LBFGSDirection(gForces,stepHistG,gradHistG);
+        optVecR = LBFGSDirection(rForces,stepHistR,gradHistR);
+        optVecP = LBFGSDirection(pForces,stepHistP,gradHistP);
+      }
+      else
+      {
+        //Dense inverse Hessians
+        optVecG = iHessG*gForces;
+        optVecR = iHessR*rForces;
+        optVecP = iHessP*pForces;
+      }
+      optVecG *= stepScale;
+      optVecR *= stepScale;
+      optVecP *= stepScale;
+      //Check average step size
+      vecMax = optVecG.norm()/QMMMOpts.NBeads;
+      if (vecMax > QMMMOpts.maxStep)
+      {
+        //Scale step size
+        optVecG *= (QMMMOpts.maxStep/vecMax);
+      }
+      vecMax = optVecR.norm()/QMMMOpts.NBeads;
+      if (vecMax > QMMMOpts.maxStep)
+      {
+        //Scale step size
+        optVecR *= (QMMMOpts.maxStep/vecMax);
+      }
+      vecMax = optVecP.norm()/QMMMOpts.NBeads;
+      if (vecMax > QMMMOpts.maxStep)
+      {
+        //Scale step size
+        optVecP *= (QMMMOpts.maxStep/vecMax);
+      }
     }
-    vecMax = optVecP.norm()/QMMMOpts.NBeads;
-    if (vecMax > QMMMOpts.maxStep)
+    //Keep frozen beads in place and track the motion of their neighbors
+    for (int p=pathStart;p<pathEnd;p++)
     {
-      //Scale step size
-      optVecP *= (QMMMOpts.maxStep/vecMax);
+      if (p == 0)
+      {
+        //Reactant
+        if (beadFrozen[p])
+        {
+          optVecR.setZero();
+          velR.setZero();
+        }
+        beadShift(p) = optVecR.norm();
+      }
+      else if (p == (QMMMOpts.NBeads-1))
+      {
+        //Product
+        if (beadFrozen[p])
+        {
+          optVecP.setZero();
+          velP.setZero();
+        }
+        beadShift(p) = optVecP.norm();
+      }
+      else
+      {
+        //Path
+        int gfID = Ndof*(p-1); //Location of the bead in the global arrays
+        if (beadFrozen[p])
+        {
+          optVecG.segment(gfID,Ndof).setZero();
+          velG.segment(gfID,Ndof).setZero();
+        }
+        beadShift(p) = optVecG.segment(gfID,Ndof).norm();
+      }
+    }
+    for (int p=pathStart;p<pathEnd;p++)
+    {
+      if (beadFrozen[p])
+      {
+        //Update the motion of the neighbors
+        if (p > 0)
+        {
+          frznShift(p) += beadShift(p-1);
+        }
+        if (p < (QMMMOpts.NBeads-1))
+        {
+          frznShift(p) += beadShift(p+1);
+        }
+      }
     }
     //Update positions
     #pragma omp parallel for schedule(dynamic)
@@ -848,6 +966,10 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
     pForces.setZero(); //Remove old forces (product)
     newTS = 0; //Storage for new TS ID
     newTSEnergy = -hugeNum;
+    //Align neighboring replicas
+    vector<VectorXd> pathDistNext; //Displacements to p+1
+    vector<VectorXd> pathDistPrev; //Displacements to p-1
+    KabschPathDisplacement(oldQMMMData,QMMMOpts,pathDistNext,pathDistPrev);
     for (int p=pathStart;p<pathEnd;p++)
     {
       double E = 0;
@@ -855,47 +977,63 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
       double Emm = 0;
       //Erase old forces
       forces.setZero();
-      //Calculate forces (QM part)
-      if (Gaussian)
-      {
-        int tStart = (unsigned)time(0);
-        Eqm += GaussianForces(QMMMData,forces,QMMMOpts,p);
-        QMTime += (unsigned)time(0)-tStart;
-      }
-      if (PSI4)
-      {
-        int tStart = (unsigned)time(0);
-        Eqm += PSI4Forces(QMMMData,forces,QMMMOpts,p);
-        QMTime += (unsigned)time(0)-tStart;
-        //Delete annoying useless files
-        globalSys = system("rm -f psi.* timer.*");
-      }
-      if (NWChem)
+      if (beadFrozen[p])
       {
-        int tStart = (unsigned)time(0);
-        Eqm += NWChemForces(QMMMData,forces,QMMMOpts,p);
-        QMTime += (unsigned)time(0)-tStart;
+        //The bead has not moved, reuse the wrapper forces and energies
+        forces = cacheForces[p];
+        Eqm = cacheEqm(p);
+        Emm = cacheEmm(p);
+        E = cacheE(p);
       }
-      E += Eqm; //Save the partial energy
-      //Calculate forces (MM part)
-      if (TINKER)
+      else
       {
-        int tStart = (unsigned)time(0);
-        E += TINKERForces(QMMMData,forces,QMMMOpts,p);
-        if (AMOEBA || QMMMOpts.useImpSolv)
+        //Calculate forces (QM part)
+        if (Gaussian)
         {
-          //Forces from MM polarization
-          E += TINKERPolForces(QMMMData,forces,QMMMOpts,p);
+          int tStart = (unsigned)time(0);
+          Eqm += GaussianForces(QMMMData,forces,QMMMOpts,p);
+          QMTime += (unsigned)time(0)-tStart;
         }
-        Emm += TINKEREnergy(QMMMData,QMMMOpts,p);
-        MMTime += (unsigned)time(0)-tStart;
-      }
-      if (LAMMPS)
-      {
-        int tStart = (unsigned)time(0);
-        E += LAMMPSForces(QMMMData,forces,QMMMOpts,p);
-        Emm += LAMMPSEnergy(QMMMData,QMMMOpts,p);
-        MMTime += (unsigned)time(0)-tStart;
+        if (PSI4)
+        {
+          int tStart = (unsigned)time(0);
+          Eqm += PSI4Forces(QMMMData,forces,QMMMOpts,p);
+          QMTime += (unsigned)time(0)-tStart;
+          //Delete annoying useless files
+          globalSys = system("rm -f psi.* timer.*");
+        }
+        if (NWChem)
+        {
+          int tStart = (unsigned)time(0);
+          Eqm += NWChemForces(QMMMData,forces,QMMMOpts,p);
+          QMTime += (unsigned)time(0)-tStart;
+        }
+        E += Eqm; //Save the partial energy
+        //Calculate forces (MM part)
+        if (TINKER)
+        {
+          int tStart = (unsigned)time(0);
+          E += TINKERForces(QMMMData,forces,QMMMOpts,p);
+          if (AMOEBA || QMMMOpts.useImpSolv)
+          {
+            //Forces from MM polarization
+            E += TINKERPolForces(QMMMData,forces,QMMMOpts,p);
+          }
+          Emm += TINKEREnergy(QMMMData,QMMMOpts,p);
+          MMTime += (unsigned)time(0)-tStart;
+        }
+        if (LAMMPS)
+        {
+          int tStart = (unsigned)time(0);
+          E += LAMMPSForces(QMMMData,forces,QMMMOpts,p);
+          Emm += LAMMPSEnergy(QMMMData,QMMMOpts,p);
+          MMTime += (unsigned)time(0)-tStart;
+        }
+        //Save the wrapper forces in case the bead is frozen
+        cacheForces[p] = forces;
+        cacheEqm(p) = Eqm;
+        cacheEmm(p) = Emm;
+        cacheE(p) = E;
       }
       //Save total energy
       sumE += E;
@@ -927,38 +1065,11 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
       if ((p != 0) && (p != (QMMMOpts.NBeads-1)))
       {
         //Calculate tangents for middle replicas
-        MatrixXd geom1((Nqm+Npseudo),3); //Current replica
-        MatrixXd geom2((Nqm+Npseudo),3); //Second replica
-        MatrixXd geom3((Nqm+Npseudo),3); //Third replica
-        //Save geometries
-        int ct = 0; //Reset counter for the number of atoms
-        for (int i=0;i<Natoms;i++)
-        {
-          //Only include QM and PB regions
-          if (oldQMMMData[i].QMRegion || oldQMMMData[i].PBRegion)
-          {
-            //Save current replica
-            geom1(ct,0) = oldQMMMData[i].P[p].x;
-            geom1(ct,1) = oldQMMMData[i].P[p].y;
-            geom1(ct,2) = oldQMMMData[i].P[p].z;
-            //Save replica p+1
-            geom2(ct,0) = oldQMMMData[i].P[p+1].x;
-            geom2(ct,1) = oldQMMMData[i].P[p+1].y;
-            geom2(ct,2) = oldQMMMData[i].P[p+1].z;
-            //Save replica p-1
-            geom3(ct,0) = oldQMMMData[i].P[p-1].x;
-            geom3(ct,1) = oldQMMMData[i].P[p-1].y;
-            geom3(ct,2) = oldQMMMData[i].P[p-1].z;
-            //Advance counter
-            ct += 1;
-          }
-        }
-        //Calculate displacements
-        distp1 = KabschDisplacement(geom1,geom2,(Nqm+Npseudo));
+        distp1 = pathDistNext[p];
         distp1 *= -1; //Change direction
-        distm1 = KabschDisplacement(geom1,geom3,(Nqm+Npseudo));
+        distm1 = pathDistPrev[p];
         //Remove inactive atoms
-        ct = 0; //Reset counter for the number of atoms
+        int ct = 0; //Counter for the number of atoms
         for (int i=0;i<Natoms;i++)
         {
           //Only include QM and PB regions
@@ -1069,6 +1180,56 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
       forceStats(p,0) = maxForce;
       forceStats(p,1) = forces.squaredNorm(); //RMS force
     }
+    //Freeze converged beads and reactivate beads with moving neighbors
+    if (QMMMOpts.NEBFreeze)
+    {
+      int Nfrozen = 0; //Number of frozen beads
+      for (int p=pathStart;p<pathEnd;p++)
+      {
+        bool beadConv = 0; //Flag for converged projected forces
+        double beadRMS = sqrt(forceStats(p,1)/Ndof); //RMS force
+        if ((forceStats(p,0) <= maxFTol) && (beadRMS <= RMSFTol))
+        {
+          beadConv = 1;
+        }
+        if ((p == newTS) && QMMMOpts.climb)
+        {
+          //The climbing image is never frozen
+          beadConv = 0;
+        }
+        if (beadFrozen[p])
+        {
+          //Check if the bead needs to move again
+          if ((!beadConv) || (frznShift(p) > QMMMOpts.NEBFreezeTol))
+          {
+            beadFrozen[p] = 0;
+          }
+        }
+        else if (beadConv)
+        {
+          //Only freeze beads with nearly stationary neighbors
+          double nearShift = 0; //Motion of the neighbors in the last step
+          if (p > 0)
+          {
+            nearShift += beadShift(p-1);
+          }
+          if (p < (QMMMOpts.NBeads-1))
+          {
+            nearShift += beadShift(p+1);
+          }
+          if (nearShift <= QMMMOpts.NEBFreezeTol)
+          {
+            beadFrozen[p] = 1;
+            frznShift(p) = 0;
+          }
+        }
+        if (beadFrozen[p])
+        {
+          Nfrozen += 1;
+        }
+      }
+      cout << "    Frozen beads: " << Nfrozen << '\n';
+    }
     //Check for unstable optimization vectors
     int ct = 0; //Use a counter as a safe way to check all replicas
     #pragma omp parallel for schedule(dynamic) reduction(+:ct)
@@ -1152,7 +1313,13 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
     gradDiffG -= gForces; //Path
     gradDiffR -= rForces; //Reactant
     gradDiffP -= pForces; //Product
-    if (((stepCt%25) == 0) || (stepCt < 15))
+    if (QMMMOpts.NEBOpt == "fire")
+    {
+      //FIRE adjusts the time steps during the next move
+      cout << "    Updating FIRE velocities...";
+      cout << '\n';
+    }
+    else if (((stepCt%25) == 0) || (stepCt < 15))
     {
       //Build a new Hessian after 30 steps
       cout << "    Performing a steepest descent step...";
@@ -1172,6 +1339,13 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
       iHessG.setIdentity(); //Already an "inverse" Hessian
       iHessR.setIdentity(); //Already an "inverse" Hessian (reactant)
       iHessP.setIdentity(); //Already an "inverse" Hessian (product)
+      //Clear the L-BFGS history
+      stepHistG.clear();
+      stepHistR.clear();
+      stepHistP.clear();
+      gradHistG.clear();
+      gradHistR.clear();
+      gradHistP.clear();
     }
     else if (((stepCt+1)%25) == 0)
     {
@@ -1198,27 +1372,45 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
       iHessG.setIdentity(); //Already an "inverse" Hessian
       iHessR.setIdentity(); //Already an "inverse" Hessian (reactant)
       iHessP.setIdentity(); //Already an "inverse" Hessian (product)
+      //Clear the L-BFGS history
+      stepHistG.clear();
+      stepHistR.clear();
+      stepHistP.clear();
+      gradHistG.clear();
+      gradHistR.clear();
+      gradHistP.clear();
     }
     else if (EOld != (-hugeNum))
     {
       //Update Hessian
       cout << "    Updating inverse Hessian...";
       cout << '\n';
-      //Start really long "line" (path)
-      iHessG = iHessG+((optVecG*optVecG.transpose())/(optVecG.transpose()
-      *gradDiffG))-((iHessG*gradDiffG*gradDiffG.transpose()*iHessG)
-      /(gradDiffG.transpose()*iHessG*gradDiffG));
-      //End really long "line" (path)
-      //Start really long "line" (reactant)
-      iHessR = iHessR+((optVecR*optVecR.transpose())/(optVecR.transpose()
-      *gradDiffR))-((iHessR*gradDiffR*gradDiffR.transpose()*iHessR)
-      /(gradDiffR.transpose()*iHessR*gradDiffR));
-      //End really long "line" (reactant)
-      //Start really long "line" (product)
-      iHessP = iHessP+((optVecP*optVecP.transpose())/(optVecP.transpose()
-      *gradDiffP))-((iHessP*gradDiffP*gradDiffP.transpose()*iHessP)
-      /(gradDiffP.transpose()*iHessP*gradDiffP));
-      //End really long "line" (product)
+      if (QMMMOpts.NEBOpt == "lbfgs")
+      {
+        //Save the new correction pairs
+        int maxHist = QMMMOpts.LBFGSMem; //Local copy
+        LBFGSUpdate(optVecG,gradDiffG,stepHistG,gradHistG,maxHist);
+        LBFGSUpdate(optVecR,gradDiffR,stepHistR,gradHistR,maxHist);
+        LBFGSUpdate(optVecP,gradDiffP,stepHistP,gradHistP,maxHist);
+      }
+      else
+      {
+        //Start really long "line" (path)
+        iHessG = iHessG+((optVecG*optVecG.transpose())/(optVecG.transpose()
+        *gradDiffG))-((iHessG*gradDiffG*gradDiffG.transpose()*iHessG)
+        /(gradDiffG.transpose()*iHessG*gradDiffG));
+        //End really long "line" (path)
+        //Start really long "line" (reactant)
+        iHessR = iHessR+((optVecR*optVecR.transpose())/(optVecR.transpose()
+        *gradDiffR))-((iHessR*gradDiffR*gradDiffR.transpose()*iHessR)
+        /(gradDiffR.transpose()*iHessR*gradDiffR));
+        //End really long "line" (reactant)
+        //Start really long "line" (product)
+        iHessP = iHessP+((optVecP*optVecP.transpose())/(optVecP.transpose()
+        *gradDiffP))-((iHessP*gradDiffP*gradDiffP.transpose()*iHessP)
+        /(gradDiffP.transpose()*iHessP*gradDiffP));
+        //End really long "line" (product)
+      }
       //Increase stepsize for the next iteration
       stepScale *= 1.20; //Does not reach the full StepScale by 25 steps
       if (stepScale > QMMMOpts.stepScale)
@@ -1251,6 +1443,13 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
       iHessG.setIdentity(); //Already an "inverse" Hessian (path)
       iHessR.setIdentity(); //Already an "inverse" Hessian (reactant)
       iHessP.setIdentity(); //Already an "inverse" Hessian (product)
+      //Clear the L-BFGS history
+      stepHistG.clear();
+      stepHistR.clear();
+      stepHistP.clear();
+      gradHistG.clear();
+      gradHistR.clear();
+      gradHistP.clear();
     }
     //Update old energy
     EOld = sumE;
@@ -1266,93 +1465,877 @@ void LICHEMNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts, int optCt)
   return;
 };
 
-//Path ensemble samping routines
-int FBNEBMCMove(vector<QMMMAtom>& QMMMData, vector<VectorXd>& allForces,
-                QMMMSettings& QMMMOpts, VectorXd& Emc)
+//Surrogate model path optimization routines
+void NEBProjectForces(VectorXd& forces, vector<VectorXd>& pathPos,
+                      VectorXd& nebMask, QMMMSettings& QMMMOpts, int bead)
 {
-  //Function to try a force-bias Monte Carlo move
-  int acc = 0; //Accept or reject
-  double randNum; //Random number
-  int Ndof = 3*(Nqm+Npseudo); //Number of QM degrees of freedom
-  VectorXd allEnergies(QMMMOpts.NBeads); //Energies of individual beads
-  VectorXd randNums(QMMMOpts.NBeads); //Array to store random numbers
-  //Save structure and forces for rejected moves
-  VectorXd oldEnergies = Emc;
-  vector<QMMMAtom> oldQMMMData = QMMMData;
-  vector<VectorXd> oldForces = allForces;
-  vector<VectorXd> tempForces = allForces; //Includes tangents
-  //Add tangent forces
-  if (QMMMOpts.NBeads > 1)
+  //Adds the NEB tangent projection and spring forces for one bead
+  if ((bead == 0) || (bead == (QMMMOpts.NBeads-1)))
   {
-    //Only calculate tangent forces for multireplica simulations
-    for (int p=0;p<QMMMOpts.NBeads;p++)
+    //No tangent for the reactant and product
+    return;
+  }
+  //Calculate tangent from the active atoms
+  VectorXd distp1 = pathPos[bead+1]-pathPos[bead]; //Displacement for p+1
+  VectorXd distm1 = pathPos[bead]-pathPos[bead-1]; //Displacement for p-1
+  distp1 = distp1.cwiseProduct(nebMask);
+  distm1 = distm1.cwiseProduct(nebMask);
+  VectorXd QMTangent = CINEBTangent(distp1,distm1,QMMMOpts,bead);
+  //Remove forces along the tangent
+  double forcesDotTan = forces.dot(QMTangent); //Overlap of vectors
+  forces -= forcesDotTan*QMTangent;
+  if ((bead == QMMMOpts.TSBead) && QMMMOpts.climb)
+  {
+    //Climbing image for TS
+    forces -= forcesDotTan*QMTangent;
+  }
+  else
+  {
+    //Add spring forces
+    double springDist = distp1.norm()-distm1.norm(); //Uneven spacing
+    forces += (QMMMOpts.kSpring*springDist*QMTangent);
+  }
+  return;
+};
+
+void GPNEBForces(vector<VectorXd>& pathPos, GPModel& surrogate,
+                 VectorXd& nebMask, vector<VectorXd>& nebForces,
+                 VectorXd& Es, QMMMSettings& QMMMOpts)
+{
+  //Calculates the NEB forces for the whole path on the surrogate model
+  nebForces.resize(QMMMOpts.NBeads);
+  Es.resize(QMMMOpts.NBeads);
+  #pragma omp parallel for schedule(dynamic)
+  for (int p=0;p<QMMMOpts.NBeads;p++)
+  {
+    Es(p) = surrogate.predict(pathPos[p],nebForces[p]);
+  }
+  //Update the TS
+  for (int p=1;p<(QMMMOpts.NBeads-1);p++)
+  {
+    if (Es(p) > Es(QMMMOpts.TSBead))
     {
-      //Calculate QM tangent forces
-      int ct; //Generic counter
-      double forcesDotTan; //Overlap of vectors
-      double springDist; //Distance between the neighboring beads
-      //Read old forces in the QM region
-      VectorXd forces(Ndof); //Temporary force array
-      forces.setZero();
-      ct = 0;
-      for (int i=0;i<Natoms;i++)
+      QMMMOpts.TSBead = p;
+    }
+  }
+  //Modify forces along the tangents
+  for (int p=0;p<QMMMOpts.NBeads;p++)
+  {
+    NEBProjectForces(nebForces[p],pathPos,nebMask,QMMMOpts,p);
+  }
+  return;
+};
+
+void GPNEBRelax(vector<VectorXd>& pathPos, GPModel& surrogate,
+                VectorXd& nebMask, vector<bool>& beadFrozen,
+                QMMMSettings& QMMMOpts)
+{
+  //Relaxes the path on the surrogate model with the NEB optimizer
+  int Ndof = (int)pathPos[0].size(); //Degrees of freedom for each bead
+  int matrixSize = Ndof*QMMMOpts.NBeads; //Degrees of freedom for the path
+  int maxRelax = 1000; //Maximum number of steps on the surrogate
+  double forceTol = 10*QMMMOpts.QMOptTol; //Half of the max. force tolerance
+  double maxDisp = 0.5*surrogate.getLength(); //Trust radius for each bead
+  double sdStep = 0.1*QMMMOpts.stepScale; //Steepest descent step size
+  //Set end points for the optimization
+  int pathStart = 0;
+  int pathEnd = QMMMOpts.NBeads;
+  if (QMMMOpts.frznEnds)
+  {
+    //Change the start and end points
+    pathStart = 1;
+    pathEnd = QMMMOpts.NBeads-1;
+  }
+  //Initialize optimizer variables
+  vector<VectorXd> startPos = pathPos; //Path at the start of the relaxation
+  vector<VectorXd> nebForces; //Surrogate NEB forces
+  VectorXd Es; //Surrogate energies
+  VectorXd pathForces(matrixSize); //Forces on the whole path
+  VectorXd oldForces(matrixSize); //Forces before the last step
+  VectorXd optVec(matrixSize); //Step for the whole path
+  VectorXd vel(matrixSize); //FIRE velocities
+  MatrixXd iHess; //DFP inverse Hessian
+  vector<VectorXd> stepHist; //L-BFGS steps
+  vector<VectorXd> gradHist; //L-BFGS gradient changes
+  double fireDt = sdStep; //FIRE time step
+  double fireAlpha = 0.1; //FIRE mixing parameter
+  int firePos = 0; //Number of FIRE steps with positive power
+  vel.setZero();
+  optVec.setZero();
+  oldForces.setZero();
+  if (QMMMOpts.NEBOpt == "dfp")
+  {
+    //Scaled identity as the initial inverse Hessian
+    iHess.setIdentity(matrixSize,matrixSize);
+    iHess *= sdStep;
+  }
+  for (int relaxCt=0;relaxCt<maxRelax;relaxCt++)
+  {
+    //Calculate surrogate forces
+    GPNEBForces(pathPos,surrogate,nebMask,nebForces,Es,QMMMOpts);
+    pathForces.setZero();
+    double maxForce = 0; //Largest force component on the path
+    for (int p=pathStart;p<pathEnd;p++)
+    {
+      if (beadFrozen[p])
       {
-        if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+        //Frozen beads do not move
+        continue;
+      }
+      pathForces.segment(p*Ndof,Ndof) = nebForces[p];
+      if (nebForces[p].cwiseAbs().maxCoeff() > maxForce)
+      {
+        maxForce = nebForces[p].cwiseAbs().maxCoeff();
+      }
+    }
+    if (maxForce <= forceTol)
+    {
+      //The path is converged on the surrogate
+      break;
+    }
+    if (QMMMOpts.NEBOpt == "fire")
+    {
+      FIREStep(pathForces,vel,optVec,fireDt,fireAlpha,firePos,QMMMOpts);
+    }
+    else
+    {
+      if (relaxCt > 0)
+      {
+        //Update the inverse Hessian with the last step
+        VectorXd gradDiff = oldForces-pathForces; //Change in the gradient
+        double curv = optVec.dot(gradDiff); //Curvature along the step
+        if (QMMMOpts.NEBOpt == "lbfgs")
         {
-          //X component
-          forces(ct) = tempForces[p](3*i);
-          ct += 1;
-          //Y component
-          forces(ct) = tempForces[p](3*i+1);
-          ct += 1;
-          //Z component
-          forces(ct) = tempForces[p](3*i+2);
-          ct += 1;
+          int maxHist = QMMMOpts.LBFGSMem; //Local copy
+          LBFGSUpdate(optVec,gradDiff,stepHist,gradHist,maxHist);
+        }
+        else if (curv > (1e-10*optVec.norm()*gradDiff.norm()))
+        {
+          //DFP update
+          VectorXd hessGrad = iHess*gradDiff; //Inverse Hessian times change
+          iHess += (optVec*optVec.transpose())/curv;
+          iHess -= (hessGrad*hessGrad.transpose())/gradDiff.dot(hessGrad);
         }
       }
-      VectorXd QMTangent(Ndof); //Tangent vector
-      VectorXd distp1(Ndof); //Displacement for p+1
-      VectorXd distm1(Ndof); //Displacement for p-1
-      if ((p != 0) && (p != (QMMMOpts.NBeads-1)))
+      //Calculate the quasi-Newton step
+      if (QMMMOpts.NEBOpt == "lbfgs")
       {
-        //Calculate tangents for middle replicas
-        MatrixXd geom1((Nqm+Npseudo),3); //Current replica
-        MatrixXd geom2((Nqm+Npseudo),3); //Second replica
-        MatrixXd geom3((Nqm+Npseudo),3); //Third replica
-        //Save geometries
-        int ct = 0; //Reset counter for the number of atoms
-        for (int i=0;i<Natoms;i++)
+        optVec = LBFGSDirection(pathForces,stepHist,gradHist);
+        if (stepHist.size() == 0)
         {
-          //Only include QM and PB regions
-          if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
-          {
-            //Save current replica
-            geom1(ct,0) = QMMMData[i].P[p].x;
-            geom1(ct,1) = QMMMData[i].P[p].y;
-            geom1(ct,2) = QMMMData[i].P[p].z;
-            //Save replica p+1
-            geom2(ct,0) = QMMMData[i].P[p+1].x;
-            geom2(ct,1) = QMMMData[i].P[p+1].y;
-            geom2(ct,2) = QMMMData[i].P[p+1].z;
-            //Save replica p-1
-            geom3(ct,0) = QMMMData[i].P[p-1].x;
-            geom3(ct,1) = QMMMData[i].P[p-1].y;
-            geom3(ct,2) = QMMMData[i].P[p-1].z;
-            //Advance counter
-            ct += 1;
-          }
+          optVec *= sdStep;
         }
-        //Calculate displacements
-        distp1 = KabschDisplacement(geom1,geom2,(Nqm+Npseudo));
-        distp1 *= -1; //Change direction
-        distm1 = KabschDisplacement(geom1,geom3,(Nqm+Npseudo));
-        //Calculate tangent
-        QMTangent = NEBTangent(distp1,distm1,QMMMOpts,p);
       }
       else
       {
-        //No tangent for the reactant and product
-        QMTangent.setZero();
+        optVec = iHess*pathForces;
+      }
+      if (optVec.dot(pathForces) <= 0)
+      {
+        //Restart with a steepest descent step
+        optVec = sdStep*pathForces;
+        stepHist.clear();
+        gradHist.clear();
+        if (QMMMOpts.NEBOpt == "dfp")
+        {
+          iHess.setIdentity();
+          iHess *= sdStep;
+        }
+      }
+      //Check step size
+      double vecMax = optVec.norm(); //Displacement of the path
+      if (vecMax > QMMMOpts.maxStep)
+      {
+        //Scale step size
+        optVec *= (QMMMOpts.maxStep/vecMax);
+      }
+    }
+    //Stop before a bead moves too far from the data
+    bool inTrust = 1; //Flag to take the step
+    for (int p=pathStart;p<pathEnd;p++)
+    {
+      VectorXd beadDisp = pathPos[p]-startPos[p]; //Total displacement
+      beadDisp += optVec.segment(p*Ndof,Ndof);
+      if (beadDisp.norm() > maxDisp)
+      {
+        inTrust = 0;
+      }
+    }
+    if (!inTrust)
+    {
+      break;
+    }
+    for (int p=pathStart;p<pathEnd;p++)
+    {
+      pathPos[p] += optVec.segment(p*Ndof,Ndof);
+    }
+    oldForces = pathForces;
+  }
+  return;
+};
+
+void GPNEBSetPath(vector<QMMMAtom>& QMMMData, vector<VectorXd>& pathPos,
+                  vector<bool>& beadEval, vector<VectorXd>& oldPos,
+                  QMMMSettings& QMMMOpts)
+{
+  //Copies the path to the atoms and marks the beads which moved
+  for (int p=0;p<QMMMOpts.NBeads;p++)
+  {
+    if ((pathPos[p]-oldPos[p]).squaredNorm() > 0)
+    {
+      //The wrapper forces are out of date
+      beadEval[p] = 0;
+    }
+    int ct = 0; //Counter
+    for (int i=0;i<Natoms;i++)
+    {
+      if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+      {
+        QMMMData[i].P[p].x = pathPos[p](ct);
+        QMMMData[i].P[p].y = pathPos[p](ct+1);
+        QMMMData[i].P[p].z = pathPos[p](ct+2);
+        ct += 3;
+      }
+    }
+  }
+  return;
+};
+
+void LICHEMGPNEB(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts)
+{
+  //NEB path optimization on a Gaussian process surrogate model
+  fstream qmFile; //Generic file stream
+  stringstream call; //Stream for system calls and reading/writing files
+  int stepCt = 0; //Counter for optimization steps
+  int Ndof = 3*(Nqm+Npseudo); //Number of QM and PB degrees of freedom
+  double maxFTol = 20*QMMMOpts.QMOptTol; //Opt. tolerance for max. force
+  double RMSFTol = 10*QMMMOpts.QMOptTol; //Opt. tolerance for RMS force
+  //Initialize charges
+  if (Nmm > 0)
+  {
+    for (int p=0;p<QMMMOpts.NBeads;p++)
+    {
+      //Write charges for bead p
+      WriteChargeFile(QMMMData,QMMMOpts,p);
+    }
+  }
+  //Initialize trajectory file
+  call.str("");
+  call << "LICHMNEBOpt.xyz";
+  qmFile.open(call.str().c_str(),ios_base::out);
+  //Set end points for the optimization
+  int pathStart = 0;
+  int pathEnd = QMMMOpts.NBeads;
+  if (QMMMOpts.frznEnds)
+  {
+    //Change the start and end points
+    pathStart = 1;
+    pathEnd = QMMMOpts.NBeads-1;
+  }
+  //Collect the path and the atoms included in the tangent
+  VectorXd nebMask(Ndof); //Zero for inactive atoms
+  vector<VectorXd> pathPos; //QM and PB coordinates of each bead
+  pathPos.resize(QMMMOpts.NBeads);
+  for (int p=0;p<QMMMOpts.NBeads;p++)
+  {
+    pathPos[p].resize(Ndof);
+    int ct = 0; //Counter
+    for (int i=0;i<Natoms;i++)
+    {
+      if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+      {
+        pathPos[p](ct) = QMMMData[i].P[p].x;
+        pathPos[p](ct+1) = QMMMData[i].P[p].y;
+        pathPos[p](ct+2) = QMMMData[i].P[p].z;
+        nebMask.segment(ct,3).setConstant(1.0);
+        if (!QMMMData[i].NEBActive)
+        {
+          nebMask.segment(ct,3).setZero();
+        }
+        ct += 3;
+      }
+    }
+  }
+  //Train the surrogate on the initial path
+  GPModel surrogate; //Model of the QMMM potential energy surface
+  VectorXd forces(Ndof); //Forces from the wrappers
+  int Ncalls = 0; //Number of wrapper force calculations
+  vector<VectorXd> trueForces; //Wrapper forces of each bead
+  VectorXd trueE(QMMMOpts.NBeads); //Wrapper energies of each bead
+  vector<bool> beadEval; //Flags for beads with current wrapper forces
+  trueForces.resize(QMMMOpts.NBeads);
+  beadEval.resize(QMMMOpts.NBeads,0);
+  for (int p=0;p<QMMMOpts.NBeads;p++)
+  {
+    forces.setZero();
+    double E = LICHEMForces(QMMMData,forces,QMMMOpts,p); //Energy
+    surrogate.addPoint(pathPos[p],E,forces);
+    trueForces[p] = forces;
+    trueE(p) = E;
+    beadEval[p] = 1;
+    Ncalls += 1;
+  }
+  cout << "    Training the surrogate on the initial path..." << '\n';
+  cout << '\n';
+  cout.flush();
+  //Initialize bead freezing
+  vector<bool> beadFrozen; //Flags for converged beads which do not move
+  VectorXd beadShift(QMMMOpts.NBeads); //Displacement in the last step
+  VectorXd frznShift(QMMMOpts.NBeads); //Neighbor motion since freezing
+  beadFrozen.resize(QMMMOpts.NBeads,0);
+  beadShift.setZero();
+  frznShift.setZero();
+  //Optimize path
+  bool savedClimb = QMMMOpts.climb; //Climbing image setting from the input
+  bool pathDone = 0; //Flag to end the optimization
+  double sdStep = 0.1*QMMMOpts.stepScale; //Steepest descent step size
+  vector<VectorXd> nebForces; //Surrogate NEB forces
+  VectorXd Es; //Surrogate energies
+  while ((!pathDone) && (stepCt < QMMMOpts.maxOptSteps))
+  {
+    vector<VectorXd> oldPos = pathPos; //Path before the step
+    bool forcesConv = 0; //Flag for converged forces
+    double maxForce = 0; //Max. wrapper force
+    double RMSForce = 0; //RMS wrapper force
+    if (surrogate.train())
+    {
+      //Relax the path on the surrogate
+      GPNEBRelax(pathPos,surrogate,nebMask,beadFrozen,QMMMOpts);
+      GPNEBForces(pathPos,surrogate,nebMask,nebForces,Es,QMMMOpts);
+      //Find the most uncertain bead and the largest force
+      double maxStdDev = 0; //Largest standard deviation of the energy
+      double surrForce = 0; //Largest surrogate force
+      int stdBead = QMMMOpts.TSBead; //Most uncertain bead
+      int forceBead = QMMMOpts.TSBead; //Bead with the largest force
+      for (int p=pathStart;p<pathEnd;p++)
+      {
+        if (beadFrozen[p])
+        {
+          //Frozen beads keep their wrapper forces
+          continue;
+        }
+        double stdDev = sqrt(surrogate.variance(pathPos[p]));
+        if (stdDev > maxStdDev)
+        {
+          maxStdDev = stdDev;
+          stdBead = p;
+        }
+        if (nebForces[p].cwiseAbs().maxCoeff() > surrForce)
+        {
+          surrForce = nebForces[p].cwiseAbs().maxCoeff();
+          forceBead = p;
+        }
+      }
+      //Choose the bead for the next wrapper calculation
+      int evalBead = QMMMOpts.TSBead; //Bead for the wrappers
+      if (maxStdDev > QMMMOpts.GPUncertTol)
+      {
+        //Improve the surrogate where it is least reliable
+        evalBead = stdBead;
+      }
+      else if (!QMMMOpts.climb)
+      {
+        //Check the bead with the largest force
+        evalBead = forceBead;
+      }
+      //Update positions
+      GPNEBSetPath(QMMMData,pathPos,beadEval,oldPos,QMMMOpts);
+      //Calculate forces for the selected bead
+      forces.setZero();
+      double E = LICHEMForces(QMMMData,forces,QMMMOpts,evalBead); //Energy
+      surrogate.addPoint(pathPos[evalBead],E,forces);
+      trueForces[evalBead] = forces;
+      trueE(evalBead) = E;
+      beadEval[evalBead] = 1;
+      Ncalls += 1;
+      stepCt += 1;
+      //Check the NEB forces from the wrappers
+      NEBProjectForces(forces,pathPos,nebMask,QMMMOpts,evalBead);
+      maxForce = forces.cwiseAbs().maxCoeff();
+      RMSForce = sqrt(forces.squaredNorm()/Ndof);
+      //Print progress
+      Print_traj(QMMMData,qmFile,QMMMOpts);
+      cout << "    QM step: " << stepCt;
+      cout << " | Bead: " << evalBead;
+      cout << " | Force calculations: " << Ncalls << '\n';
+      cout << "    Max. force: ";
+      cout << LICHEMFormFloat(maxForce,12);
+      cout << " eV/\u212B | RMS force: ";
+      cout << LICHEMFormFloat(RMSForce,12);
+      cout << " eV/\u212B" << '\n';
+      cout << "    Surrogate max. force: ";
+      cout << LICHEMFormFloat(surrForce,12);
+      cout << " eV/\u212B | Max. std. dev.: ";
+      cout << LICHEMFormFloat(maxStdDev,12);
+      cout << " eV" << '\n';
+      cout << "    TS bead: " << QMMMOpts.TSBead;
+      cout << " | TS energy: ";
+      cout << LICHEMFormFloat(Es(QMMMOpts.TSBead),14);
+      cout << " eV" << '\n';
+      if ((maxStdDev <= QMMMOpts.GPUncertTol) && (surrForce <= maxFTol) &&
+         (maxForce <= maxFTol) && (RMSForce <= RMSFTol))
+      {
+        //The path is only checked at the TS after climbing starts
+        forcesConv = 1;
+        if (QMMMOpts.climb && (evalBead != QMMMOpts.TSBead))
+        {
+          forcesConv = 0;
+        }
+      }
+    }
+    else
+    {
+      //Take a nudged elastic band step with the wrapper forces
+      cout << "    Surrogate training failed. Using the wrapper forces...";
+      cout << '\n';
+      for (int p=0;p<QMMMOpts.NBeads;p++)
+      {
+        if (!beadEval[p])
+        {
+          forces.setZero();
+          double E = LICHEMForces(QMMMData,forces,QMMMOpts,p); //Energy
+          surrogate.addPoint(pathPos[p],E,forces);
+          trueForces[p] = forces;
+          trueE(p) = E;
+          beadEval[p] = 1;
+          Ncalls += 1;
+        }
+      }
+      stepCt += 1;
+      //Update the TS
+      for (int p=1;p<(QMMMOpts.NBeads-1);p++)
+      {
+        if (trueE(p) > trueE(QMMMOpts.TSBead))
+        {
+          QMMMOpts.TSBead = p;
+        }
+      }
+      //Check the NEB forces and take a steepest descent step
+      vector<VectorXd> stepVecs; //Steps for each bead
+      stepVecs.resize(QMMMOpts.NBeads);
+      double sumSq = 0; //Sum of the squared forces
+      double pathNorm = 0; //Norm of the path step
+      for (int p=pathStart;p<pathEnd;p++)
+      {
+        stepVecs[p] = trueForces[p];
+        NEBProjectForces(stepVecs[p],pathPos,nebMask,QMMMOpts,p);
+        if (stepVecs[p].cwiseAbs().maxCoeff() > maxForce)
+        {
+          maxForce = stepVecs[p].cwiseAbs().maxCoeff();
+        }
+        sumSq += stepVecs[p].squaredNorm();
+        if (beadFrozen[p])
+        {
+          //Frozen beads do not move
+          stepVecs[p].setZero();
+        }
+        stepVecs[p] *= sdStep;
+        pathNorm += stepVecs[p].squaredNorm();
+      }
+      RMSForce = sqrt(sumSq/(Ndof*(pathEnd-pathStart)));
+      forcesConv = ((maxForce <= maxFTol) && (RMSForce <= RMSFTol));
+      pathNorm = sqrt(pathNorm);
+      if (!forcesConv)
+      {
+        for (int p=pathStart;p<pathEnd;p++)
+        {
+          if (pathNorm > QMMMOpts.maxStep)
+          {
+            //Scale step size
+            stepVecs[p] *= (QMMMOpts.maxStep/pathNorm);
+          }
+          pathPos[p] += stepVecs[p];
+        }
+        GPNEBSetPath(QMMMData,pathPos,beadEval,oldPos,QMMMOpts);
+      }
+      //Print progress
+      Print_traj(QMMMData,qmFile,QMMMOpts);
+      cout << "    QM step: " << stepCt;
+      cout << " | Force calculations: " << Ncalls << '\n';
+      cout << "    Max. force: ";
+      cout << LICHEMFormFloat(maxForce,12);
+      cout << " eV/\u212B | RMS force: ";
+      cout << LICHEMFormFloat(RMSForce,12);
+      cout << " eV/\u212B" << '\n';
+      cout << "    TS bead: " << QMMMOpts.TSBead;
+      cout << " | TS energy: ";
+      cout << LICHEMFormFloat(trueE(QMMMOpts.TSBead),14);
+      cout << " eV" << '\n';
+    }
+    //Freeze converged beads and reactivate beads with moving neighbors
+    if (QMMMOpts.NEBFreeze)
+    {
+      int Nfrozen = 0; //Number of frozen beads
+      for (int p=0;p<QMMMOpts.NBeads;p++)
+      {
+        beadShift(p) = (pathPos[p]-oldPos[p]).norm();
+      }
+      for (int p=pathStart;p<pathEnd;p++)
+      {
+        bool beadConv = 0; //Flag for converged projected forces
+        if (beadEval[p])
+        {
+          VectorXd projForces = trueForces[p]; //Wrapper NEB forces
+          NEBProjectForces(projForces,pathPos,nebMask,QMMMOpts,p);
+          double beadRMS = sqrt(projForces.squaredNorm()/Ndof); //RMS force
+          if ((projForces.cwiseAbs().maxCoeff() <= maxFTol) &&
+             (beadRMS <= RMSFTol))
+          {
+            beadConv = 1;
+          }
+        }
+        if ((p == QMMMOpts.TSBead) && QMMMOpts.climb)
+        {
+          //The climbing image is never frozen
+          beadConv = 0;
+        }
+        double nearShift = 0; //Motion of the neighbors in the last step
+        if (p > 0)
+        {
+          nearShift += beadShift(p-1);
+        }
+        if (p < (QMMMOpts.NBeads-1))
+        {
+          nearShift += beadShift(p+1);
+        }
+        if (beadFrozen[p])
+        {
+          //Check if the bead needs to move again
+          frznShift(p) += nearShift;
+          if ((!beadConv) || (frznShift(p) > QMMMOpts.NEBFreezeTol))
+          {
+            beadFrozen[p] = 0;
+          }
+        }
+        else if (beadConv && (nearShift <= QMMMOpts.NEBFreezeTol))
+        {
+          //Only freeze beads with nearly stationary neighbors
+          beadFrozen[p] = 1;
+          frznShift(p) = 0;
+        }
+        if (beadFrozen[p])
+        {
+          Nfrozen += 1;
+        }
+      }
+      cout << "    Frozen beads: " << Nfrozen << '\n';
+    }
+    //Check convergence criteria
+    if (forcesConv)
+    {
+      if (!QMMMOpts.climb)
+      {
+        //Turn on climbing image forces
+        QMMMOpts.climb = 1;
+        cout << "    QM is nearly converged. Starting climbing image NEB...";
+        cout << '\n';
+      }
+      else
+      {
+        //Finish the optimization
+        pathDone = 1;
+        cout << "    QM optimization complete." << '\n';
+      }
+    }
+    cout << '\n';
+    cout.flush();
+  }
+  //Clean up
+  QMMMOpts.climb = savedClimb;
+  call.str("");
+  call << "rm -f LICHMNEBOpt.xyz MMCharges_*.txt";
+  globalSys = system(call.str().c_str());
+  //Finish and return
+  return;
+};
+
+//Saddle point search routines
+double DimerForces(vector<QMMMAtom>& QMMMData, VectorXd& dispVec,
+                   VectorXd& forces, QMMMSettings& QMMMOpts, int bead)
+{
+  //Calculates the forces on a displaced copy of the QM region
+  double E; //Energy
+  vector<QMMMAtom> dimerData = QMMMData; //Displaced structure
+  int ct = 0; //Counter
+  for (int i=0;i<Natoms;i++)
+  {
+    //Move QM atoms
+    if (dimerData[i].QMRegion || dimerData[i].PBRegion)
+    {
+      dimerData[i].P[bead].x += dispVec(ct);
+      dimerData[i].P[bead].y += dispVec(ct+1);
+      dimerData[i].P[bead].z += dispVec(ct+2);
+      ct += 3;
+    }
+  }
+  //Calculate forces
+  forces.setZero();
+  E = LICHEMForces(dimerData,forces,QMMMOpts,bead);
+  return E;
+};
+
+void LICHEMDimer(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts,
+                 VectorXd& dimerVec, int bead)
+{
+  //Dimer saddle point search with an L-BFGS translation step
+  stringstream call; //Stream for system calls and reading/writing files
+  int stepCt = 0; //Counter for optimization steps
+  fstream qmFile; //Generic file stream
+  int Ndof = 3*(Nqm+Npseudo); //Number of QM and PB degrees of freedom
+  double dimerDist = QMMMOpts.dimerDist; //Distance to the end of the dimer
+  double minAng = 0.001; //Smallest rotation worth a trial force call
+  //Initialize charges
+  if (Nmm > 0)
+  {
+    WriteChargeFile(QMMMData,QMMMOpts,bead);
+  }
+  //Initialize QM trajectory file
+  call.str("");
+  call << "QMOpt_" << bead << ".xyz";
+  qmFile.open(call.str().c_str(),ios_base::out);
+  //Create L-BFGS arrays for the translation
+  vector<VectorXd> stepHist; //Saved steps
+  vector<VectorXd> gradHist; //Saved changes in the effective gradient
+  VectorXd optVec(Ndof); //Translation step
+  VectorXd centVec(Ndof); //Zero displacement for the dimer midpoint
+  VectorXd dispVec(Ndof); //Displacement to the end of the dimer
+  VectorXd forces(Ndof); //Forces at the dimer midpoint
+  VectorXd endForces(Ndof); //Forces at the end of the dimer
+  VectorXd transForces(Ndof); //Effective forces for the translation
+  VectorXd oldTransForces(Ndof); //Effective forces from the last step
+  //Initialize arrays
+  optVec.setZero();
+  centVec.setZero();
+  transForces.setZero();
+  //Initialize optimization variables
+  double curv = 0; //Curvature along the dimer
+  double vecMax = 0; //Maxium atomic displacement
+  bool optDone = 0; //Flag to end the optimization
+  bool negCurv = 0; //Flag for a negative curvature on the last step
+  vector<QMMMAtom> oldQMMMData = QMMMData; //Structure from the last step
+  dimerVec.normalize(); //Unit vector along the dimer
+  //Calculate forces at the midpoint
+  DimerForces(QMMMData,centVec,forces,QMMMOpts,bead);
+  //Output initial RMS force
+  vecMax = forces.squaredNorm(); //Calculate initial RMS force
+  vecMax = sqrt(vecMax/Ndof);
+  cout << "    QM step: 0";
+  cout << " | RMS force: " << LICHEMFormFloat(vecMax,12);
+  cout << " eV/\u212B";
+  cout << '\n' << '\n';
+  cout.flush();
+  //Search for the saddle point
+  while ((!optDone) && (stepCt < QMMMOpts.maxOptSteps))
+  {
+    //Calculate forces at the end of the dimer
+    dispVec = dimerDist*dimerVec;
+    DimerForces(QMMMData,dispVec,endForces,QMMMOpts,bead);
+    //Forward difference estimate of the curvature
+    curv = (forces-endForces).dot(dimerVec)/dimerDist;
+    //Rotate the dimer towards the lowest curvature mode
+    VectorXd rotForces = 2*(endForces-forces); //Rotational forces
+    rotForces -= rotForces.dot(dimerVec)*dimerVec;
+    double rotMag = rotForces.norm(); //Magnitude of the rotational force
+    if (rotMag > 0)
+    {
+      VectorXd rotVec = rotForces/rotMag; //Direction of the rotation
+      double dCurv = -1*rotMag/dimerDist; //Derivative of the curvature
+      double trialAng; //Angle for the trial rotation
+      trialAng = -0.5*atan(dCurv/(2*abs(curv)));
+      if (trialAng > minAng)
+      {
+        //Calculate the curvature after a trial rotation
+        VectorXd trialVec; //Rotated dimer
+        trialVec = cos(trialAng)*dimerVec+sin(trialAng)*rotVec;
+        trialVec.normalize();
+        dispVec = dimerDist*trialVec;
+        DimerForces(QMMMData,dispVec,endForces,QMMMOpts,bead);
+        double trialCurv = (forces-endForces).dot(trialVec)/dimerDist;
+        //Fit the curvature to a Fourier series in the rotation angle
+        double b1 = 0.5*dCurv; //Sine coefficient
+        double a1; //Cosine coefficient
+        a1 = curv-trialCurv+b1*sin(2*trialAng);
+        a1 /= 1-cos(2*trialAng);
+        double a0 = 2*(curv-a1); //Constant term
+        double rotAng = 0.5*atan(b1/a1); //Angle to the minimum curvature
+        double newCurv; //Curvature after the rotation
+        newCurv = 0.5*a0+a1*cos(2*rotAng)+b1*sin(2*rotAng);
+        if (newCurv > curv)
+        {
+          //The stationary point is a maximum
+          rotAng += 0.5*pi;
+          newCurv = 0.5*a0+a1*cos(2*rotAng)+b1*sin(2*rotAng);
+        }
+        //Rotate the dimer
+        dimerVec = cos(rotAng)*dimerVec+sin(rotAng)*rotVec;
+        dimerVec.normalize();
+        curv = newCurv;
+      }
+    }
+    //Invert the force component along the dimer
+    bool oldNegCurv = negCurv; //Sign of the curvature on the last step
+    negCurv = (curv < 0);
+    oldTransForces = transForces;
+    if (negCurv)
+    {
+      transForces = forces-2*forces.dot(dimerVec)*dimerVec;
+    }
+    else
+    {
+      //Only move uphill along the dimer in convex regions
+      transForces = -1*forces.dot(dimerVec)*dimerVec;
+    }
+    //Update the translation history
+    if ((stepCt > 0) && negCurv && oldNegCurv)
+    {
+      VectorXd gradDiff = oldTransForces-transForces; //Change in gradient
+      LBFGSUpdate(optVec,gradDiff,stepHist,gradHist,QMMMOpts.LBFGSMem);
+    }
+    else
+    {
+      //The effective potential changed, restart the history
+      stepHist.clear();
+      gradHist.clear();
+    }
+    //Calculate the translation step
+    if (negCurv)
+    {
+      optVec = LBFGSDirection(transForces,stepHist,gradHist);
+      if (stepHist.size() == 0)
+      {
+        //Steepest descent step
+        optVec *= QMMMOpts.stepScale;
+      }
+      if (optVec.dot(transForces) <= 0)
+      {
+        //The direction is uphill, restart from steepest descent
+        stepHist.clear();
+        gradHist.clear();
+        optVec = QMMMOpts.stepScale*transForces;
+      }
+    }
+    else
+    {
+      //Take a full step out of the convex region
+      optVec = transForces;
+      if (optVec.norm() < (1e-12))
+      {
+        //The dimer is at a minimum along its direction
+        optVec = dimerVec;
+      }
+      optVec *= (QMMMOpts.maxStep/optVec.norm());
+    }
+    //Check step size
+    vecMax = optVec.norm();
+    if (vecMax > QMMMOpts.maxStep)
+    {
+      //Scale step size
+      optVec *= (QMMMOpts.maxStep/vecMax);
+    }
+    //Update positions
+    oldQMMMData = QMMMData;
+    int ct = 0; //Counter
+    for (int i=0;i<Natoms;i++)
+    {
+      //Move QM atoms
+      if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+      {
+        QMMMData[i].P[bead].x += optVec(ct);
+        QMMMData[i].P[bead].y += optVec(ct+1);
+        QMMMData[i].P[bead].z += optVec(ct+2);
+        ct += 3;
+      }
+    }
+    //Calculate forces at the new midpoint
+    DimerForces(QMMMData,centVec,forces,QMMMOpts,bead);
+    stepCt += 1;
+    //Print curvature and structure
+    cout << "    Dimer curvature: " << LICHEMFormFloat(curv,12);
+    cout << " eV/\u212B\u00B2";
+    cout << '\n';
+    Print_traj(QMMMData,qmFile,QMMMOpts);
+    //Check convergence
+    optDone = OptConverged(QMMMData,oldQMMMData,forces,stepCt,QMMMOpts,
+                           bead,1);
+    if (!negCurv)
+    {
+      //A saddle point needs a negative curvature
+      optDone = 0;
+    }
+  }
+  //Clean up files
+  call.str("");
+  call << "rm -f QMOpt_" << bead << ".xyz";
+  call << " MMCharges_" << bead << ".txt";
+  globalSys = system(call.str().c_str());
+  //Finish and return
+  return;
+};
+
+//Path ensemble samping routines
+int FBNEBMCMove(vector<QMMMAtom>& QMMMData, vector<VectorXd>& allForces,
+                QMMMSettings& QMMMOpts, VectorXd& Emc)
+{
+  //Function to try a force-bias Monte Carlo move
+  int acc = 0; //Accept or reject
+  double randNum; //Random number
+  int Ndof = 3*(Nqm+Npseudo); //Number of QM degrees of freedom
+  VectorXd allEnergies(QMMMOpts.NBeads); //Energies of individual beads
+  VectorXd randNums(QMMMOpts.NBeads); //Array to store random numbers
+  //Save structure and forces for rejected moves
+  VectorXd oldEnergies = Emc;
+  vector<QMMMAtom> oldQMMMData = QMMMData;
+  vector<VectorXd> oldForces = allForces;
+  vector<VectorXd> tempForces = allForces; //Includes tangents
+  //Add tangent forces
+  if (QMMMOpts.NBeads > 1)
+  {
+    //Only calculate tangent forces for multireplica simulations
+    //Align neighboring replicas
+    vector<VectorXd> pathDistNext; //Displacements to p+1
+    vector<VectorXd> pathDistPrev; //Displacements to p-1
+    KabschPathDisplacement(QMMMData,QMMMOpts,pathDistNext,pathDistPrev);
+    for (int p=0;p<QMMMOpts.NBeads;p++)
+    {
+      //Calculate QM tangent forces
+      int ct; //Generic counter
+      double forcesDotTan; //Overlap of vectors
+      double springDist; //Distance between the neighboring beads
+      //Read old forces in the QM region
+      VectorXd forces(Ndof); //Temporary force array
+      forces.setZero();
+      ct = 0;
+      for (int i=0;i<Natoms;i++)
+      {
+        if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+        {
+          //X component
+          forces(ct) = tempForces[p](3*i);
+          ct += 1;
+          //Y component
+          forces(ct) = tempForces[p](3*i+1);
+          ct += 1;
+          //Z component
+          forces(ct) = tempForces[p](3*i+2);
+          ct += 1;
+        }
+      }
+      VectorXd QMTangent(Ndof); //Tangent vector
+      VectorXd distp1(Ndof); //Displacement for p+1
+      VectorXd distm1(Ndof); //Displacement for p-1
+      if ((p != 0) && (p != (QMMMOpts.NBeads-1)))
+      {
+        //Calculate tangents for middle replicas
+        distp1 = pathDistNext[p];
+        distp1 *= -1; //Change direction
+        distm1 = pathDistPrev[p];
+        //Calculate tangent
+        QMTangent = NEBTangent(distp1,distm1,QMMMOpts,p);
+      }
+      else
+      {
+        //No tangent for the reactant and product
+        QMTangent.setZero();
         //Get rid of displacements for spring force calculation
         distp1.setZero();
         distm1.setZero();
@@ -1389,7 +2372,7 @@ int FBNEBMCMove(vector<QMMMAtom>& QMMMData, vector<VectorXd>& allForces,
   for (int p=0;p<QMMMOpts.NBeads;p++)
   {
     //Separate the serial random numbers
-    randNum = (((double)rand())/((double)RAND_MAX)); //Number between 0 and 1
+    randNum = randGen.uniform(); //Number between 0 and 1
     randNum *= 4.0; //Now between 0 and 4; Average: 2.0
     randNum -= 2.0; //Now between -2 and 2; Abs. average: 1.0
     randNums(p) = randNum*mcStep; //Scale displacement
@@ -1434,84 +2417,18 @@ int FBNEBMCMove(vector<QMMMAtom>& QMMMData, vector<VectorXd>& allForces,
   }
   //Calculate new energies and forces
   allEnergies.setZero();
-  #pragma omp parallel for schedule(dynamic) num_threads(mcThreads) \
-          reduction(+:QMTime,MMTime)
+  #pragma omp parallel for schedule(dynamic) num_threads(mcThreads)
   for (int p=0;p<QMMMOpts.NBeads;p++)
   {
-    //Calculate the energy of bead p
-    double E = 0;
-    double Emm = 0;
-    double Eqm = 0;
-    //Create blank force array
-    VectorXd forces(Ndof);
-    forces.setZero();
-    //Calculate forces (QM part)
-    if (Gaussian)
-    {
-      int tStart = (unsigned)time(0);
-      Eqm += GaussianForces(QMMMData,forces,QMMMOpts,p);
-      QMTime += (unsigned)time(0)-tStart;
-    }
-    if (PSI4)
-    {
-      int tStart = (unsigned)time(0);
-      Eqm += PSI4Forces(QMMMData,forces,QMMMOpts,p);
-      QMTime += (unsigned)time(0)-tStart;
-      //Delete annoying useless files
-      globalSys = system("rm -f psi.* timer.*");
-    }
-    if (NWChem)
-    {
-      int tStart = (unsigned)time(0);
-      Eqm += NWChemForces(QMMMData,forces,QMMMOpts,p);
-      QMTime += (unsigned)time(0)-tStart;
-    }
-    E += Eqm;
-    //Calculate forces (MM part)
-    if (TINKER)
-    {
-      int tStart = (unsigned)time(0);
-      E += TINKERForces(QMMMData,forces,QMMMOpts,p);
-      if (AMOEBA || QMMMOpts.useImpSolv)
-      {
-        //Forces from MM polarization
-        E += TINKERPolForces(QMMMData,forces,QMMMOpts,p);
-      }
-      Emm += TINKEREnergy(QMMMData,QMMMOpts,p);
-      MMTime += (unsigned)time(0)-tStart;
-    }
-    allEnergies(p) = Eqm+Emm; //Save the energy for calculating statistics
-    //Save QM forces to global array
-    int ct = 0; //Generic counter
-    for (int i=0;i<Natoms;i++)
-    {
-      if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
-      {
-        //Add X component
-        allForces[p](3*i) = forces(ct);
-        ct += 1;
-        //Add Y component
-        allForces[p](3*i+1) = forces(ct);
-        ct += 1;
-        //Add Z component
-        allForces[p](3*i+2) = forces(ct);
-        ct += 1;
-      }
-    }
-    //Add MM forces
-    if (TINKER)
-    {
-      int tStart = (unsigned)time(0);
-      E = TINKERMMForces(QMMMData,allForces[p],QMMMOpts,p);
-      MMTime += (unsigned)time(0)-tStart;
-    }
+    //Save the energy for calculating statistics
+    allEnergies(p) = LICHEMBeadForces(QMMMData,allForces[p],QMMMOpts,p);
   }
   //Accept or reject
   randNums.setZero();
   for (int p=0;p<QMMMOpts.NBeads;p++)
   {
     //Separate the serial random numbers
-    randNum = (((double)rand())/((double)RAND_MAX)); //Number between 0 and 1
+    randNum = randGen.uniform(); //Number between 0 and 1
     randNums(p) = randNum;
   }
   #pragma omp parallel for schedule(dynamic) reduction(+:acc)
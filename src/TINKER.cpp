@@ -698,7 +698,8 @@ double TINKERForces(vector<QMMMAtom>& QMMMData, VectorXd& forces,
       }
     }
   }
-  if (AMOEBA)
+  //NB: GEM densities replace the QM-MM multipole interactions
+  if (AMOEBA || QMMMOpts.useGEMDen)
   {
     for (int i=0;i<Natoms;i++)
     {
@@ -827,6 +828,11 @@ double TINKERForces(vector<QMMMAtom>& QMMMData, VectorXd& forces,
   globalSys = system(call.str().c_str());
   //Return
   Emm *= kcal2eV;
+  if (QMMMOpts.useGEMDen)
+  {
+    //Add frozen density forces on the QM atoms
+    Emm += GEMForces(QMMMData,forces,QMMMOpts,bead,0);
+  }
   return Emm;
 };
 
@@ -967,6 +973,22 @@ double TINKERMMForces(vector<QMMMAtom>& QMMMData, VectorXd& forces,
       }
     }
   }
+  if (QMMMOpts.useGEMDen)
+  {
+    for (int i=0;i<Natoms;i++)
+    {
+      //GEM densities replace the QM-MM multipole interactions
+      if (QMMMData[i].QMRegion || QMMMData[i].PBRegion)
+      {
+        double qi = QMMMData[i].MP[bead].q; //Save a copy
+        QMMMData[i].MP[bead].q = 0;
+        WriteTINKMPole(QMMMData,outFile,i,bead);
+        QMMMData[i].MP[bead].q = qi; //Restore charge
+        outFile << "polarize -" << (QMMMData[i].id+1) << " 0.0 0.0";
+        outFile << '\n';
+      }
+    }
+  }
   outFile.flush();
   outFile.close();
   //Create TINKER xyz file from the structure
@@ -1080,6 +1102,11 @@ double TINKERMMForces(vector<QMMMAtom>& QMMMData, VectorXd& forces,
   call << " LICHM_" << bead << ".grad";
   call << " LICHM_" << bead << ".err";
   globalSys = system(call.str().c_str());
+  if (QMMMOpts.useGEMDen)
+  {
+    //Add frozen density forces on the MM atoms
+    GEMForces(QMMMData,forces,QMMMOpts,bead,1);
+  }
   //Return energy for error checking purposes
   return Emm;
 };
@@ -1565,6 +1592,11 @@ double TINKEREnergy(vector<QMMMAtom>& QMMMData, QMMMSettings& QMMMOpts,
   }
   //Change units
   E *= kcal2eV;
+  if (QMMMOpts.useGEMDen)
+  {
+    //Add frozen density interactions
+    E += GEMEnergy(QMMMData,QMMMOpts,bead);
+  }
   return E;
 };
 
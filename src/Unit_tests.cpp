@@ -0,0 +1,1039 @@
+/*
+
+###############################################################################
+#                                                                             #
+#                 LICHEM: Layered Interacting CHEmical Models                 #
+#                              By: Eric G. Kratz                              #
+#                                                                             #
+#                      Symbiotic Computational Chemistry                      #
+#                                                                             #
+###############################################################################
+
+ Unit tests for the numerical kernels in LICHEM. The tests compare each
+ kernel with an analytic or published reference value and do not call any
+ of the QM or MM packages.
+
+ Usage:
+ user:$ lichem -unittests
+
+*/
+
+/*!
+  \ingroup tests
+*/
+///@{
+
+//Unit test utility functions
+bool UnitTestClose(double val, double ref, double tol)
+{
+  //Check if a value matches the reference within a relative tolerance
+  double scale = abs(ref); //Scale for the tolerance
+  if (scale < 1)
+  {
+    //Use an absolute tolerance near zero
+    scale = 1;
+  }
+  return (abs(val-ref) <= (tol*scale));
+};
+
+void PrintUnitTest(string testName, bool testPass)
+{
+  //Print the result in a format read by the test suite
+  cout << "Unit test " << testName << ": ";
+  if (testPass)
+  {
+    cout << "Pass";
+  }
+  else
+  {
+    cout << "Fail";
+  }
+  cout << '\n';
+  cout.flush();
+  return;
+};
+
+void UnitTestGEMPair(vector<QMMMAtom>& QMMMData, Coord& posH)
+{
+  //Create a QM oxygen and an MM hydrogen with frozen densities
+  QMMMData.clear();
+  QMMMData.resize(2);
+  for (int i=0;i<2;i++)
+  {
+    QMMMData[i].QMRegion = 0;
+    QMMMData[i].MMRegion = 1;
+    QMMMData[i].PBRegion = 0;
+    QMMMData[i].BARegion = 0;
+    QMMMData[i].frozen = 0;
+    QMMMData[i].P.resize(1);
+    QMMMData[i].MP.resize(1);
+    QMMMData[i].MP[0].q = 0;
+  }
+  QMMMData[0].QMRegion = 1;
+  QMMMData[0].MMRegion = 0;
+  QMMMData[0].QMTyp = "O";
+  QMMMData[0].P[0].x = 0;
+  QMMMData[0].P[0].y = 0;
+  QMMMData[0].P[0].z = 0;
+  QMMMData[1].QMTyp = "H";
+  QMMMData[1].P[0] = posH;
+  for (int i=0;i<2;i++)
+  {
+    GEMDen tmp(QMMMData[i].QMTyp,"LICHMTest");
+    QMMMData[i].GEM.push_back(tmp);
+  }
+  Natoms = 2;
+  return;
+};
+
+double UnitTestHarmonicWell(vector<QMMMAtom>& QMMMData, double kWell,
+                            int Nbeads, vector<VectorXd>& allForces)
+{
+  //Average energy and bead forces of atoms in a harmonic well at the origin
+  double E = 0; //Sum of the bead energies
+  allForces.resize(Nbeads);
+  for (int p=0;p<Nbeads;p++)
+  {
+    allForces[p].resize(3*Natoms);
+    for (int i=0;i<Natoms;i++)
+    {
+      Coord& pos = QMMMData[i].P[p]; //Position of the bead
+      E += 0.5*kWell*(pos.x*pos.x+pos.y*pos.y+pos.z*pos.z);
+      allForces[p](3*i) = -1*kWell*pos.x;
+      allForces[p](3*i+1) = -1*kWell*pos.y;
+      allForces[p](3*i+2) = -1*kWell*pos.z;
+    }
+  }
+  return E/Nbeads;
+};
+
+//Unit tests for the frozen density kernels
+bool TestGEMTwoSite()
+{
+  //Compare the GEM energies and forces of two s-type densities with the
+  //analytic results for spherical Gaussian charge distributions
+  bool testPass = 1; //Result of the test
+  fstream basFile; //Basis set file
+  basFile.open("LICHMTest.herm",ios_base::out);
+  basFile << "O 2" << '\n';
+  basFile << "-2.0 0.9 0 0 0" << '\n';
+  basFile << "-0.5 3.0 0 0 0" << '\n';
+  basFile << "H 1" << '\n';
+  basFile << "-0.3 0.6 0 0 0" << '\n';
+  basFile.close();
+  //Analytic reference
+  double cO[2] = {-2.0,-0.5}; //Oxygen coefficients
+  double aO[2] = {0.9,3.0}; //Oxygen exponents
+  double cH = -0.3; //Hydrogen coefficient
+  double aH = 0.6; //Hydrogen exponent
+  Coord posH; //Position of the hydrogen
+  posH.x = 1.2;
+  posH.y = 0.3;
+  posH.z = -0.4;
+  double R = sqrt(posH.x*posH.x+posH.y*posH.y+posH.z*posH.z); //Distance
+  double Rb = R/bohrRad; //Distance (a.u.)
+  double Eref = coul2eV*8*1/R; //Nuclear repulsion
+  double dEref = -1*coul2eV*8*1/(R*R); //Derivative with respect to R
+  double Sref = 0; //Density overlap
+  double dSref = 0; //Derivative of the overlap
+  vector<double> qDen,aDen,zOther; //Gaussian charges and exponents
+  for (int k=0;k<2;k++)
+  {
+    qDen.push_back(cO[k]*pow(pi/aO[k],1.5));
+    aDen.push_back(aO[k]);
+    zOther.push_back(1);
+  }
+  qDen.push_back(cH*pow(pi/aH,1.5));
+  aDen.push_back(aH);
+  zOther.push_back(8);
+  for (int k=0;k<3;k++)
+  {
+    //Density-nucleus interactions
+    double rt = sqrt(aDen[k]); //Square root of the exponent
+    double Ek = har2eV*qDen[k]*zOther[k]; //Prefactor
+    Eref += Ek*erf(rt*Rb)/Rb;
+    dEref += Ek*((2*rt*exp(-1*aDen[k]*Rb*Rb)/(sqrt(pi)*Rb))-
+             (erf(rt*Rb)/(Rb*Rb)))/bohrRad;
+  }
+  for (int k=0;k<2;k++)
+  {
+    //Density-density interactions
+    double mu = aO[k]*aH/(aO[k]+aH); //Reduced exponent
+    double rt = sqrt(mu); //Square root of the reduced exponent
+    double Ek = har2eV*qDen[k]*qDen[2]; //Prefactor
+    Eref += Ek*erf(rt*Rb)/Rb;
+    dEref += Ek*((2*rt*exp(-1*mu*Rb*Rb)/(sqrt(pi)*Rb))-
+             (erf(rt*Rb)/(Rb*Rb)))/bohrRad;
+    double Sk = cO[k]*cH*pow(pi/(aO[k]+aH),1.5)*exp(-1*mu*Rb*Rb);
+    Sref += Sk;
+    dSref += -2*mu*Rb*Sk/bohrRad;
+  }
+  //Calculate the GEM energies
+  vector<QMMMAtom> QMMMData; //Test atoms
+  QMMMSettings QMMMOpts; //Test settings
+  QMMMOpts.GEMExch = 0.5;
+  UnitTestGEMPair(QMMMData,posH);
+  double Ecoul = GEMCoulomb(QMMMData,0);
+  double Sij = GEMOverlap(QMMMData,0);
+  VectorXd forces(6); //Forces on the MM atoms
+  VectorXd forcesQM(3); //Forces on the QM atoms
+  forces.setZero();
+  forcesQM.setZero();
+  double Etot = GEMForces(QMMMData,forces,QMMMOpts,0,1);
+  GEMForces(QMMMData,forcesQM,QMMMOpts,0,0);
+  //Compare with the reference
+  testPass = testPass && UnitTestClose(Ecoul,Eref,1e-6);
+  testPass = testPass && UnitTestClose(Sij,Sref,1e-10);
+  testPass = testPass && UnitTestClose(Etot,Eref+0.5*Sref,1e-6);
+  double dEtot = dEref+0.5*dSref; //Total derivative
+  testPass = testPass && UnitTestClose(forces(3),-1*dEtot*posH.x/R,1e-8);
+  testPass = testPass && UnitTestClose(forces(4),-1*dEtot*posH.y/R,1e-8);
+  testPass = testPass && UnitTestClose(forces(5),-1*dEtot*posH.z/R,1e-8);
+  testPass = testPass && UnitTestClose(forcesQM(0),-1*forces(3),1e-10);
+  testPass = testPass && UnitTestClose(forces(0),0,1e-10);
+  //MM-MM pairs are left to TINKER
+  QMMMData[0].QMRegion = 0;
+  QMMMData[0].MMRegion = 1;
+  testPass = testPass && (GEMCoulomb(QMMMData,0) == 0);
+  //Clean up files
+  globalSys = system("rm -f LICHMTest.herm");
+  return testPass;
+};
+
+bool TestGEMFrame()
+{
+  //Check that a density with p and d functions rotates with the local
+  //frame by comparing potentials at points which move with the frame
+  bool testPass = 1; //Result of the test
+  fstream basFile; //Basis set file
+  basFile.open("LICHMFrame.herm",ios_base::out);
+  basFile << "N 4" << '\n';
+  basFile << "-1.0 0.8 0 0 0" << '\n';
+  basFile << "0.7 1.1 1 0 0" << '\n';
+  basFile << "0.4 0.9 1 1 0" << '\n';
+  basFile << "-0.3 1.3 0 0 2" << '\n';
+  basFile.close();
+  GEMDen testDen("N","LICHMFrame"); //Test density
+  //Local frame from an arbitrary rotation
+  Vector3d rotAxis(1.0,2.0,-1.0); //Axis of the rotation
+  rotAxis.normalize();
+  Matrix3d rotMat = AngleAxisd(0.7,rotAxis).toRotationMatrix();
+  Vector3d vecX = rotMat.col(0); //Local x axis
+  Vector3d vecY = rotMat.col(1); //Local y axis
+  Vector3d vecZ = rotMat.col(2); //Local z axis
+  Vector3d axX(1.0,0.0,0.0); //Global x axis
+  Vector3d axY(0.0,1.0,0.0); //Global y axis
+  Vector3d axZ(0.0,0.0,1.0); //Global z axis
+  Coord origin; //Position of the reference density
+  origin.x = 0;
+  origin.y = 0;
+  origin.z = 0;
+  Coord atPos; //Position of the rotated density
+  atPos.x = 0.3;
+  atPos.y = -0.2;
+  atPos.z = 0.5;
+  vector<HermGau> locDens,rotDens,fixDens; //Placed densities
+  locDens = testDen.placeDensity(origin,axX,axY,axZ);
+  rotDens = testDen.placeDensity(atPos,vecX,vecY,vecZ);
+  fixDens = testDen.placeDensity(atPos,axX,axY,axZ);
+  double maxDiff = 0; //Largest change from ignoring the frame
+  for (int t=0;t<3;t++)
+  {
+    //Probe points in the local frame
+    Vector3d locProbe(0.4+0.3*t,-0.5+0.2*t,0.6-0.4*t);
+    Vector3d rotProbe = rotMat*locProbe; //Probe in the global frame
+    Coord posL,posR,posF; //Positions of the probe charges
+    posL.x = locProbe(0);
+    posL.y = locProbe(1);
+    posL.z = locProbe(2);
+    posR.x = atPos.x+rotProbe(0);
+    posR.y = atPos.y+rotProbe(1);
+    posR.z = atPos.z+rotProbe(2);
+    posF.x = atPos.x+locProbe(0);
+    posF.y = atPos.y+locProbe(1);
+    posF.z = atPos.z+locProbe(2);
+    double Eloc = 0; //Potential in the local frame
+    double Erot = 0; //Potential after the rotation
+    double Efix = 0; //Potential without the rotation
+    for (unsigned int k=0;k<locDens.size();k++)
+    {
+      Eloc += HermCoul1e(locDens[k],1.0,posL);
+    }
+    for (unsigned int k=0;k<rotDens.size();k++)
+    {
+      Erot += HermCoul1e(rotDens[k],1.0,posR);
+    }
+    for (unsigned int k=0;k<fixDens.size();k++)
+    {
+      Efix += HermCoul1e(fixDens[k],1.0,posR);
+    }
+    testPass = testPass && UnitTestClose(Erot,Eloc,1e-10);
+    maxDiff = max(maxDiff,abs(Efix-Eloc));
+  }
+  //The test points must be sensitive to the orientation
+  testPass = testPass && (maxDiff > 1e-3);
+  //Clean up files
+  globalSys = system("rm -f LICHMFrame.herm");
+  return testPass;
+};
+
+bool TestHermiteDerivs()
+{
+  //Check the p-type Hermite integrals against derivatives of the s-type
+  //integrals with respect to the Gaussian center
+  bool testPass = 1; //Result of the test
+  double h = 0.0001; //Finite-difference step (Ang)
+  Coord posC; //Position of the point-charge
+  posC.x = 0.7;
+  posC.y = -0.2;
+  posC.z = 0.5;
+  HermGau Gp(0.8,1.1,1,0,0,0.1,0.2,0.0); //p-type Gaussian
+  HermGau Gs(0.6,0.7,0,0,0,0.9,-0.3,0.4); //s-type Gaussian
+  HermGau GsP(0.8,1.1,0,0,0,0.1+h,0.2,0.0); //Displaced s-type
+  HermGau GsM(0.8,1.1,0,0,0,0.1-h,0.2,0.0); //Displaced s-type
+  double scale = bohrRad/(2*h); //Derivative with respect to x (a.u.)
+  double ref,val; //Reference and test values
+  //Charge-density integral
+  ref = (HermCoul1e(GsP,0.4,posC)-HermCoul1e(GsM,0.4,posC))*scale;
+  val = HermCoul1e(Gp,0.4,posC);
+  testPass = testPass && UnitTestClose(val,ref,1e-6);
+  //Density-density integral
+  ref = (HermCoul2e(GsP,Gs)-HermCoul2e(GsM,Gs))*scale;
+  val = HermCoul2e(Gp,Gs);
+  testPass = testPass && UnitTestClose(val,ref,1e-6);
+  //Density overlap
+  ref = (HermOverlap(GsP,Gs)-HermOverlap(GsM,Gs))*scale;
+  val = HermOverlap(Gp,Gs);
+  testPass = testPass && UnitTestClose(val,ref,1e-6);
+  return testPass;
+};
+
+//Unit tests for the multipoles
+bool TestQuadDiag()
+{
+  //Compare the batched 3x3 quadrupole eigensolver with the symmetric
+  //eigensolver for random and degenerate (two equal eigenvalues) tensors
+  bool testPass = 1; //Result of the test
+  int Npoles = 300; //Number of test quadrupoles
+  vector<MPole> poles; //Cartesian multipoles
+  vector<RedMPole> SHPoles; //Diagonalized multipoles
+  vector<Matrix3d> QMats; //Quadrupole tensors (Ang^2)
+  randGen.seed(2468,1);
+  for (int i=0;i<Npoles;i++)
+  {
+    Matrix3d QPole; //Symmetric tensor (a.u.)
+    double scale = pow(10.0,randGen.integer(0,5)-2); //Size of the tensor
+    if ((i%3) == 0)
+    {
+      //Random symmetric tensor
+      for (int j=0;j<3;j++)
+      {
+        for (int k=0;k<=j;k++)
+        {
+          QPole(j,k) = scale*randGen.gauss(0);
+          QPole(k,j) = QPole(j,k);
+        }
+      }
+    }
+    else
+    {
+      //Rotated tensor with a repeated smallest or largest eigenvalue
+      Vector4d quat; //Random rotation
+      for (int j=0;j<4;j++)
+      {
+        quat(j) = randGen.gauss(0);
+      }
+      quat.normalize();
+      Quaterniond randRot(quat(0),quat(1),quat(2),quat(3));
+      Matrix3d rotMat = randRot.toRotationMatrix();
+      Vector3d diagVals; //Eigenvalues of the tensor
+      diagVals(0) = scale*randGen.gauss(0);
+      diagVals(1) = diagVals(0);
+      diagVals(2) = diagVals(0)+scale*(1+randGen.uniform(0));
+      if ((i%3) == 2)
+      {
+        //Repeated largest eigenvalue
+        diagVals(2) = diagVals(0)-scale*(1+randGen.uniform(0));
+      }
+      QPole = rotMat*diagVals.asDiagonal()*rotMat.transpose();
+    }
+    MPole tmp; //New multipole
+    tmp.q = randGen.gauss(0);
+    tmp.Dx = randGen.gauss(0);
+    tmp.Dy = randGen.gauss(0);
+    tmp.Dz = randGen.gauss(0);
+    tmp.Qxx = QPole(0,0);
+    tmp.Qxy = QPole(0,1);
+    tmp.Qxz = QPole(0,2);
+    tmp.Qyy = QPole(1,1);
+    tmp.Qyz = QPole(1,2);
+    tmp.Qzz = QPole(2,2);
+    poles.push_back(tmp);
+    QMats.push_back(QPole*bohrRad*bohrRad);
+  }
+  Cart2SphHarmBatch(poles,SHPoles);
+  for (int i=0;i<Npoles;i++)
+  {
+    SelfAdjointEigenSolver<Matrix3d> refAnalysis(QMats[i]);
+    Vector3d refVals = refAnalysis.eigenvalues(); //Ascending eigenvalues
+    double tol = 1e-10*refVals.cwiseAbs().maxCoeff(); //Tolerance
+    Matrix3d vecs; //Eigenvectors from the batched solver
+    vecs.col(0) = SHPoles[i].vecX;
+    vecs.col(1) = SHPoles[i].vecY;
+    vecs.col(2) = SHPoles[i].vecZ;
+    //The eigenvectors are orthonormal
+    double orthErr = (vecs.transpose()*vecs-Matrix3d::Identity()).norm();
+    testPass = testPass && (orthErr < 1e-10);
+    for (int j=0;j<3;j++)
+    {
+      //Compare the eigenpairs with the reference eigenvalues
+      Vector3d vecJ = vecs.col(j); //Eigenvector
+      double valJ = vecJ.dot(QMats[i]*vecJ); //Rayleigh quotient
+      testPass = testPass && (abs(valJ-refVals(j)) < tol);
+      testPass = testPass && ((QMats[i]*vecJ-valJ*vecJ).norm() < tol);
+    }
+    //Spherical harmonic quadrupoles
+    double Q22cRef = (refVals(0)-refVals(1))/sqrt(3); //Reference Q22c
+    testPass = testPass && (abs(SHPoles[i].Q20-refVals(2)) < tol);
+    testPass = testPass && (abs(SHPoles[i].Q22c-Q22cRef) < tol);
+    //Rotated dipoles keep their length
+    Vector3d dipole(poles[i].Dx,poles[i].Dy,poles[i].Dz); //Dipole (a.u.)
+    Vector3d SHDipole(SHPoles[i].Q11c,SHPoles[i].Q11s,SHPoles[i].Q10);
+    testPass = testPass && UnitTestClose(SHDipole.norm(),
+                                         dipole.norm()*bohrRad,1e-10);
+  }
+  return testPass;
+};
+
+//Unit tests for the structure alignment
+bool TestQCPAlignment()
+{
+  //Compare the QCP superposition with the SVD Kabsch algorithm for random
+  //structures, including linear (two atom) structures
+  bool testPass = 1; //Result of the test
+  int Nsizes[3] = {2,3,8}; //Numbers of atoms
+  randGen.seed(1234,1);
+  for (int n=0;n<3;n++)
+  {
+    int Nat = Nsizes[n]; //Number of atoms
+    for (int t=0;t<500;t++)
+    {
+      MatrixXd A(Nat,3); //First structure
+      MatrixXd B(Nat,3); //Second structure
+      double scale = pow(10.0,randGen.integer(0,7)-3); //Size of the structures
+      for (int i=0;i<Nat;i++)
+      {
+        for (int j=0;j<3;j++)
+        {
+          A(i,j) = scale*(randGen.uniform(0)-0.5);
+          B(i,j) = scale*(randGen.uniform(0)-0.5);
+        }
+      }
+      if ((t%2) == 1)
+      {
+        //Rotated and translated copy of the first structure
+        Vector4d quat; //Random rotation
+        for (int j=0;j<4;j++)
+        {
+          quat(j) = randGen.gauss(0);
+        }
+        quat.normalize();
+        Quaterniond randRot(quat(0),quat(1),quat(2),quat(3));
+        B = A*randRot.toRotationMatrix();
+        for (int i=0;i<Nat;i++)
+        {
+          B(i,0) += scale;
+        }
+      }
+      //Reference rotation from the SVD
+      MatrixXd refA = A; //Centered copy of A
+      MatrixXd refB = B; //Centered copy of B
+      Vector3d centA = A.colwise().mean(); //Center of A
+      Vector3d centB = B.colwise().mean(); //Center of B
+      for (int i=0;i<Nat;i++)
+      {
+        refA.row(i) -= centA.transpose();
+        refB.row(i) -= centB.transpose();
+      }
+      Matrix3d coVar = refB.transpose()*refA; //Covariance matrix
+      JacobiSVD<Matrix3d> svd(coVar,ComputeFullU|ComputeFullV);
+      Matrix3d chiral = Matrix3d::Identity(); //Prevents reflections
+      if ((svd.matrixU()*svd.matrixV().transpose()).determinant() < 0)
+      {
+        chiral(2,2) = -1;
+      }
+      Matrix3d rotMat = svd.matrixU()*chiral*svd.matrixV().transpose();
+      double refDist = (refA-refB*rotMat).norm(); //Reference distance
+      //QCP superposition
+      KabschRotation(A,B,Nat);
+      double qcpDist = (A-B).norm(); //QCP distance
+      if (abs(qcpDist-refDist) > (1e-9*scale*sqrt(Nat)))
+      {
+        testPass = 0;
+      }
+    }
+  }
+  return testPass;
+};
+
+//Unit tests for the optimizers
+bool TestLindhHessian()
+{
+  //Check the Lindh model Hessian against the published stretch parameters
+  //and the invariance of a bent triatomic Hessian
+  bool testPass = 1; //Result of the test
+  vector<QMMMAtom> QMMMData; //Test atoms
+  QMMMData.resize(3);
+  for (int i=0;i<3;i++)
+  {
+    QMMMData[i].QMRegion = 1;
+    QMMMData[i].MMRegion = 0;
+    QMMMData[i].PBRegion = 0;
+    QMMMData[i].BARegion = 0;
+    QMMMData[i].P.resize(1);
+    QMMMData[i].P[0].x = 0;
+    QMMMData[i].P[0].y = 0;
+    QMMMData[i].P[0].z = 0;
+  }
+  Natoms = 2;
+  Nqm = 2;
+  Npseudo = 0;
+  //H2 at the reference distance has the unscreened force constant
+  QMMMData[0].QMTyp = "H";
+  QMMMData[1].QMTyp = "H";
+  QMMMData[1].P[0].x = 1.35*bohrRad;
+  MatrixXd lindhHess = LindhHessian(QMMMData,0); //Model Hessian (a.u.)
+  testPass = testPass && UnitTestClose(lindhHess(0,0),0.45,1e-12);
+  testPass = testPass && UnitTestClose(lindhHess(0,3),-0.45,1e-12);
+  testPass = testPass && UnitTestClose(lindhHess(1,1),0.0,1e-12);
+  //Screened C-O stretch
+  QMMMData[0].QMTyp = "C";
+  QMMMData[1].QMTyp = "O";
+  QMMMData[1].P[0].x = 1.2;
+  lindhHess = LindhHessian(QMMMData,0);
+  double rCO = 1.2/bohrRad; //Bond length (bohr)
+  double kRef = 0.45*exp(0.28*(2.87*2.87-rCO*rCO)); //Force constant
+  testPass = testPass && UnitTestClose(lindhHess(0,0),kRef,1e-12);
+  //Bent water has no forces along the rigid body motions
+  Natoms = 3;
+  Nqm = 3;
+  double ang = 104.5*pi/180; //HOH angle
+  QMMMData[0].QMRegion = 1;
+  QMMMData[0].MMRegion = 0;
+  QMMMData[0].QMTyp = "O";
+  QMMMData[1].QMTyp = "H";
+  QMMMData[2].QMTyp = "H";
+  QMMMData[1].P[0].x = 0.96;
+  QMMMData[2].P[0].x = 0.96*cos(ang);
+  QMMMData[2].P[0].y = 0.96*sin(ang);
+  lindhHess = LindhHessian(QMMMData,0);
+  testPass = testPass && ((lindhHess-lindhHess.transpose()).norm() < 1e-12);
+  for (int k=0;k<3;k++)
+  {
+    VectorXd transVec(9); //Translation
+    VectorXd rotVec(9); //Rotation
+    transVec.setZero();
+    rotVec.setZero();
+    for (int i=0;i<3;i++)
+    {
+      Vector3d axis = Vector3d::Unit(k); //Rotation axis
+      Vector3d pos; //Position (bohr)
+      pos(0) = QMMMData[i].P[0].x/bohrRad;
+      pos(1) = QMMMData[i].P[0].y/bohrRad;
+      pos(2) = QMMMData[i].P[0].z/bohrRad;
+      transVec(3*i+k) = 1;
+      rotVec.segment(3*i,3) = axis.cross(pos);
+    }
+    testPass = testPass && ((lindhHess*transVec).norm() < 1e-10);
+    testPass = testPass && ((lindhHess*rotVec).norm() < 1e-10);
+  }
+  //The in-plane modes have positive curvatures
+  SelfAdjointEigenSolver<MatrixXd> hessAnalysis(lindhHess);
+  int Npos = 0; //Number of positive curvatures
+  for (int i=0;i<9;i++)
+  {
+    if (hessAnalysis.eigenvalues()(i) > 1e-8)
+    {
+      Npos += 1;
+    }
+  }
+  testPass = testPass && (Npos == 3);
+  return testPass;
+};
+
+bool TestLBFGSHistory()
+{
+  //Check that saved L-BFGS histories are trimmed and only reused for
+  //the same atoms
+  bool testPass = 1; //Result of the test
+  int bead = 999; //Bead number for the test file
+  int Ndof = 6; //Degrees of freedom
+  vector<QMMMAtom> QMMMData; //Test atoms
+  QMMMData.resize(2);
+  for (int i=0;i<2;i++)
+  {
+    QMMMData[i].QMRegion = 1;
+    QMMMData[i].MMRegion = 0;
+    QMMMData[i].PBRegion = 0;
+    QMMMData[i].BARegion = 0;
+    QMMMData[i].QMTyp = "H";
+    QMMMData[i].P.resize(bead+1);
+    QMMMData[i].P[bead].x = 0.74*i;
+    QMMMData[i].P[bead].y = 0;
+    QMMMData[i].P[bead].z = 0;
+  }
+  Natoms = 2;
+  Nqm = 2;
+  Npseudo = 0;
+  vector<VectorXd> stepHist; //Saved steps
+  vector<VectorXd> gradHist; //Saved gradient changes
+  for (int k=0;k<5;k++)
+  {
+    stepHist.push_back(VectorXd::Constant(Ndof,k+1.0));
+    gradHist.push_back(VectorXd::Constant(Ndof,-1.0*(k+1)));
+  }
+  WriteLBFGSHist(stepHist,gradHist,QMMMData,bead);
+  //Read with a smaller memory
+  vector<VectorXd> newSteps; //Restored steps
+  vector<VectorXd> newGrads; //Restored gradient changes
+  testPass = testPass &&
+             ReadLBFGSHist(newSteps,newGrads,QMMMData,Ndof,3,bead);
+  testPass = testPass && (newSteps.size() == 3) && (newGrads.size() == 3);
+  if (newSteps.size() == 3)
+  {
+    //The newest pairs are kept
+    testPass = testPass && UnitTestClose(newSteps[0](0),3.0,1e-12);
+    testPass = testPass && UnitTestClose(newGrads[2](5),-5.0,1e-12);
+  }
+  //Different atoms or a large displacement discard the history
+  QMMMData[1].QMTyp = "F";
+  testPass = testPass &&
+             (!ReadLBFGSHist(newSteps,newGrads,QMMMData,Ndof,3,bead));
+  QMMMData[1].QMTyp = "H";
+  QMMMData[1].P[bead].x += 2.0;
+  testPass = testPass &&
+             (!ReadLBFGSHist(newSteps,newGrads,QMMMData,Ndof,3,bead));
+  globalSys = system("rm -f LICHM_999.lbfgs");
+  return testPass;
+};
+
+//Unit tests for the random number generator
+bool TestPhiloxKAT()
+{
+  //Compare the Philox4x32-10 block function with the known-answer
+  //vectors distributed with Random123
+  bool testPass = 1; //Result of the test
+  RandomStreams testGen; //Local generator
+  unsigned int ctrs[3][4] = {{0x00000000U,0x00000000U,
+                              0x00000000U,0x00000000U},
+                             {0xFFFFFFFFU,0xFFFFFFFFU,
+                              0xFFFFFFFFU,0xFFFFFFFFU},
+                             {0x243F6A88U,0x85A308D3U,
+                              0x13198A2EU,0x03707344U}}; //Counters
+  unsigned int keys[3][2] = {{0x00000000U,0x00000000U},
+                             {0xFFFFFFFFU,0xFFFFFFFFU},
+                             {0xA4093822U,0x299F31D0U}}; //Keys
+  unsigned int refs[3][4] = {{0x6627E8D5U,0xE169C58DU,
+                              0xBC57AC4CU,0x9B00DBD8U},
+                             {0x408F276DU,0x41C83B0EU,
+                              0xA20BC7C6U,0x6D5451FDU},
+                             {0xD16CFE09U,0x94FDCCEBU,
+                              0x5001E420U,0x24126EA1U}}; //Outputs
+  for (int k=0;k<3;k++)
+  {
+    testGen.philox_(ctrs[k],keys[k]);
+    for (int i=0;i<4;i++)
+    {
+      testPass = testPass && (ctrs[k][i] == refs[k][i]);
+    }
+  }
+  //The first uniform number of stream 0 uses the first block
+  testGen.seed(0,1);
+  unsigned long long bits; //Random bits for the mantissa
+  bits = (((unsigned long long)refs[0][0]) << 21)^(refs[0][1] >> 11);
+  testPass = testPass && (testGen.uniform(0) == (bits/9007199254740992.0));
+  //Walker streams are reproducible and independent of the thread streams
+  testGen.seed(1234,1);
+  int s1 = testGen.addStream(1); //First walker
+  int s2 = testGen.addStream(2); //Second walker
+  double val1 = testGen.uniform(s1); //First number of walker 1
+  double val2 = testGen.uniform(s2); //First number of walker 2
+  testGen.seed(1234,4);
+  s1 = testGen.addStream(1);
+  testPass = testPass && (testGen.uniform(s1) == val1) && (val1 != val2);
+  return testPass;
+};
+
+//Unit tests for Monte Carlo
+bool TestBlockingAR1()
+{
+  /*
+    Compare the blocking error bars with the analytic results for an AR(1)
+    series x_t = phi*x_(t-1)+sqrt(1-phi^2)*g_t with unit variance. The
+    error of the mean is sqrt((1+phi)/((1-phi)*N)) and the integrated
+    autocorrelation time is (1+phi)/(2*(1-phi)).
+  */
+  bool testPass = 1; //Result of the test
+  RandomStreams testGen; //Local generator
+  testGen.seed(1234,1);
+  int Nsamp = 262144; //Number of samples (2^18)
+  double phiVals[2] = {0.0,0.9}; //Uncorrelated and correlated series
+  for (int k=0;k<2;k++)
+  {
+    double phi = phiVals[k]; //Correlation between neighboring samples
+    double noise = sqrt(1-phi*phi); //Keeps the variance at one
+    BlockStats stats; //Blocking analysis of the series
+    double x = testGen.gauss(0); //Start from the stationary distribution
+    for (int i=0;i<Nsamp;i++)
+    {
+      stats.add(x);
+      x = phi*x+noise*testGen.gauss(0);
+    }
+    //Analytic reference
+    double refErr = sqrt((1+phi)/((1-phi)*Nsamp)); //Error of the mean
+    double refTau = 0.5*(1+phi)/(1-phi); //Autocorrelation time
+    //Compare with the blocking analysis
+    testPass = testPass && stats.converged();
+    testPass = testPass && UnitTestClose(stats.variance(),1,0.05);
+    testPass = testPass && (abs(stats.mean()) < (4*refErr));
+    testPass = testPass && UnitTestClose(stats.stdErr()/refErr,1,0.15);
+    testPass = testPass && UnitTestClose(stats.corrTime()/refTau,1,0.3);
+  }
+  return testPass;
+};
+
+bool TestMALAHarmonic()
+{
+  /*
+    Sample the ring polymer of an atom in a harmonic well with force-bias
+    (MALA) moves and compare the average squared bead distance from the
+    origin with the exact result for the discretized path integral
+    <r^2> = (3/(beta*P))*sum_j 1/((k/P)+w*(2-2*cos(2*pi*j/P))),
+    where w is the spring constant of the ring.
+  */
+  bool testPass = 1; //Result of the test
+  int P = 4; //Number of beads
+  vector<QMMMAtom> QMMMData(1); //Test atom
+  QMMMSettings QMMMOpts; //Test settings
+  QMMMData[0].QMRegion = 1;
+  QMMMData[0].MMRegion = 0;
+  QMMMData[0].PBRegion = 0;
+  QMMMData[0].BARegion = 0;
+  QMMMData[0].frozen = 0;
+  QMMMData[0].m = 1.008;
+  QMMMData[0].P.resize(P);
+  for (int p=0;p<P;p++)
+  {
+    QMMMData[0].P[p].x = 0;
+    QMMMData[0].P[p].y = 0;
+    QMMMData[0].P[p].z = 0;
+  }
+  Natoms = 1;
+  Nqm = 1;
+  Npseudo = 0;
+  QMMMOpts.NBeads = P;
+  QMMMOpts.temp = 300.0;
+  QMMMOpts.beta = 1/(kBoltz*QMMMOpts.temp);
+  randGen.seed(1234,1);
+  //Ring spring constant and a well of similar stiffness
+  double w = 1/(QMMMOpts.beta*hbar); //Spring constant of the ring
+  w *= w*toeV*P*QMMMData[0].m;
+  double kWell = P*w; //Force constant of the well (eV/Ang^2)
+  double refR2 = 0; //Exact average of r^2
+  for (int j=0;j<P;j++)
+  {
+    double modeK = (kWell/P)+w*(2-2*cos(2*pi*j/P)); //Mode force constant
+    refR2 += 3/(QMMMOpts.beta*P*modeK);
+  }
+  //Noise which moves the stiffest mode by about one thermal width
+  double step = sqrt(QMMMData[0].m/(QMMMOpts.beta*((kWell/P)+4*w)));
+  //Run the chain
+  int Neq = 2000; //Equilibration steps
+  int Nsamp = 50000; //Production steps
+  double Nacc = 0; //Accepted moves
+  BlockStats r2Stats; //Statistics for r^2
+  vector<VectorXd> potForces; //Bead forces
+  double EPot = UnitTestHarmonicWell(QMMMData,kWell,P,potForces);
+  for (int n=0;n<(Neq+Nsamp);n++)
+  {
+    vector<VectorXd> oldForces; //Effective forces
+    oldForces = PIEffForces(QMMMData,QMMMOpts,potForces);
+    vector<QMMMAtom> QMMMData2; //Trial structure
+    double logFwd; //Log. probability of the forward move
+    logFwd = PIForceStep(QMMMData,QMMMData2,QMMMOpts,oldForces,step);
+    if (n == 0)
+    {
+      //The forward probability matches the random displacement
+      double logChk; //Log. probability from the positions
+      logChk = PIForceLogProb(QMMMData,QMMMData2,QMMMOpts,oldForces,step);
+      testPass = testPass && UnitTestClose(logChk,logFwd,1e-8);
+    }
+    vector<VectorXd> newPotForces; //Bead forces of the trial structure
+    double EPotNew = UnitTestHarmonicWell(QMMMData2,kWell,P,newPotForces);
+    vector<VectorXd> newForces; //Effective forces of the trial structure
+    newForces = PIEffForces(QMMMData2,QMMMOpts,newPotForces);
+    double logRev; //Log. probability of the reverse move
+    logRev = PIForceLogProb(QMMMData2,QMMMData,QMMMOpts,newForces,step);
+    double dE = EPotNew+Get_PI_Espring(QMMMData2,QMMMOpts); //New energy
+    dE -= EPot+Get_PI_Espring(QMMMData,QMMMOpts);
+    dE *= QMMMOpts.beta;
+    dE -= logRev-logFwd; //Correct for the biased moves
+    if (randGen.uniform() <= exp(-1*dE))
+    {
+      //Accept
+      QMMMData = QMMMData2;
+      potForces = newPotForces;
+      EPot = EPotNew;
+      if (n >= Neq)
+      {
+        Nacc += 1;
+      }
+    }
+    if (n >= Neq)
+    {
+      //Collect r^2 averaged over the beads
+      double r2 = 0; //Squared distance from the origin
+      for (int p=0;p<P;p++)
+      {
+        Coord& pos = QMMMData[0].P[p]; //Position of the bead
+        r2 += (pos.x*pos.x+pos.y*pos.y+pos.z*pos.z)/P;
+      }
+      r2Stats.add(r2);
+    }
+  }
+  //Compare with the exact result
+  double err = abs(r2Stats.mean()-refR2); //Error of the average
+  testPass = testPass && (err < (4*r2Stats.stdErr()));
+  testPass = testPass && UnitTestClose(r2Stats.mean()/refR2,1,0.05);
+  testPass = testPass && ((Nacc/Nsamp) > 0.5);
+  return testPass;
+};
+
+//Unit tests for the surrogate models
+bool TestGPTraining()
+{
+  //Check that the Gaussian process reproduces its training data for
+  //E = sin(x)+0.5*y^2+0.3*x*y
+  bool testPass = 1; //Result of the test
+  int Npts = 6; //Number of training structures
+  GPModel surrogate; //Test model
+  VectorXd pos(2); //Coordinates
+  VectorXd forces(2); //Forces
+  VectorXd predForces(2); //Predicted forces
+  //An empty model is not trained and only returns the prior
+  testPass = testPass && (!surrogate.train());
+  testPass = testPass && (surrogate.predict(pos.setZero(),forces) == 0);
+  testPass = testPass && (surrogate.variance(pos) == hugeNum);
+  //Fit the model
+  randGen.seed(1234,1);
+  vector<VectorXd> trainPos; //Training structures
+  vector<double> trainE; //Training energies
+  vector<VectorXd> trainForces; //Training forces
+  for (int i=0;i<Npts;i++)
+  {
+    pos(0) = 2*randGen.uniform(0)-1;
+    pos(1) = 2*randGen.uniform(0)-1;
+    double E = sin(pos(0))+0.5*pos(1)*pos(1)+0.3*pos(0)*pos(1); //Energy
+    forces(0) = -1*(cos(pos(0))+0.3*pos(1));
+    forces(1) = -1*(pos(1)+0.3*pos(0));
+    surrogate.addPoint(pos,E,forces);
+    trainPos.push_back(pos);
+    trainE.push_back(E);
+    trainForces.push_back(forces);
+  }
+  testPass = testPass && surrogate.train();
+  //Compare the posterior mean with the data (up to the small noise term)
+  for (int i=0;i<Npts;i++)
+  {
+    double E = surrogate.predict(trainPos[i],predForces); //Predicted energy
+    testPass = testPass && UnitTestClose(E,trainE[i],1e-4);
+    for (int j=0;j<2;j++)
+    {
+      double ref = trainForces[i](j); //Reference force
+      testPass = testPass && UnitTestClose(predForces(j),ref,1e-5);
+    }
+    testPass = testPass && (surrogate.variance(trainPos[i]) < 1e-6);
+  }
+  //Adding data invalidates the fit until the model is retrained
+  surrogate.addPoint(pos.setConstant(0.5),0.0,forces);
+  testPass = testPass && (surrogate.variance(pos) == hugeNum);
+  return testPass;
+};
+
+//Unit tests for the vibrational analysis
+bool TestLanczosModes()
+{
+  //Check the block Lanczos eigensolver on a matrix with a three-fold
+  //degenerate lowest eigenvalue and one projected mode
+  bool testPass = 1; //Result of the test
+  int Ndim = 30; //Size of the matrix
+  int Nmodes = 4; //Number of eigenpairs
+  randGen.seed(4321,1);
+  MatrixXd randMat(Ndim,Ndim); //Random matrix for the eigenvectors
+  for (int i=0;i<Ndim;i++)
+  {
+    for (int j=0;j<Ndim;j++)
+    {
+      randMat(i,j) = randGen.gauss(0);
+    }
+  }
+  HouseholderQR<MatrixXd> randQR(randMat);
+  MatrixXd randVecs = randQR.householderQ(); //Orthonormal eigenvectors
+  VectorXd testVals(Ndim); //Eigenvalues {0.5,1,1,1,2,3,...}
+  testVals(0) = 0.5;
+  for (int i=1;i<Ndim;i++)
+  {
+    testVals(i) = max(1,i-2);
+  }
+  MatrixXd testMat = randVecs*testVals.asDiagonal()*randVecs.transpose();
+  MatrixXd projModes = randVecs.leftCols(1); //Lowest mode is projected out
+  VectorXd eigVals; //Lowest eigenvalues
+  MatrixXd eigVecs; //Lowest eigenvectors
+  LanczosModes(testMat,projModes,Nmodes,eigVals,eigVecs);
+  testPass = testPass && (eigVals.size() == Nmodes);
+  if (testPass)
+  {
+    double refVals[4] = {1,1,1,2}; //Expected eigenvalues
+    for (int k=0;k<Nmodes;k++)
+    {
+      //Compare the eigenpairs with the reference
+      VectorXd vecK = eigVecs.col(k); //Eigenvector
+      double res = (testMat*vecK-eigVals(k)*vecK).norm(); //Residual
+      testPass = testPass && UnitTestClose(eigVals(k),refVals[k],1e-8);
+      testPass = testPass && (res < 1e-6);
+      testPass = testPass && (abs(projModes.col(0).dot(vecK)) < 1e-8);
+    }
+  }
+  return testPass;
+};
+
+bool TestPartialHessian()
+{
+  //Check that only the displaced atoms of a partial Hessian are analyzed
+  //using a diatomic spring with a third (inactive) atom
+  bool testPass = 1; //Result of the test
+  double kSpring = 0.5; //Force constant (a.u.)
+  double mA = 12.0; //Mass of the first atom (amu)
+  double mB = 16.0; //Mass of the second atom (amu)
+  vector<QMMMAtom> QMMMData; //Test atoms
+  QMMMSettings QMMMOpts; //Test settings
+  QMMMData.resize(3);
+  for (int i=0;i<3;i++)
+  {
+    QMMMData[i].QMRegion = 1;
+    QMMMData[i].MMRegion = 0;
+    QMMMData[i].PBRegion = 0;
+    QMMMData[i].BARegion = 0;
+    QMMMData[i].HessActive = (i < 2);
+    QMMMData[i].m = 1.0;
+    QMMMData[i].P.resize(1);
+    QMMMData[i].P[0].x = 1.5*i;
+    QMMMData[i].P[0].y = 0;
+    QMMMData[i].P[0].z = 0;
+  }
+  QMMMData[0].m = mA;
+  QMMMData[1].m = mB;
+  Natoms = 3;
+  Nqm = 3;
+  Npseudo = 0;
+  QMMM = 0;
+  //Bond along the x axis between the active atoms
+  MatrixXd testHess(9,9); //Hessian (a.u.)
+  testHess.setZero();
+  testHess(0,0) = kSpring;
+  testHess(3,3) = kSpring;
+  testHess(0,3) = -1*kSpring;
+  testHess(3,0) = -1*kSpring;
+  int remCt = 0; //Number of zero frequency modes
+  VectorXd freqs = LICHEMFreq(QMMMData,testHess,QMMMOpts,0,remCt);
+  //Reference stretching frequency
+  double redMass = (mA*mB/(mA+mB))/elecMass; //Reduced mass (a.u.)
+  double freqRef = sqrt(kSpring/redMass)*har2Wavenum; //Frequency (cm^-1)
+  int Nfreqs = 0; //Number of non-zero frequencies
+  for (int i=0;i<freqs.size();i++)
+  {
+    if (abs(freqs(i)) > 0)
+    {
+      Nfreqs += 1;
+      testPass = testPass && UnitTestClose(freqs(i),freqRef,1e-8);
+    }
+  }
+  //The five remaining modes of the active atoms have zero frequency
+  testPass = testPass && (Nfreqs == 1) && (remCt == 5);
+  return testPass;
+};
+
+//Driver for the unit tests
+void LICHEMUnitTests(int& argc, char**& argv)
+{
+  //Run all unit tests and quit
+  int passCt = 0; //Number of tests passed
+  int failCt = 0; //Number of tests failed
+  vector<string> testNames; //Names of the tests
+  vector<bool> testResults; //Results of the tests
+  bool PBCSave = PBCon; //Tests are not periodic
+  PBCon = 0;
+  cout << "Running unit tests..." << '\n';
+  cout << '\n';
+  cout.flush();
+  //Frozen density tests
+  testNames.push_back("GEM two-site");
+  testResults.push_back(TestGEMTwoSite());
+  testNames.push_back("GEM local frame");
+  testResults.push_back(TestGEMFrame());
+  testNames.push_back("Hermite p-type");
+  testResults.push_back(TestHermiteDerivs());
+  //Multipole tests
+  testNames.push_back("Batched 3x3 eigensolver");
+  testResults.push_back(TestQuadDiag());
+  //Structure alignment tests
+  testNames.push_back("QCP alignment");
+  testResults.push_back(TestQCPAlignment());
+  //Optimizer tests
+  testNames.push_back("Lindh Hessian");
+  testResults.push_back(TestLindhHessian());
+  testNames.push_back("L-BFGS history");
+  testResults.push_back(TestLBFGSHistory());
+  //Random number tests
+  testNames.push_back("Philox known answers");
+  testResults.push_back(TestPhiloxKAT());
+  //Monte Carlo tests
+  testNames.push_back("AR(1) blocking error");
+  testResults.push_back(TestBlockingAR1());
+  testNames.push_back("MALA harmonic oscillator");
+  testResults.push_back(TestMALAHarmonic());
+  //Surrogate model tests
+  testNames.push_back("GP training points");
+  testResults.push_back(TestGPTraining());
+  //Vibrational analysis tests
+  testNames.push_back("Lanczos degenerate modes");
+  testResults.push_back(TestLanczosModes());
+  testNames.push_back("Partial Hessian");
+  testResults.push_back(TestPartialHessian());
+  //Print results
+  for (unsigned int i=0;i<testNames.size();i++)
+  {
+    PrintUnitTest(testNames[i],testResults[i]);
+    if (testResults[i])
+    {
+      passCt += 1;
+    }
+    else
+    {
+      failCt += 1;
+    }
+  }
+  cout << '\n';
+  cout << "Unit tests passed: " << passCt << '\n';
+  cout << "Unit tests failed: " << failCt << '\n';
+  cout << '\n';
+  cout << "Done." << '\n';
+  cout << '\n';
+  cout.flush();
+  PBCon = PBCSave;
+  //Quit
+  exit(0);
+};
+
+//End of file group
+///@}
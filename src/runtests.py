@@ -480,6 +480,29 @@ line += "Running LICHEM tests..."
 line += '\n'
 print(line)
 
+#Run the unit tests for the numerical kernels
+line = "Unit tests:"
+print(line)
+cmd = "lichem -unittests > tests.out 2>&1"
+subprocess.call(cmd,shell=True)
+cmd = 'grep -e "Unit test " tests.out'
+try:
+  #Collect the results
+  unitOut = subprocess.check_output(cmd,shell=True)
+  unitOut = unitOut.decode('utf-8').strip().split('\n')
+except:
+  #The unit tests crashed
+  unitOut = ["Unit test Unit tests: Crashed"]
+for unitLn in unitOut:
+  testName,testResult = unitLn[10:].rsplit(":",1)
+  passUnit = (testResult.strip() == "Pass")
+  line = AddPass(testName+":",passUnit,"")
+  line = line.rstrip(",")
+  print(line)
+CleanFiles() #Clean up files
+line = ""
+print(line)
+
 #Make a list of tests
 QMTests = []
 MMTests = []